@@ -32,6 +32,8 @@
     #define BL_FEATURES      0x0100             //!< Feature list of bootloader in Release version
 #endif
 
+#define BL_FEATURE_PAGE_CRC          0x0002     //!< Feature flag: bootloader handles @ref UPD_REQUEST_PAGE_CRC
+
 /**
  * @def ALTERNATIVE_PROGRAMMING_BUTTON
  *
@@ -45,6 +47,19 @@
 
 #define BOOT_BLOCK_DESC_SIZE FLASH_PAGE_SIZE    //!< 1 flash page
 
+/**
+ * @def BL_APP_VERIFIED_MARKER
+ *
+ * Set to 1 to record an @ref AppVerifiedMarker in the boot descriptor page after
+ * the application passed the full crc check. Later boots only check the marker
+ * instead of the crc over the whole application. Set to 0 to check the crc on every boot.
+ */
+#ifndef BL_APP_VERIFIED_MARKER
+#   define BL_APP_VERIFIED_MARKER 1
+#endif
+
+#define APP_VERIFIED_MAGIC   0x56455249         //!< magic of a valid @ref AppVerifiedMarker, "VERI"
+
 extern char bl_id_string[BL_ID_STRING_LENGTH]; //!< default bootloader identity "string" used in @ref getAppVersion()
 
 /**
@@ -60,6 +75,23 @@ typedef struct AppDescriptionBlock
     char * appVersionAddress;       //!< address of the APP_VERSION[20] @note string MUST start with "!AVP!@:" e.g. "!AVP!@:SBuid   1.00"
 }__attribute__ ((aligned (BOOT_BLOCK_DESC_SIZE))) AppDescriptionBlock;
 
+/**
+ * @struct AppVerifiedMarker
+ * Marker at the end of the boot descriptor page, recorded after the application
+ * passed the full crc check. It is programmed into the erased end of the page
+ * without erasing the @ref AppDescriptionBlock, and invalidated by programming
+ * it to zero before the application flash is changed.
+ */
+typedef struct AppVerifiedMarker
+{
+    uint32_t magic;                 //!< @ref APP_VERIFIED_MAGIC
+    uint32_t appCrc;                //!< crc of the verified application, copy of AppDescriptionBlock::crc
+    uint32_t descriptorCrc;         //!< crc of the AppDescriptionBlock, identifies the application image
+    uint32_t check;                 //!< inverted xor of the other fields
+} AppVerifiedMarker;
+
+#define APP_VERIFIED_MARKER_OFFSET (BOOT_BLOCK_DESC_SIZE - sizeof(AppVerifiedMarker)) //!< offset of the @ref AppVerifiedMarker in the boot descriptor page
+
 /**
  * Checks the application description block for valid
  *        start and end addresses
@@ -69,6 +101,48 @@ typedef struct AppDescriptionBlock
  */
 unsigned int checkApplication(AppDescriptionBlock * block);
 
+/**
+ * Checks the application like @ref checkApplication, but skips the crc over
+ * the application if a valid @ref AppVerifiedMarker is present.
+ * Without a marker the full check is done and the marker is recorded on success.
+ *
+ * @param block Application description block in flash
+ * @return      1 if block is valid, otherwise 0
+ */
+unsigned int checkApplicationCached(AppDescriptionBlock * block);
+
+/**
+ * Checks if the @ref AppVerifiedMarker of the boot descriptor page belongs to the block.
+ *
+ * @param block Application description block in flash
+ * @return      true if the marker is valid
+ */
+bool appVerifiedMarkerValid(AppDescriptionBlock * block);
+
+/**
+ * Checks if the @ref AppVerifiedMarker area of the boot descriptor page is erased.
+ *
+ * @param block Application description block in flash
+ * @return      true if a marker can be recorded without an erase
+ */
+bool appVerifiedMarkerBlank(AppDescriptionBlock * block);
+
+/**
+ * Records the @ref AppVerifiedMarker for the block.
+ * Call only after the application passed @ref checkApplication.
+ *
+ * @param block Application description block in flash
+ * @return      true if the marker is valid afterwards
+ */
+bool writeAppVerifiedMarker(AppDescriptionBlock * block);
+
+/**
+ * Invalidates a valid @ref AppVerifiedMarker, so the next boot checks the crc of the application.
+ *
+ * @param block Application description block in flash
+ */
+void invalidateAppVerifiedMarker(AppDescriptionBlock * block);
+
 /**
  * Returns the address of the @ref APP_VERSION_STRING of the application starting after the magic identifier !AVP!@:
  *
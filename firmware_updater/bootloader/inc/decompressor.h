@@ -27,12 +27,52 @@
 #include "upd_protocol.h"
 #include "boot_descriptor_block.h"
 
-#define REMEMBER_OLD_PAGES_COUNT 2	// There seems to be a RAM leak/overflow somewhere, 2 seems to work for the moment!
+/**
+ * Number of already overwritten flash pages whose old content is kept in RAM,
+ * so that the differential stream can still copy from them.
+ * Each page costs @ref FLASH_PAGE_SIZE bytes of RAM, the stream references them relative
+ * to the oldest page kept (see @ref UPD_SEND_DATA_TO_DECOMPRESS).
+ * Must match the window size of the PC updater tool.
+ */
+#ifndef REMEMBER_OLD_PAGES_COUNT
+#   define REMEMBER_OLD_PAGES_COUNT 2
+#endif
+
+static_assert(REMEMBER_OLD_PAGES_COUNT > 0, "REMEMBER_OLD_PAGES_COUNT must be at least 1");
+
+/**
+ * Maximum number of consecutive differing pages which are collected in RAM and then
+ * erased with one IAP call and programmed with as few IAP calls as possible.
+ * Each page costs @ref FLASH_PAGE_SIZE bytes of RAM. 1 erases and programs every page on its own.
+ */
+#ifndef DECOMPRESSOR_BATCH_PAGES
+#   define DECOMPRESSOR_BATCH_PAGES 4
+#endif
+
+static_assert((DECOMPRESSOR_BATCH_PAGES > 0) && (DECOMPRESSOR_BATCH_PAGES <= FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE),
+              "DECOMPRESSOR_BATCH_PAGES must be between 1 and the pages of a sector");
+
+/** RAM in byte used by the page buffers of the @ref Decompressor */
+#define DECOMPRESSOR_RAM_SIZE (FLASH_PAGE_SIZE * (DECOMPRESSOR_BATCH_PAGES + REMEMBER_OLD_PAGES_COUNT))
 
 
 /**
  * Apply differential stream and produce one page to be flashed
  * (based on differential stream, original ROM content, and RAM buffer to store some latest ROM pages already flashed)
+ *
+ * A copy command references either
+ * - the flash relative to the start of the application (ADDR_FROM_ROM). All pages from the page currently
+ *   decompressed up to the end of the application area still hold their old content and can be referenced
+ *   directly, pages in front of it already hold the new content.
+ * - the old content of the last @ref REMEMBER_OLD_PAGES_COUNT overwritten pages (ADDR_FROM_RAM).
+ *   Offset 0 is the first byte of the oldest page kept. Internally these pages are kept in a ring,
+ *   so completing a page copies only that one page to RAM.
+ *
+ * Commands which would overflow the scratchpad or reference memory outside of these areas are rejected.
+ *
+ * Consecutive differing pages of a sector are not flashed one by one. Up to @ref DECOMPRESSOR_BATCH_PAGES
+ * of them are kept in RAM and flashed together, when the run ends with an unchanged page,
+ * at the end of the sector or by @ref flush(). Copies from these pages are taken from RAM.
  */
 class Decompressor
 {
@@ -49,17 +89,28 @@ class Decompressor
         uint8_t cmdBuffer[5] = {0};
         int expectedCmdLength = 0;
         int cmdBufferLength = 0;
-        uint8_t scratchpad[FLASH_PAGE_SIZE] = {0};
-        uint8_t oldPages[FLASH_PAGE_SIZE * REMEMBER_OLD_PAGES_COUNT] = {0};
+        __attribute__ ((aligned (FLASH_RAM_BUFFER_ALIGNMENT))) uint8_t pageBuffer[FLASH_PAGE_SIZE * DECOMPRESSOR_BATCH_PAGES] = {0}; //!< pages to be flashed
+        uint8_t * scratchpad = pageBuffer; //!< page currently decompressed, behind the pending pages in pageBuffer
+        unsigned int pendingPages = 0; //!< number of decompressed pages in pageBuffer waiting to be flashed
+        unsigned int iapCallsSaved = 0; //!< IAP calls saved by flashing pending pages together
+        uint8_t oldPages[FLASH_PAGE_SIZE * REMEMBER_OLD_PAGES_COUNT] = {0}; //!< ring of old page contents
+        unsigned int oldestPageSlot = 0; //!< slot in oldPages holding the oldest page, the next one to be replaced
         int bytesToFlash = 0;
         int rawLength = 0;
         State state = State::EXPECT_COMMAND_BYTE;
-        __attribute__ ((aligned (FLASH_RAM_BUFFER_ALIGNMENT))) uint8_t * startAddrOfPageToBeFlashed = 0;
+        uint8_t * startAddrOfPageToBeFlashed = 0;
         uint8_t * startAddrOfFlash = 0;
 
 	public:
 		Decompressor(AppDescriptionBlock* BaseAddress);
 
+		/**
+		 * Starts a new differential stream, discards pending pages and the remembered old pages
+		 *
+		 * @param BaseAddress boot descriptor of the application to be updated
+		 */
+		void reset(AppDescriptionBlock* BaseAddress);
+
 	private:
 		// remove default constructors
 		Decompressor() = delete;
@@ -74,19 +125,79 @@ class Decompressor
 
 		void resetStateMachine();
 
-	public:
+		/**
+		 * Copies bytes of the old page contents kept in RAM to the scratchpad
+		 *
+		 * @param offset offset relative to the start of the oldest page kept
+		 * @param length number of bytes to copy
+		 */
+		void copyFromOldPages(unsigned int offset, unsigned int length);
+
+		/**
+		 * Copies bytes of the flash to the scratchpad, bytes of pending pages are taken from RAM
+		 *
+		 * @param source start address in the flash
+		 * @param length number of bytes to copy
+		 */
+		void copyFromFlash(const uint8_t * source, unsigned int length);
+
+		/**
+		 * Erases and programs the pending pages
+		 *
+		 * @return @ref UDP_IAP_SUCCESS if successful, otherwise a @ref UDP_State
+		 */
+		UDP_State programPendingPages();
+
+		/**
+		 * Executes the copy command in cmdBuffer
+		 *
+		 * @return @ref UDP_IAP_SUCCESS if successful, otherwise @ref UDP_RAM_BUFFER_OVERFLOW or @ref UDP_INVALID_DATA
+		 */
+		UDP_State executeCopy();
 
-		void putByte(uint8_t data);
+	public:
 
+		/**
+		 * Processes the next byte of the differential stream
+		 *
+		 * @param data next byte of the stream
+		 * @return     @ref UDP_IAP_SUCCESS if successful, otherwise @ref UDP_RAM_BUFFER_OVERFLOW
+		 *             or @ref UDP_INVALID_DATA in case the byte completes an invalid command
+		 */
+		UDP_State putByte(uint8_t data);
+
+		/**
+		 * Completes the current page. A differing page is added to the pending pages,
+		 * which are flashed once the run of differing pages ends.
+		 *
+		 * @return @ref UDP_IAP_SUCCESS if successful, otherwise the @ref UDP_State of the failed flashing
+		 * @warning The function may call @ref iap_Program which by itself calls @ref no_interrupts().
+		 */
 		UDP_State pageCompletedDoFlash();
 
+		/**
+		 * Flashes the pending pages, must be called after the last page of the stream.
+		 *
+		 * @return @ref UDP_IAP_SUCCESS if successful, otherwise the @ref UDP_State of the failed flashing
+		 * @warning The function may call @ref iap_Program which by itself calls @ref no_interrupts().
+		 */
+		UDP_State flush();
+
+		/**
+		 * Number of IAP calls saved by flashing consecutive pages together,
+		 * compared to one erase and one program call per page.
+		 *
+		 * @return number of IAP calls saved since @ref reset()
+		 */
+		unsigned int getIapCallsSaved();
+
 		uint32_t getCrc32();
 
 		uint8_t * getStartAddrOfPageToBeFlashed();
 
 		uint32_t getBytesCountToBeFlashed();
 
-		uint8_t getFlashPageNumberToBeFlashed();
+		unsigned int getFlashPageNumberToBeFlashed();
 
 };
 
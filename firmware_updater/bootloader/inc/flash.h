@@ -80,6 +80,26 @@ bool addressAllowedToProgram(uint8_t * start, unsigned int length, bool isBootDe
  */
 UDP_State executeProgramFlash(uint8_t * address, const uint8_t * ram, unsigned int size, bool isBootDescriptor = false);
 
+/**
+ * Programs a range of whole pages from the RAM to the FLASH with as few IAP calls as possible.
+ * If the range is not blank, it is erased first, whole sectors by a sector erase.
+ *
+ * @param address start address inside the FLASH, aligned to @ref FLASH_PAGE_SIZE
+ * @param ram     start address of the buffer containing the data
+ * @param size    number of bytes to program, a multiple of @ref FLASH_PAGE_SIZE
+ * @return        UDP_IAP_SUCCESS if successful, otherwise UDP_ADDRESS_NOT_ALLOWED_TO_FLASH
+ *                or a @ref UDP_State
+ * @warning       The function calls iap_Program which by itself calls no_interrupts().
+ */
+UDP_State programFlashRange(uint8_t * address, const uint8_t * ram, unsigned int size);
+
+/**
+ * Number of erase and program IAP calls executed by the functions above since reset
+ *
+ * @return number of IAP calls
+ */
+unsigned int flashIapCallCount(void);
+
 
 
 #endif /* FLASH_H_ */
@@ -19,10 +19,16 @@
  *              After a @ref UPD_PROGRAM or @ref UPD_UPDATE_BOOT_DESC the RAM buffer address will be reseted.
  *      .
 
+ *    -@ref UPD_SEND_DATA_LONG_OFFSET
+ *      - 9-10 the RAM buffer address, needed for addresses above 255 of a RAM buffer larger than one page
+ *      - 11-  the actual data which will be copied into the RAM buffer
+ *      .
+
  *    -@ref UPD_PROGRAM
- *      - 9-12 How many bytes of the RAM Buffer should be programmed. Be aware that the value needs to be one of the following
- *             256, 512, 1024, 4096 (required by the IAP of the LPC11xx mcu)
- *      - 13-16 Flash address the data should be programmed to
+ *      - 9-12 How many bytes of the RAM Buffer should be programmed, up to the RAM buffer size reported
+ *             in @ref UPD_RESPONSE_BL_IDENTITY. The last page is filled up with 0xff.
+ *             A not erased flash range is erased first.
+ *      - 13-16 Flash address the data should be programmed to, aligned to a flash page
  *      - 16-19 The CRC of the data downloaded via the UPD_SEND_DATA commands. If the CRC does not match the
  *              programming, error is returned
  *      .
@@ -33,6 +39,16 @@
  *      - 13 Which boot descriptor should be used
  *      .
  *
+ *    -@ref UPD_REQUEST_PAGE_CRC
+ *      - 9-12 Flash address of the first page, aligned to a flash page
+ *      - 13   Number of crc32 to return, 1 to @ref UPD_PAGE_CRC_MAX_COUNT
+ *      - 14   Number of pages covered by each crc32, e.g. 1 for single pages or 16 for whole sectors
+ *      .
+ *      @ref UPD_RESPONSE_PAGE_CRC returns the number of crc32 in byte 9 followed by the crc32 of the
+ *      consecutive page groups. The crc32 is calculated like the one of @ref UPD_PROGRAM, so the updater
+ *      can skip pages which are already programmed. Larger flash ranges are requested in batches.
+ *      .
+ *
  *    -@ref UPD_REQ_DATA (not implemented)
  *
  *    -Workflow:
@@ -73,6 +89,7 @@ static_assert(UID_LENGTH_USED > 0, "UID_LENGTH_USED must be greater then 0");
 static_assert(UID_LENGTH_USED <= IAP_UID_LENGTH, "UID_LENGTH_USED must be less than or equal to IAP_UID_LENGTH");
 static_assert(UID_LENGTH_USED % sizeof(uint32_t) == 0, "UID_LENGTH_USED must be multiple of sizeof(uint32_t)");
 
+constexpr uint8_t UPD_PAGE_CRC_MAX_COUNT = 3; //!< Maximum number of crc32 in a @ref UPD_RESPONSE_PAGE_CRC, limited by the size of a standard frame
 constexpr uint8_t idxInvalidUPDCommand = 0; //!< Array index of the @ref UPD_INVALID command in @ref updCommands
 
 /**
@@ -89,10 +106,12 @@ enum UPD_Code : uint8_t
     UPD_ERASE_COMPLETE_FLASH = 0xea,        //!< Erase the entire flash area excluding the bootloader itself @note device must be unlocked
     UPD_ERASE_ADDRESSRANGE = 0xe9,          //!< Erase flash from given start address to end address (start: data[3-6] end: data[7-10]) @note device must be unlocked
     UPD_REQ_DATA = 0xe8,                    //!< Return bytes from flash at given address? @note device must be unlocked @warning Not implemented
+    UPD_SEND_DATA_LONG_OFFSET = 0xe5,       //!< Like @ref UPD_SEND_DATA, but with a 16bit ramBuffer address in data[0-1] @note device must be unlocked
     UPD_DUMP_FLASH = 0xe7,                  //!< DUMP the flash of a given address range (data[0-3] - data[4-7]) to serial port of the mcu,
                                             //!< works only with DEBUG version of bootloader @note device must be unlocked
     UPD_REQUEST_STATISTIC = 0xdf,           //!< Return some statistic data for the active connection
-    UPD_RESPONSE_STATISTIC = 0xde,          //!< Response for @ref UPD_STATISTIC_RESPONSE containing the statistic data
+    UPD_RESPONSE_STATISTIC = 0xde,          //!< Response for @ref UPD_STATISTIC_RESPONSE containing the statistic data:
+                                            //!< disconnects (data[0-1]), repeated T_ACK (data[2-3]) and IAP calls saved by the @ref Decompressor (data[4-5])
     UPD_SEND_LAST_ERROR = 0xdc,             //!< Response containing the last error
 
     UPD_UNLOCK_DEVICE = 0xbf,               //!< Unlock the device for operations, which are only allowed on a unlocked device
@@ -106,6 +125,8 @@ enum UPD_Code : uint8_t
     UPD_REQUEST_BL_IDENTITY = 0xb8,         //!< Return the bootloader's identity @note device must be unlocked
     UPD_RESPONSE_BL_IDENTITY = 0xb7,        //!< Response for @ref UPD_REQUEST_BL_IDENTITY containing the identity
     UPD_RESPONSE_BL_VERSION_MISMATCH = 0xb6, //!< Response for @ref UPD_REQUEST_BL_IDENTITY containing the minimum required major and minor version of Selfbus Updater
+    UPD_REQUEST_PAGE_CRC = 0xb5,            //!< Return the crc32 of a range of flash pages @note device must be unlocked
+    UPD_RESPONSE_PAGE_CRC = 0xb4,           //!< Response for @ref UPD_REQUEST_PAGE_CRC containing the crc32 of the pages
     UPD_SET_EMULATION = 0x01                //!<@warning Not implemented
 };
 
@@ -120,6 +141,7 @@ const struct UPD_Command {
 {
     {UPD_INVALID, 0, 0},     // needs to be always at index 0 because it's used as a invalid return value of code2UPDCommand, see @ref idxInvalidUPDCommand
     {UPD_SEND_DATA, 2, 254}, // at least byte index and one byte, max. 254 for extended frames support
+    {UPD_SEND_DATA_LONG_OFFSET, 3, 254}, // at least byte index and one byte, max. 254 for extended frames support
     {UPD_PROGRAM, 10, 10},
     {UPD_UPDATE_BOOT_DESC, 8, 8},
     {UPD_SEND_DATA_TO_DECOMPRESS, 1, 254}, // max. 254 for extended frames support
@@ -129,7 +151,7 @@ const struct UPD_Command {
     {UPD_REQ_DATA, 3, 3}, // not implemented, maybe flash address (2 bytes ) and count (1 byte)?
     {UPD_DUMP_FLASH, 8, 8},
     {UPD_REQUEST_STATISTIC, 0, 0},
-    {UPD_RESPONSE_STATISTIC, 4, 4},
+    {UPD_RESPONSE_STATISTIC, 4, 6}, // older bootloaders don't send the IAP calls saved
     {UPD_SEND_LAST_ERROR, 1, 1},
     {UPD_UNLOCK_DEVICE, UID_LENGTH_USED, UID_LENGTH_USED},
     {UPD_REQUEST_UID, 0, 0},
@@ -139,8 +161,10 @@ const struct UPD_Command {
     {UPD_REQUEST_BOOT_DESC, 0, 0},
     {UPD_RESPONSE_BOOT_DESC, 12, 12},
     {UPD_REQUEST_BL_IDENTITY, 2, 2},
-    {UPD_RESPONSE_BL_IDENTITY, 10, 10},
+    {UPD_RESPONSE_BL_IDENTITY, 10, 12}, // older bootloaders don't send the ram buffer size
     {UPD_RESPONSE_BL_VERSION_MISMATCH, 2, 2},
+    {UPD_REQUEST_PAGE_CRC, 6, 6},
+    {UPD_RESPONSE_PAGE_CRC, 5, 1 + 4 * UPD_PAGE_CRC_MAX_COUNT},
     {UPD_SET_EMULATION, 0xff, 0xff} // not implemented
 };
 
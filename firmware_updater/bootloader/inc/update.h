@@ -24,7 +24,27 @@
 
 #include "boot_descriptor_block.h"
 
-#define RAM_BUFFER_SIZE FLASH_PAGE_SIZE    //!< Size in byte for the ram buffer
+/**
+ * Size in byte for the ram buffer, a multiple of @ref FLASH_PAGE_SIZE up to @ref FLASH_SECTOR_SIZE.
+ * A buffer of several pages is programmed with as few IAP calls as possible,
+ * a full sector with one sector erase and one program call.
+ * The size is reported in @ref UPD_RESPONSE_BL_IDENTITY.
+ */
+#ifndef RAM_BUFFER_SIZE
+#   define RAM_BUFFER_SIZE FLASH_PAGE_SIZE
+#endif
+
+/**
+ * Maximum RAM in byte used by all ram buffers together, including the page buffers
+ * of the decompressor (@ref DECOMPRESSOR_RAM_SIZE).
+ * The default leaves half of the 8KB RAM of a LPC1115 for the rest of the bootloader.
+ */
+#ifndef BL_RAM_BUFFER_LIMIT
+#   define BL_RAM_BUFFER_LIMIT FLASH_SECTOR_SIZE
+#endif
+
+static_assert((RAM_BUFFER_SIZE % FLASH_PAGE_SIZE) == 0, "RAM_BUFFER_SIZE must be a multiple of FLASH_PAGE_SIZE");
+static_assert((RAM_BUFFER_SIZE >= FLASH_PAGE_SIZE) && (RAM_BUFFER_SIZE <= FLASH_SECTOR_SIZE), "RAM_BUFFER_SIZE must be between FLASH_PAGE_SIZE and FLASH_SECTOR_SIZE");
 
 /**
  * Handles KNX @ref APCI_USERMSG_MANUFACTURER_0 which encapsulates our UPD/UDP protocol
@@ -22,6 +22,8 @@
 #include "boot_descriptor_block.h"
 #include "crc.h"
 #include <memory>
+#include <stddef.h>
+#include <string.h>
 
 #ifndef IAP_EMULATION
 extern uint8_t __base_Flash[];      //!< marks the beginning of the flash memory (inserted by the linker)
@@ -71,7 +73,13 @@ unsigned int checkVectorTable(uint8_t * start)
     return (~cs+1);
 }
 
-unsigned int checkApplication(AppDescriptionBlock * block)
+/**
+ * @brief Checks the start and end address of the application description block
+ *
+ * @param block Application description block to check
+ * @return      true if the addresses are inside the application flash
+ */
+static bool checkApplicationRange(AppDescriptionBlock * block)
 {
     if ((block->startAddress < applicationFirstAddress()) || (block->startAddress > flashLastAddress())) // we have just 64k of Flash
     {
@@ -85,6 +93,15 @@ unsigned int checkApplication(AppDescriptionBlock * block)
     {
         return (0);
     }
+    return (1);
+}
+
+unsigned int checkApplication(AppDescriptionBlock * block)
+{
+    if (!checkApplicationRange(block))
+    {
+        return (0);
+    }
 
     unsigned int blockSize = block->endAddress - block->startAddress + 1;
     unsigned int crc = crc32(0xFFFFFFFF, (unsigned char *) block->startAddress, blockSize);
@@ -98,6 +115,122 @@ unsigned int checkApplication(AppDescriptionBlock * block)
     return (0);
 }
 
+#if BL_APP_VERIFIED_MARKER
+/**
+ * @brief Get the marker of the boot descriptor page of the block
+ */
+static AppVerifiedMarker * appVerifiedMarker(AppDescriptionBlock * block)
+{
+    return ((AppVerifiedMarker *) ((uint8_t *) block + APP_VERIFIED_MARKER_OFFSET));
+}
+
+/**
+ * @brief Builds the marker for the block
+ */
+static void buildAppVerifiedMarker(AppDescriptionBlock * block, AppVerifiedMarker * marker)
+{
+    marker->magic = APP_VERIFIED_MAGIC;
+    marker->appCrc = block->crc;
+    marker->descriptorCrc = crc32(0xFFFFFFFF, (unsigned char *) block,
+                                  offsetof(AppDescriptionBlock, appVersionAddress) + sizeof(block->appVersionAddress));
+    marker->check = ~(marker->magic ^ marker->appCrc ^ marker->descriptorCrc);
+}
+
+/**
+ * @brief Programs the marker into the boot descriptor page without an erase
+ *
+ * The flash can only clear bits, so the page is programmed with its current
+ * content and the new marker. This leaves the application description block untouched.
+ */
+static bool programAppVerifiedMarker(AppDescriptionBlock * block, const AppVerifiedMarker * marker)
+{
+    uint8_t __attribute__ ((aligned (FLASH_RAM_BUFFER_ALIGNMENT))) page[BOOT_BLOCK_DESC_SIZE];
+
+    memcpy(page, block, BOOT_BLOCK_DESC_SIZE);
+    memcpy(page + APP_VERIFIED_MARKER_OFFSET, marker, sizeof(AppVerifiedMarker));
+    return (iapProgram((uint8_t *) block, page, BOOT_BLOCK_DESC_SIZE) == IAP_SUCCESS);
+}
+#endif
+
+bool appVerifiedMarkerValid(AppDescriptionBlock * block)
+{
+#if BL_APP_VERIFIED_MARKER
+    AppVerifiedMarker expected;
+    buildAppVerifiedMarker(block, &expected);
+    return (memcmp(appVerifiedMarker(block), &expected, sizeof(expected)) == 0);
+#else
+    return (false);
+#endif
+}
+
+bool appVerifiedMarkerBlank(AppDescriptionBlock * block)
+{
+#if BL_APP_VERIFIED_MARKER
+    uint8_t * marker = (uint8_t *) appVerifiedMarker(block);
+    for (unsigned int i = 0; i < sizeof(AppVerifiedMarker); i++)
+    {
+        if (marker[i] != 0xFF)
+        {
+            return (false);
+        }
+    }
+    return (true);
+#else
+    return (false);
+#endif
+}
+
+bool writeAppVerifiedMarker(AppDescriptionBlock * block)
+{
+#if BL_APP_VERIFIED_MARKER
+    if (appVerifiedMarkerValid(block))
+    {
+        return (true);
+    }
+    if (!appVerifiedMarkerBlank(block))
+    {
+        // an old marker is in the way, the next update of the descriptor erases it
+        return (false);
+    }
+
+    AppVerifiedMarker marker;
+    buildAppVerifiedMarker(block, &marker);
+    return (programAppVerifiedMarker(block, &marker));
+#else
+    return (false);
+#endif
+}
+
+void invalidateAppVerifiedMarker(AppDescriptionBlock * block)
+{
+#if BL_APP_VERIFIED_MARKER
+    if (appVerifiedMarkerValid(block))
+    {
+        AppVerifiedMarker marker;
+        memset(&marker, 0, sizeof(marker));
+        programAppVerifiedMarker(block, &marker);
+    }
+#endif
+}
+
+unsigned int checkApplicationCached(AppDescriptionBlock * block)
+{
+    if (!checkApplicationRange(block))
+    {
+        return (0);
+    }
+    if (appVerifiedMarkerValid(block))
+    {
+        return (1);
+    }
+    if (!checkApplication(block))
+    {
+        return (0);
+    }
+    writeAppVerifiedMarker(block);
+    return (1);
+}
+
 char* getAppVersion(AppDescriptionBlock * block)
 {
     void * appVersionAddress = (void *)(block->appVersionAddress);
@@ -145,7 +278,11 @@ uint8_t * bootLoaderLastAddress(void)
 unsigned int bootLoaderSize(void)
 {
     // includes .text and .data
+#ifndef IAP_EMULATION
     return ((unsigned int)(uintptr_t)&_image_size);
+#else
+    return (_image_size);
+#endif
 }
 
 uint8_t * flashFirstAddress(void)
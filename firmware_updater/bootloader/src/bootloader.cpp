@@ -233,7 +233,9 @@ static void run_updater(bool programmingMode)
 /**
  * @brief Checks if "magic word" @ref BOOTLOADER_MAGIC_ADDRESS for bootloader mode is present and starts in bootloader mode.<br/>
  *        If no "magic word" is present it checks for a valid application to start,<br>
- *        otherwise starts in bootloader mode
+ *        otherwise starts in bootloader mode.<br/>
+ *        The crc of the application is only checked if no @ref AppVerifiedMarker is recorded,
+ *        or if the application requested it with @ref BOOTLOADER_MAGIC_WORD_VERIFY
  *
  * @return never returns
  */
@@ -250,6 +252,8 @@ static void run_updater(bool programmingMode)
         *magicWord = 0;	// avoid restarting BL after flashing
         run_updater(true);
     }
+    // Full application check requested by the application
+    bool fullCheck = (*magicWord == BOOTLOADER_MAGIC_WORD_VERIFY);
     *magicWord = 0;		// wrong magicWord, delete it
 
     // Enter Updater when programming button was pressed at power up
@@ -261,8 +265,17 @@ static void run_updater(bool programmingMode)
 
     // Start main application at address
     AppDescriptionBlock * block = (AppDescriptionBlock *) bootDescriptorBlockAddress();
-    if (checkApplication(block))
+    if (fullCheck)
     {
+        if (checkApplication(block))
+        {
+            jumpToApplication(block->startAddress);
+        }
+        invalidateAppVerifiedMarker(block);
+    }
+    else if (checkApplicationCached(block))
+    {
+        // the crc over the application is only checked until it passed once, see AppVerifiedMarker
         jumpToApplication(block->startAddress);
     }
     // Start updater in case of error
@@ -31,9 +31,25 @@
 #define ADDR_FROM_RAM 0b10000000
 
 Decompressor::Decompressor(AppDescriptionBlock* BaseAddress)
+{
+    reset(BaseAddress);
+}
+
+void Decompressor::reset(AppDescriptionBlock* BaseAddress)
 {
     startAddrOfFlash = getFirmwareStartAddress(BaseAddress);
 	startAddrOfPageToBeFlashed = startAddrOfFlash;
+	scratchpad = pageBuffer;
+	memset(pageBuffer, 0, sizeof(pageBuffer));
+	memset(oldPages, 0, sizeof(oldPages));
+	oldestPageSlot = 0;
+	pendingPages = 0;
+	iapCallsSaved = 0;
+	bytesToFlash = 0;
+	rawLength = 0;
+	cmdBufferLength = 0;
+	expectedCmdLength = 0;
+	resetStateMachine();
 }
 
 int Decompressor::getLength()
@@ -77,6 +93,120 @@ void Decompressor::resetStateMachine()
 	state = State::EXPECT_COMMAND_BYTE;
 }
 
+void Decompressor::copyFromOldPages(unsigned int offset, unsigned int length)
+{
+	// offset is relative to the oldest page, which is not necessarily at the start of the ring
+	unsigned int index = (oldestPageSlot * FLASH_PAGE_SIZE + offset) % sizeof(oldPages);
+	unsigned int firstPart = sizeof(oldPages) - index;
+	if (firstPart > length)
+	{
+		firstPart = length;
+	}
+	memcpy(scratchpad + bytesToFlash, oldPages + index, firstPart);
+	// wrap around to the start of the ring
+	memcpy(scratchpad + bytesToFlash + firstPart, oldPages, length - firstPart);
+}
+
+void Decompressor::copyFromFlash(const uint8_t * source, unsigned int length)
+{
+	// the pending pages are directly in front of the current page, their new content is still in RAM
+	const uint8_t * pendingStart = startAddrOfPageToBeFlashed - pendingPages * FLASH_PAGE_SIZE;
+	uint8_t * destination = scratchpad + bytesToFlash;
+	while (length)
+	{
+		const uint8_t * from = source;
+		unsigned int count = length;
+		if (source < pendingStart)
+		{
+			if (count > (unsigned int)(pendingStart - source))
+			{
+				count = pendingStart - source;
+			}
+		}
+		else if (source < startAddrOfPageToBeFlashed)
+		{
+			from = pageBuffer + (source - pendingStart);
+			if (count > (unsigned int)(startAddrOfPageToBeFlashed - source))
+			{
+				count = startAddrOfPageToBeFlashed - source;
+			}
+		}
+		memcpy(destination, from, count);
+		destination += count;
+		source += count;
+		length -= count;
+	}
+}
+
+UDP_State Decompressor::executeCopy()
+{
+	unsigned int length = getLength();
+	unsigned int address = getCopyAddress();
+
+	if ((bytesToFlash + length) > FLASH_PAGE_SIZE)
+	{
+		dline("\n\rCopy exceeds the page");
+		return (UDP_RAM_BUFFER_OVERFLOW);
+	}
+
+	if (isCopyFromRam())
+	{
+		d1("\n\rCopy from RAM with length ");
+		d2(length,DEC,4);
+		d1(", address offset 0x")
+		d2(address,HEX,4);
+		d1("\n\r");
+		if ((address + length) > sizeof(oldPages))
+		{
+			return (UDP_INVALID_DATA);
+		}
+		copyFromOldPages(address, length);
+	}
+	else
+	{
+		d1("\n\rCopy from ROM with length ");
+		d2(length,DEC,4);
+		d1(", address offset 0x")
+		d2(address,HEX,4);
+		d1("\n\r");
+		// pages up to the end of the flash can be referenced, pages already flashed contain the new content
+		uint8_t * source = startAddrOfFlash + address;
+		if ((length > 0) && ((source + length - 1) > flashLastAddress()))
+		{
+			return (UDP_INVALID_DATA);
+		}
+		copyFromFlash(source, length);
+	}
+	bytesToFlash += length;
+	return (UDP_IAP_SUCCESS);
+}
+
+UDP_State Decompressor::programPendingPages()
+{
+	if (pendingPages == 0)
+	{
+		return (UDP_IAP_SUCCESS);
+	}
+
+	uint8_t * address = startAddrOfPageToBeFlashed - pendingPages * FLASH_PAGE_SIZE;
+	d1("Diff - Program ");
+	d2(pendingPages, DEC, 2);
+	d1(" Pages at Address 0x");
+	d2ptr(address);
+
+	// one erase for all pages and as few program calls as possible, instead of an erase and a program per page
+	unsigned int iapCalls = flashIapCallCount();
+	UDP_State result = programFlashRange(address, pageBuffer, pendingPages * FLASH_PAGE_SIZE);
+	//result = UDP_IAP_SUCCESS; // Dry RUN! for debug
+	iapCalls = flashIapCallCount() - iapCalls;
+	if (iapCalls < 2 * pendingPages)
+	{
+		iapCallsSaved += 2 * pendingPages - iapCalls;
+	}
+	pendingPages = 0;
+	return (result);
+}
+
 UDP_State Decompressor::pageCompletedDoFlash()
 {
 	// backup old page content, flash new content from scratchpad RAM to flash
@@ -84,49 +214,63 @@ UDP_State Decompressor::pageCompletedDoFlash()
 
 	// Keep a copy of the last couple of flash pages in a RAM buffer for the differ
 	// RAM buffer size is set by REMEMBER_OLD_PAGES_COUNT * FLASH_PAGE_SIZE
-	// this is a FIFO buffer, oldest pages gets dropped
-	// shift data one flash page forward to make space for new page at the end
-	memcpy(oldPages, oldPages + FLASH_PAGE_SIZE, sizeof(oldPages) - FLASH_PAGE_SIZE);
-	// add latest (current) page (this may not be whole page when EOF) at the end
-	memcpy(oldPages + (FLASH_PAGE_SIZE * (REMEMBER_OLD_PAGES_COUNT-1)), startAddrOfPageToBeFlashed, FLASH_PAGE_SIZE);
+	// this is a ring buffer, the oldest page gets replaced by the current one
+	memcpy(oldPages + oldestPageSlot * FLASH_PAGE_SIZE, startAddrOfPageToBeFlashed, FLASH_PAGE_SIZE);
+	oldestPageSlot = (oldestPageSlot + 1) % REMEMBER_OLD_PAGES_COUNT;
 
 	// Check if flash page is identical or if we need to flash it
 	d1("Diff - Compare Page ");
 	d2(getFlashPageNumberToBeFlashed(), DEC,2);
 	if (memcmp(startAddrOfPageToBeFlashed, scratchpad, bytesToFlash) != 0)
 	{
-		// erase the page to be flashed
-		d1(" different, Erase Page");
-		//d2(getFlashPageNumberToBeFlashed(), DEC,2);
-
-		result = erasePageRange(getFlashPageNumberToBeFlashed(), getFlashPageNumberToBeFlashed());
-		//result = UDP_IAP_SUCCESS; // Dry RUN! for debug
-
-		// proceed to flash the decompressed page stored in the scratchpad RAM
-		d1("Diff - Program Page at Address 0x");
-		d2ptr(startAddrOfPageToBeFlashed);
-		result = executeProgramFlash(startAddrOfPageToBeFlashed, scratchpad, FLASH_PAGE_SIZE);
-		//result = UDP_IAP_SUCCESS; // Dry RUN! for debug
+		// the scratchpad already is the next page of pageBuffer, flash the run of pages
+		// once the buffer is full or the sector ends
+		dline(" different, pending");
+		pendingPages++;
+		startAddrOfPageToBeFlashed += FLASH_PAGE_SIZE;
+		if ((pendingPages == DECOMPRESSOR_BATCH_PAGES) ||
+		    ((((uintptr_t)startAddrOfPageToBeFlashed) & (FLASH_SECTOR_SIZE - 1)) == 0))
+		{
+			result = programPendingPages();
+		}
 	}
 	else
 	{
 	    dline("  equal, skipping!");
+	    // the run of differing pages ends here
+	    result = programPendingPages();
+	    startAddrOfPageToBeFlashed += FLASH_PAGE_SIZE;
 	}
-	// Equal, skip this page and
-	// move to next page
-	startAddrOfPageToBeFlashed += FLASH_PAGE_SIZE;
 	// reinitialize scratchpad
+	scratchpad = pageBuffer + pendingPages * FLASH_PAGE_SIZE;
 	bytesToFlash = 0;
-	memset(scratchpad, 0, sizeof(scratchpad));
+	memset(scratchpad, 0, FLASH_PAGE_SIZE);
 	//d1("result = 0x");
 	//d2(result,HEX,2);
 	//dline("");
 	return (result);
 }
 
-void Decompressor::putByte(uint8_t data)
+UDP_State Decompressor::flush()
+{
+	UDP_State result = programPendingPages();
+	if (scratchpad != pageBuffer)
+	{
+		// keep a partly received page
+		memmove(pageBuffer, scratchpad, FLASH_PAGE_SIZE);
+		scratchpad = pageBuffer;
+	}
+	return (result);
+}
+
+unsigned int Decompressor::getIapCallsSaved()
+{
+	return (iapCallsSaved);
+}
+
+UDP_State Decompressor::putByte(uint8_t data)
 {
-	//System.out.println("Decompressor processing new byte " + (data & 0xff) + ", state=" + state);
+	UDP_State result = UDP_IAP_SUCCESS;
 	//UART_printf("@ b=%02X s=%02X i=%d", data, state, bytesToFlash);
 	switch (state)
 	{
@@ -137,99 +281,54 @@ void Decompressor::putByte(uint8_t data)
 			if ((data & CMD_COPY) == CMD_COPY)
 			{
 				expectedCmdLength += 3; // 3 more bytes of source address
-				//d1(" CMD_COPY");
 			}
-			//else
-			//{
-				//d1(" CMD_RAW");
-			//}
 			if ((data & FLAG_LONG) == FLAG_LONG)
 			{
-				//d1(" FLAG_LONG");
 				expectedCmdLength += 1; // 1 more byte for longer length
 			}
 			if (expectedCmdLength > 1)
 			{
 				state = State::EXPECT_COMMAND_PARAMS;
 			}
-			else
+			else if (getLength() > 0)
 			{
 				state = State::EXPECT_RAW_DATA;
 				rawLength = 0;
 			}
 			break;
 		case State::EXPECT_COMMAND_PARAMS:
-			//d1(" params");
 			cmdBuffer[cmdBufferLength++] = data;
 			if (cmdBufferLength >= expectedCmdLength)
 			{
 				// we have all params of the command
 				if ((cmdBuffer[0] & CMD_COPY) == CMD_COPY)
 				{
-					// perform copy
-					if (isCopyFromRam())
-					{
-						//UART_printf(" DO COPY FROM RAM l=%d sa=%08X", getLength(), getCopyAddress());
-						d1("\n\rCopy from RAM with length ");
-						d2(getLength(),DEC,4);
-						d1(", address offset 0x")
-						d2(getCopyAddress(),HEX,4);
-						d1("\n\r");
-						//System.out.println("COPY FROM RAM index=" + scratchpadIndex + " length=" + getLength() + " from addr=" + getCopyAddress());
-						//System::arraycopy(oldPagesRam->getOldBinData(), getCopyAddress(), scratchpad, scratchpadIndex, getLength());
-						memcpy(scratchpad + bytesToFlash, oldPages + getCopyAddress(), getLength());
-						//for (int i = 0; i < getLength(); i++)
-						//{
-						//	if (i % 16 == 0) {
-						//		d1("\n\r ");
-						//	}
-							//UART_printf("%02X ", oldPages[getCopyAddress() + i]);
-							//d2(oldPages[getCopyAddress() + i],HEX,4);
-							//d1(" ");
-						//}
-					}
-					else
-					{
-						//UART_printf(" DO COPY FROM ROM l=%d sa=%08X", getLength(), getCopyAddress());
-						d1("\n\rCopy from ROM with length ");
-						d2(getLength(),DEC,4);
-						d1(", address offset 0x")
-						d2(getCopyAddress(),HEX,4);
-						d1("\n\r");
-						//d1(" FlashStart ");
-						//d2(startAddrOfFlash,HEX,6)
-						//System.out.println("COPY FROM ROM index=" + scratchpadIndex + " length=" + getLength() + " from addr=" + getCopyAddress());
-						//System.out.println(rom.getBinData()[getCopyAddress()] & 0xff);
-						//System.out.println(rom.getBinData()[getCopyAddress()+1] & 0xff);
-						//System.out.println(rom.getBinData()[getCopyAddress()+2] & 0xff);
-						//System::arraycopy(rom->getBinData(), getCopyAddress(), scratchpad, scratchpadIndex, getLength());
-						memcpy(scratchpad + bytesToFlash, startAddrOfFlash + getCopyAddress(), getLength());
-						//for (int i = 0; i < getLength(); i++)
-						//{
-						//	if (i % 16 == 0) {
-						//		d1("\n\r ");
-						//	}
-							//UART_printf("%02X ", startAddrOfFlash[getCopyAddress() + i]);
-							//d2(startAddrOfFlash[getCopyAddress() + i],HEX,2);
-							//d1(" ");
-						//}
-					}
-					bytesToFlash += getLength();
-					// and finish command
+					// perform copy and finish command
+					result = executeCopy();
 					resetStateMachine();
 				}
-				else
+				else if (getLength() > 0)
 				{
 					// next, read raw data
 					state = State::EXPECT_RAW_DATA;
 					rawLength = 0;
 				}
+				else
+				{
+					resetStateMachine();
+				}
 			} // else expect more params of the command
 			break;
 		case State::EXPECT_RAW_DATA:
-			//d1(" raw");
 			// store data read to scratchpad
-			scratchpad[bytesToFlash++] = data;
+			if (bytesToFlash < FLASH_PAGE_SIZE)
+			{
+				scratchpad[bytesToFlash++] = data;
+			}
+			else
+			{
+				result = UDP_RAM_BUFFER_OVERFLOW;
+			}
 			rawLength++;
 			if (rawLength >= getLength())
 			{
@@ -238,6 +337,7 @@ void Decompressor::putByte(uint8_t data)
 			}
 	}
 	//UART_printf("\n\r");
+	return (result);
 }
 
 uint32_t Decompressor::getCrc32() {
@@ -264,8 +364,8 @@ uint32_t Decompressor::getBytesCountToBeFlashed() {
 	return (bytesToFlash);
 }
 
-uint8_t Decompressor::getFlashPageNumberToBeFlashed() {
-	return ((uint8_t)((uint32_t)startAddrOfPageToBeFlashed / FLASH_PAGE_SIZE));
+unsigned int Decompressor::getFlashPageNumberToBeFlashed() {
+	return (iapPageOfAddress(startAddrOfPageToBeFlashed));
 }
 
 /** @}*/
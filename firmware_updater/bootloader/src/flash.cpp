@@ -24,6 +24,8 @@
 #include "boot_descriptor_block.h"
 #include "dump.h"
 
+static unsigned int iapCallCount = 0; //!< number of erase and program IAP calls since reset
+
 /**
  * @brief Checks if the pointer is aligned.
  *
@@ -102,6 +104,8 @@ UDP_State erasePageRange(unsigned int startPage, unsigned int endPage)
         return (UDP_PAGE_NOT_ALLOWED_TO_ERASE);
     }
 
+    invalidateAppVerifiedMarker((AppDescriptionBlock *) bootDescriptorBlockAddress());
+    iapCallCount++;
     result = iapResult2UDPState(iapErasePageRange(startPage, endPage));
     d3(
         if (result != UDP_IAP_SUCCESS)
@@ -135,6 +139,8 @@ static UDP_State eraseSectorRange(unsigned int startSector, unsigned int endSect
         return (UDP_SECTOR_NOT_ALLOWED_TO_ERASE);
     }
 
+    invalidateAppVerifiedMarker((AppDescriptionBlock *) bootDescriptorBlockAddress());
+    iapCallCount++;
     result = iapResult2UDPState(iapEraseSectorRange(startSector, endSector));
     d3(
         if (result != UDP_IAP_SUCCESS)
@@ -265,9 +271,77 @@ UDP_State executeProgramFlash(uint8_t * address, const uint8_t * ram, unsigned i
         return (UDP_ADDRESS_NOT_ALLOWED_TO_FLASH);
     }
 
+    if (!isBootDescriptor)
+    {
+        invalidateAppVerifiedMarker((AppDescriptionBlock *) bootDescriptorBlockAddress());
+    }
+    iapCallCount++;
     result = iapResult2UDPState(iapProgram(address, ram, size));
     return (result);
 }
 
+/**
+ * @brief Checks if a flash range is erased.
+ *
+ * @param address start address of the range, word aligned
+ * @param size    size of the range in bytes, a multiple of 4
+ * @return        true if all bytes are 0xff, otherwise false
+ */
+static bool flashRangeBlank(const uint8_t * address, unsigned int size)
+{
+    const uint32_t * word = (const uint32_t *) address;
+    for (unsigned int i = 0; i < size / sizeof(uint32_t); i++)
+    {
+        if (word[i] != 0xffffffff)
+        {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+UDP_State programFlashRange(uint8_t * address, const uint8_t * ram, unsigned int size)
+{
+    if (!addressAllowedToProgram(address, size) || ((size % FLASH_PAGE_SIZE) != 0))
+    {
+        return (UDP_ADDRESS_NOT_ALLOWED_TO_FLASH);
+    }
+
+    UDP_State result = UDP_IAP_SUCCESS;
+    if (!flashRangeBlank(address, size))
+    {
+        result = eraseAddressRange(address, address + size - 1);
+        if (result != UDP_IAP_SUCCESS)
+        {
+            return (result);
+        }
+    }
+
+    while (size)
+    {
+        // largest size the IAP can program, without leaving the sector of the address
+        unsigned int sectorLeft = FLASH_SECTOR_SIZE - ((uintptr_t)address & (FLASH_SECTOR_SIZE - 1));
+        unsigned int count = FLASH_SECTOR_SIZE;
+        while ((count > size) || (count > sectorLeft) || (count == FLASH_SECTOR_SIZE / 2)) // IAP supports 256, 512, 1024 and 4096 bytes
+        {
+            count /= 2;
+        }
+
+        result = executeProgramFlash(address, ram, count);
+        if (result != UDP_IAP_SUCCESS)
+        {
+            return (result);
+        }
+        address += count;
+        ram += count;
+        size -= count;
+    }
+    return (result);
+}
+
+unsigned int flashIapCallCount(void)
+{
+    return (iapCallCount);
+}
 
 /** @}*/
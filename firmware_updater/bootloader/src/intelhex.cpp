@@ -31,12 +31,12 @@
 void dumpToSerialinIntelHex(Serial* serialPort, unsigned char* data, unsigned int count, unsigned int bytesPerLine)
 {
     unsigned char x;
-    unsigned int checkSum;
-    unsigned int address;
+    uintptr_t checkSum;
+    uintptr_t address;
     unsigned int i = 0;
     unsigned int bytesToWrite = bytesPerLine;
     byte hexType = HEX_DATA_RECORD;
-    unsigned int startAddress = (unsigned int)data;
+    uintptr_t startAddress = (uintptr_t)data;
 
     while (i < count)
     {
@@ -52,10 +52,10 @@ void dumpToSerialinIntelHex(Serial* serialPort, unsigned char* data, unsigned in
 
         // # of bytes
         checkSum += bytesToWrite;
-        serialPort->print(bytesToWrite, HEX, 2);
+        serialPort->print((uintptr_t)bytesToWrite, HEX, 2);
 
         // address
-        address = (unsigned int)data;
+        address = (uintptr_t)data;
         checkSum += ((address >> 8) & 0xff) + (address & 0xff);
         serialPort->print(address, HEX, 4);
 
@@ -88,7 +88,7 @@ void dumpToSerialinIntelHex(Serial* serialPort, unsigned char* data, unsigned in
     serialPort->print(startAddress, HEX, 4);
 
     // miss use of Offset to send end address
-    address = (unsigned int)data;
+    address = (uintptr_t)data;
     checkSum += ((address >> 8) & 0xff) + (address & 0xff);
     serialPort->print(address, HEX, 4);
     checkSum &= 0xff;
@@ -90,6 +90,7 @@ void updCommand2Serial(UPD_Command cmd)
         switch (cmd.code)
         {
             case UPD_SEND_DATA: d1("SEND_DATA"); break;
+            case UPD_SEND_DATA_LONG_OFFSET: d1("SEND_DATA_LONG_OFFSET"); break;
             case UPD_PROGRAM: d1("PROGRAM"); break;
             case UPD_UPDATE_BOOT_DESC: d1("UPDATE_BOOT_DESC"); break;
             case UPD_SEND_DATA_TO_DECOMPRESS: d1("SEND_DATA_TO_DECOMPRESS"); break;
@@ -111,6 +112,8 @@ void updCommand2Serial(UPD_Command cmd)
             case UPD_REQUEST_BL_IDENTITY: d1("REQUEST_BL_IDENTITY"); break;
             case UPD_RESPONSE_BL_IDENTITY: d1("RESPONSE_BL_IDENTITY"); break;
             case UPD_RESPONSE_BL_VERSION_MISMATCH: d1("RESPONSE_BL_VERSION_MISMATCH"); break;
+            case UPD_REQUEST_PAGE_CRC: d1("REQUEST_PAGE_CRC"); break;
+            case UPD_RESPONSE_PAGE_CRC: d1("RESPONSE_PAGE_CRC"); break;
             case UPD_SET_EMULATION: d1("SET_EMULATION"); break;
             default: serial.print("Command unknown", (unsigned int)cmd.code); break;
         }
@@ -48,6 +48,14 @@
     static Decompressor decompressor((AppDescriptionBlock*) bootDescriptorBlockAddress()); //!< get application base address from boot descriptor
 #endif
 
+#ifdef DECOMPRESSOR
+static_assert(RAM_BUFFER_SIZE + DECOMPRESSOR_RAM_SIZE <= BL_RAM_BUFFER_LIMIT,
+              "ram buffers exceed BL_RAM_BUFFER_LIMIT, reduce RAM_BUFFER_SIZE or DECOMPRESSOR_BATCH_PAGES");
+#else
+static_assert(RAM_BUFFER_SIZE <= BL_RAM_BUFFER_LIMIT,
+              "ram buffer exceeds BL_RAM_BUFFER_LIMIT, reduce RAM_BUFFER_SIZE");
+#endif
+
 
 #define DEVICE_LOCKED   ((unsigned int ) 0x5AA55AA5)     //!< magic number for device is locked and can't be flashed
 #define DEVICE_UNLOCKED ((unsigned int ) ~DEVICE_LOCKED) //!< magic number for device is unlocked and flashing is allowed
@@ -323,6 +331,10 @@ static bool updUnlockDevice(uint8_t * data, uint32_t size)
     setDeviceLockState(DEVICE_UNLOCKED);
     setLastError(UDP_IAP_SUCCESS);
     resetUPDProtocol();
+#ifdef DECOMPRESSOR
+    // a new session starts a new differential stream at the application start of the current boot descriptor
+    decompressor.reset((AppDescriptionBlock*) bootDescriptorBlockAddress());
+#endif
     return (true);
 }
 
@@ -411,20 +423,18 @@ static bool updEraseFullFlash()
 }
 
 /**
- * Handles the @ref UPD_SEND_DATA command and copies the received bytes from data to @ref ramBuffer
+ * Copies the received bytes of a @ref UPD_SEND_DATA or @ref UPD_SEND_DATA_LONG_OFFSET command to @ref ramBuffer
  *
- * @param data    data[0] must contain the ramBuffer location and data[1...] the bytes to copy to the ramBuffer
- * @param nCount  Number of bytes to copy
- * @post          calls setLastErrror with UDP_IAP_SUCCESS if successful, otherwise @ref UDP_RAM_BUFFER_OVERFLOW or a @ref UDP_State
- * @return        always true
- * @note          device must be unlocked
+ * @param location ramBuffer location to copy the bytes to
+ * @param data     the bytes to copy to the ramBuffer
+ * @param nCount   Number of bytes to copy
+ * @post           calls setLastErrror with UDP_IAP_SUCCESS if successful, otherwise @ref UDP_RAM_BUFFER_OVERFLOW
+ * @return         always true
  */
-static bool updSendData(uint8_t * data, uint32_t nCount)
+static bool copyToRamBuffer(unsigned int location, uint8_t * data, uint32_t nCount)
 {
-    ramLocation = data[0]; // Current Byte position as message number with 12 Bytes payload each
-    nCount --;             // 1 Bytes abziehen, da diese für die Nachrichtennummer verwendet wird
-
-    if ((ramLocation + nCount) > sizeof(ramBuffer)/sizeof(ramBuffer[0])) // enough space left?
+    ramLocation = location;
+    if ((ramLocation + nCount) > RAM_BUFFER_SIZE) // enough space left?
     {
         setLastError(UDP_RAM_BUFFER_OVERFLOW);
         dline("ramBuffer Full");
@@ -433,11 +443,11 @@ static bool updSendData(uint8_t * data, uint32_t nCount)
 
     bytesReceived += nCount;
 
-    memcpy(&ramBuffer[ramLocation], data + 1, nCount); //ab dem 1. Byte sind die Daten verfügbar
+    memcpy(&ramBuffer[ramLocation], data, nCount);
     setLastError(UDP_IAP_SUCCESS);
     for(unsigned int i=0; i<nCount; i++)
     {
-        d2(data[i+1],HEX,2);
+        d2(data[i],HEX,2);
         d1(" ");
     }
     d3(serial.print("at: ", ramLocation, DEC, 3));
@@ -446,13 +456,44 @@ static bool updSendData(uint8_t * data, uint32_t nCount)
 }
 
 /**
- * Handles the @ref UPD_PROGRAM command and copies the bytes from ramBuffer to flash
+ * Handles the @ref UPD_SEND_DATA command and copies the received bytes from data to @ref ramBuffer
+ *
+ * @param data    data[0] must contain the ramBuffer location and data[1...] the bytes to copy to the ramBuffer
+ * @param nCount  Number of bytes in data
+ * @post          calls setLastErrror with UDP_IAP_SUCCESS if successful, otherwise @ref UDP_RAM_BUFFER_OVERFLOW or a @ref UDP_State
+ * @return        always true
+ * @note          device must be unlocked
+ */
+static bool updSendData(uint8_t * data, uint32_t nCount)
+{
+    // Current Byte position as message number with 12 Bytes payload each, the data is available from the 1. byte on
+    return (copyToRamBuffer(data[0], data + 1, nCount - 1));
+}
+
+/**
+ * Handles the @ref UPD_SEND_DATA_LONG_OFFSET command and copies the received bytes from data to @ref ramBuffer.
+ * Needed for ram buffer locations behind the first 256 bytes.
+ *
+ * @param data    data[0-1] must contain the ramBuffer location and data[2...] the bytes to copy to the ramBuffer
+ * @param nCount  Number of bytes in data
+ * @post          calls setLastErrror with UDP_IAP_SUCCESS if successful, otherwise @ref UDP_RAM_BUFFER_OVERFLOW or a @ref UDP_State
+ * @return        always true
+ * @note          device must be unlocked
+ */
+static bool updSendDataLongOffset(uint8_t * data, uint32_t nCount)
+{
+    return (copyToRamBuffer(streamToUShort16(data), data + 2, nCount - 2));
+}
+
+/**
+ * Handles the @ref UPD_PROGRAM command and copies the bytes from ramBuffer to flash.
+ * The ramBuffer behind the received bytes is filled up with 0xff to the next page boundary.
  *
  * @param data    the number of bytes to flash is in data[0-1], the flash address to program in data[2-5], and the crc32 in data[6-9]
  * @post          calls setLastErrror with UDP_IAP_SUCCESS if successful, otherwise a @ref UDP_State or a @ref UDP_State
  * @return        true
  * @note          device must be unlocked
- * @warning       The function calls @ref executeProgramFlash which calls @ref iap_Program which by itself calls @ref no_interrupts().
+ * @warning       The function calls @ref programFlashRange which calls @ref iap_Program which by itself calls @ref no_interrupts().
  */
 static bool updProgram(uint8_t * data)
 {
@@ -467,7 +508,7 @@ static bool updProgram(uint8_t * data)
         return (true);
     }
 
-    if (flash_count > (sizeof(ramBuffer)/sizeof(ramBuffer[0])))
+    if (flash_count > RAM_BUFFER_SIZE)
     {
         setLastError(UDP_RAM_BUFFER_OVERFLOW);
         return (true);
@@ -481,30 +522,43 @@ static bool updProgram(uint8_t * data)
         return (true);
     }
 
-    // Select smallest possible sector size
-    if (flash_count > 4*FLASH_PAGE_SIZE)
-        flash_count = 16*FLASH_PAGE_SIZE;
-    else if (flash_count > 2*FLASH_PAGE_SIZE)
-        flash_count = 4*FLASH_PAGE_SIZE;
-    else if (flash_count > FLASH_PAGE_SIZE)
-        flash_count = 2*FLASH_PAGE_SIZE;
-    else
-        flash_count = FLASH_PAGE_SIZE;
+    // program whole pages only, the rest of the last page stays erased
+    unsigned int flashCount = (flash_count + FLASH_PAGE_SIZE - 1) & ~(FLASH_PAGE_SIZE - 1);
+    memset(ramBuffer + flash_count, 0xFF, flashCount - flash_count);
 
-    d3(serial.print("writing ", flash_count));
+    d3(serial.print("writing ", flashCount));
     d3(serial.print(" bytes @ 0x", address));
     d3(serial.println(" crc 0x", (uintptr_t)crcRamBuffer, HEX, 8));
 
-    bytesFlashed += flash_count;
-    UDP_State error = executeProgramFlash(address, ramBuffer, flash_count);
-    setLastError(error);
+    bytesFlashed += flashCount;
+    setLastError(programFlashRange(address, ramBuffer, flashCount));
     return (true);
 }
 
+/**
+ * Flashes the decompressed pages which are still pending in the @ref Decompressor,
+ * before a command other than the differential ones accesses the flash.
+ *
+ * @param command the received @ref UPD_Code
+ * @return UDP_IAP_SUCCESS if nothing was pending or all pending pages were flashed successfully,
+ *         otherwise the @ref UDP_State of the failed flashing
+ * @warning The function calls @ref Decompressor.flush which calls @ref iap_Program which by itself calls @ref no_interrupts().
+ */
+static UDP_State finishDecompressedPages(UPD_Code command)
+{
+#ifdef DECOMPRESSOR
+    if ((command != UPD_SEND_DATA_TO_DECOMPRESS) && (command != UPD_PROGRAM_DECOMPRESSED_DATA))
+    {
+        return (decompressor.flush());
+    }
+#endif
+    return (UDP_IAP_SUCCESS);
+}
+
 /**
  * Handles the @ref UPD_REQUEST_BL_IDENTITY command. Copies bootloader version (@ref BOOTLOADER_MAJOR_VERSION, @ref BOOTLOADER_MINOR_VERSION),
- *        bootloader features (@ref BL_FEATURES) and applications first possible start address (@ref applicationFirstAddress())
- *        to the return telegram.
+ *        bootloader features (@ref BL_FEATURES), applications first possible start address (@ref applicationFirstAddress())
+ *        and the size of the ram buffer (@ref RAM_BUFFER_SIZE) to the return telegram.
  *
  * @param data    the major version of Selfbus Updater in data[0-3],  the minor version of Selfbus Updater in data[4-7] *
  * @return always true
@@ -531,15 +585,18 @@ static bool updRequestBootloaderIdentity(uint8_t * data)
     }
 
     uint16_t bootloaderFeatures = BL_FEATURES;
+    bootloaderFeatures |= BL_FEATURE_PAGE_CRC;
     uint8_t majorSBLibVersion = highByte((uint16_t)SBLIB_VERSION);
     uint8_t minorSBLibVersion = lowByte(SBLIB_VERSION);
     uint8_t * appFirstAddress = applicationFirstAddress();
+    uint16_t ramBufferSize = RAM_BUFFER_SIZE;
     const uint32_t dataSize = sizeof(BOOTLOADER_MAJOR_VERSION) +
                               sizeof(BOOTLOADER_MINOR_VERSION) +
                               sizeof(majorSBLibVersion) +
                               sizeof(minorSBLibVersion) +
                               sizeof(bootloaderFeatures) +
-                              sizeof(appFirstAddress);
+                              sizeof(uint32_t) + // appFirstAddress is streamed as 4 bytes, also on a 64bit host
+                              sizeof(ramBufferSize);
 
     prepareReturnTelegram(dataSize, UPD_RESPONSE_BL_IDENTITY);
     retTelegram[offset] = BOOTLOADER_MAJOR_VERSION;
@@ -553,10 +610,13 @@ static bool updRequestBootloaderIdentity(uint8_t * data)
     retTelegram[offset] = minorSBLibVersion;
     offset += sizeof(minorSBLibVersion);
     ptrToStream(retTelegram + offset, appFirstAddress);
+    offset += sizeof(uint32_t);
+    uShort16ToStream(retTelegram + offset, ramBufferSize);
     d3(serial.print("BL v", BOOTLOADER_MAJOR_VERSION, DEC));
     d3(serial.print(".", BOOTLOADER_MINOR_VERSION, DEC, 2));
     d3(serial.print("    BL feature 0x", (unsigned int)bootloaderFeatures, HEX, 8));
-    d3(serial.println("    FW start   0x", (uintptr_t)appFirstAddress, HEX, 8));
+    d3(serial.print("    FW start   0x", (uintptr_t)appFirstAddress, HEX, 8));
+    d3(serial.println("    RAM buffer ", (unsigned int)ramBufferSize, DEC));
     return (true);
 }
 
@@ -567,13 +627,20 @@ static bool updRequestBootloaderIdentity(uint8_t * data)
  */
 static bool updRequestStatistic()
 {
-    uint32_t sizeTotal = sizeof(disconnectCount) + sizeof(repeatedT_ACKcount);
+#ifdef DECOMPRESSOR
+    uint16_t iapCallsSaved = decompressor.getIapCallsSaved();
+#else
+    uint16_t iapCallsSaved = 0;
+#endif
+    uint32_t sizeTotal = sizeof(disconnectCount) + sizeof(repeatedT_ACKcount) + sizeof(iapCallsSaved);
 
     prepareReturnTelegram(sizeTotal, UPD_RESPONSE_STATISTIC);
     uShort16ToStream(retTelegram + 9, disconnectCount);
     uShort16ToStream(retTelegram + 9 + sizeof(disconnectCount), repeatedT_ACKcount);
+    uShort16ToStream(retTelegram + 9 + sizeof(disconnectCount) + sizeof(repeatedT_ACKcount), iapCallsSaved);
     d3(serial.print(" #DC ", disconnectCount));
     d3(serial.print(" #repT_ACK ", repeatedT_ACKcount));
+    d3(serial.print(" #IAP saved ", iapCallsSaved));
     return (true);
 }
 
@@ -612,6 +679,50 @@ static bool udpRequestBootDescriptionBlock()
     return (true);
 }
 
+/**
+ * Handles the @ref UPD_REQUEST_PAGE_CRC command. Copies the crc32 of consecutive groups of flash pages
+ *        to the return telegram.
+ *
+ * @param data    the flash address of the first page in data[0-3], the number of crc32 in data[4]
+ *                and the number of pages per crc32 in data[5]
+ * @post          sends @ref UPD_RESPONSE_PAGE_CRC if successful, otherwise calls setLastErrror with
+ *                @ref UDP_INVALID_DATA or @ref UDP_ADDRESS_NOT_ALLOWED_TO_FLASH
+ * @return        always true
+ * @note          device must be unlocked
+ */
+static bool updRequestPageCrc(uint8_t * data)
+{
+    uint8_t * address = streamToPtr(data);
+    uint8_t crcCount = data[4];
+    uint8_t pagesPerCrc = data[5];
+
+    if ((crcCount == 0) || (crcCount > UPD_PAGE_CRC_MAX_COUNT) || (pagesPerCrc == 0))
+    {
+        setLastError(UDP_INVALID_DATA);
+        return (true);
+    }
+
+    const unsigned int crcSize = pagesPerCrc * FLASH_PAGE_SIZE;
+    const bool aligned = ((uintptr_t)address & (FLASH_PAGE_SIZE - 1)) == 0;
+    if (!aligned || (address < flashFirstAddress()) || (address > flashLastAddress()) ||
+        ((unsigned int)(flashLastAddress() - address) < crcCount * crcSize - 1))
+    {
+        setLastError(UDP_ADDRESS_NOT_ALLOWED_TO_FLASH);
+        return (true);
+    }
+
+    prepareReturnTelegram(sizeof(crcCount) + crcCount * sizeof(uint32_t), UPD_RESPONSE_PAGE_CRC);
+    retTelegram[9] = crcCount;
+    for (unsigned int i = 0; i < crcCount; i++)
+    {
+        uInt32ToStream(retTelegram + 10 + i * sizeof(uint32_t), crc32(0xFFFFFFFF, address, crcSize));
+        address += crcSize;
+    }
+    d3(serial.print("page crc ", (unsigned int)crcCount));
+    d3(serial.println(" x ", (unsigned int)pagesPerCrc));
+    return (true);
+}
+
 /**
  * Function not implemented.
  * \todo Function not implemented
@@ -683,6 +794,7 @@ static bool updUnkownCommand()
  *        - checks the crc32 of the received application boot descriptor block
  *        - if the received application boot descriptor block differs from the one already in Flash (@ref BOOT_DSCR_ADDRESS),
  *          checks that the address is allowed to program, erases the flash page and flashes the new one.
+ *        - records the @ref AppVerifiedMarker if the application passed the crc check
  *
  * @param data    - data[0..3] contains the length of the application boot descriptor block received
  *                - data[4..7] contains the crc32 of the received bytes
@@ -701,7 +813,7 @@ static bool updUpdateBootDescriptorBlock(uint8_t * data)
     UDP_State result = UDP_NOT_IMPLEMENTED;
 
     // check for a possible ramBuffer overflow
-    if (count > sizeof(ramBuffer)/sizeof(ramBuffer[0]))
+    if (count > BOOT_BLOCK_DESC_SIZE)
     {
         setLastError(UDP_RAM_BUFFER_OVERFLOW);
         dline("ramBuffer Full");
@@ -739,7 +851,9 @@ static bool updUpdateBootDescriptorBlock(uint8_t * data)
 
     d3(serial.println("CRC MATCH, comparing MCUs BootDescriptor: count: ", (unsigned int)count));
     //If received descriptor is not equal to current one, flash it
-    if(memcmp(address, ramBuffer, count) == 0)
+    //The page is also rewritten if an outdated verified marker blocks a new one
+    if ((memcmp(address, ramBuffer, count) == 0) &&
+        (appVerifiedMarkerValid((AppDescriptionBlock *) address) || appVerifiedMarkerBlank((AppDescriptionBlock *) address)))
     {
         d3(serial.println("is equal, skipping"));
         result = UDP_IAP_SUCCESS;
@@ -757,6 +871,11 @@ static bool updUpdateBootDescriptorBlock(uint8_t * data)
 
         d3(serial.print("Flash Page:"));
 
+        // keep the rest of the page erased for the verified marker
+        if (count < FLASH_PAGE_SIZE)
+        {
+            memset(ramBuffer + count, 0xFF, FLASH_PAGE_SIZE - count);
+        }
         result = executeProgramFlash(address, ramBuffer, FLASH_PAGE_SIZE, true); // no less than 256byte can be flashed
         d3(
            updResult2Serial(result);
@@ -782,6 +901,12 @@ static bool updUpdateBootDescriptorBlock(uint8_t * data)
         return (true);
     }
 
+    // the application passed the full check, the next boot can skip it
+    if (result == UDP_IAP_SUCCESS)
+    {
+        writeAppVerifiedMarker((AppDescriptionBlock *) address);
+    }
+
     setLastError(result);
     return (true);
 }
@@ -791,7 +916,8 @@ static bool updUpdateBootDescriptorBlock(uint8_t * data)
  *
  * @param data    data[0..nCount-1] buffer containing the bytes to "copy" to the @ref Decompressor
  * @param nCount  Number of bytes to read from data
- * @post          calls setLastErrror with UDP_IAP_SUCCESS if successful, otherwise @ref UDP_RAM_BUFFER_OVERFLOW or @ref UDP_NOT_IMPLEMENTED
+ * @post          calls setLastErrror with UDP_IAP_SUCCESS if successful, otherwise @ref UDP_RAM_BUFFER_OVERFLOW,
+ *                @ref UDP_INVALID_DATA or @ref UDP_NOT_IMPLEMENTED
  * @return        always true
  * @note          device must be unlocked
  * @warning       The function calls @ref Decompressor.pageCompletedDoFlash which calls @ref iap_Program which by itself calls @ref no_interrupts().
@@ -802,15 +928,15 @@ static bool updSendDataToDecompress(uint8_t * data, uint32_t nCount)
     dline("-->not implemented")
     setLastError(UDP_NOT_IMPLEMENTED);
 #else
-    if ((ramLocation + nCount) > (sizeof(ramBuffer)/sizeof(ramBuffer[0]))) // Check if this can be removed. Overflow protection should be in decompressor class instead!
-    {
-        setLastError(UDP_RAM_BUFFER_OVERFLOW);
-        return (true);
-    }
     dline("-->decompressor");
     for (unsigned int i = 0; i < nCount; i++)
     {
-        decompressor.putByte(data[i]);
+        UDP_State result = decompressor.putByte(data[i]);
+        if (result != UDP_IAP_SUCCESS)
+        {
+            setLastError(result);
+            return (true);
+        }
     }
     setLastError(UDP_IAP_SUCCESS);
 #endif
@@ -931,6 +1057,31 @@ bool handleApciUsermsgManufacturerInternal(uint8_t * data, uint32_t size)
         }
     }
 
+    // commands accessing the flash have to wait for pending decompressed pages and report their failure
+    switch (updCommand.code)
+    {
+        case UPD_PROGRAM:
+        case UPD_UPDATE_BOOT_DESC:
+        case UPD_SEND_DATA_TO_DECOMPRESS:
+        case UPD_PROGRAM_DECOMPRESSED_DATA:
+        case UPD_ERASE_COMPLETE_FLASH:
+        case UPD_ERASE_ADDRESSRANGE:
+        case UPD_REQUEST_BOOT_DESC:
+        case UPD_REQUEST_PAGE_CRC:
+        {
+            UDP_State error = finishDecompressedPages(updCommand.code);
+            if (error != UDP_IAP_SUCCESS)
+            {
+                setLastError(error);
+                return (true);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
     // now comes the real work on the unlocked device
     switch (updCommand.code)
     {
@@ -946,6 +1097,9 @@ bool handleApciUsermsgManufacturerInternal(uint8_t * data, uint32_t size)
         case UPD_SEND_DATA:
             return (updSendData(data, size));
 
+        case UPD_SEND_DATA_LONG_OFFSET:
+            return (updSendDataLongOffset(data, size));
+
         case UPD_PROGRAM:
             return (updProgram(data));
 
@@ -979,6 +1133,9 @@ bool handleApciUsermsgManufacturerInternal(uint8_t * data, uint32_t size)
 		case UPD_REQ_DATA:
 		    return (updRequestData());
 
+        case UPD_REQUEST_PAGE_CRC:
+            return (updRequestPageCrc(data));
+
         default:
             return (updUnkownCommand());
     }
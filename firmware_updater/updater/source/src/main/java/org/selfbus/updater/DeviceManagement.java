@@ -32,6 +32,7 @@ public final class DeviceManagement {
     private static final int TL4_CONNECTION_TIMEOUT_MS = 6300; ///\todo delete after TL4 Style 3 implementation in sblib
 
     public static final int MAX_UPD_COMMAND_RETRY = 3; //!< default maximum retries a UPD command is sent to the client
+    private static final int PAGE_CRC_MAX_COUNT = 3; //!< maximum number of crc32 in a RESPONSE_PAGE_CRC
 
     /** Use transport layer 4 connections timeout for closing MCUs TL4 connection*/
     private boolean tl4Timeout = false; ///\todo delete after TL4 Style 3 implementation in sblib
@@ -187,6 +188,38 @@ public final class DeviceManagement {
         return bootDescriptor;
     }
 
+    /**
+     * Requests the crc32 of consecutive flash pages, in batches of PAGE_CRC_MAX_COUNT pages.
+     *
+     * @param startAddress flash address of the first page
+     * @param pageCount    number of pages
+     * @return the crc32 of every page
+     */
+    public long[] requestPageCrcs(long startAddress, int pageCount)
+            throws KNXTimeoutException, KNXLinkClosedException, KNXDisconnectException, KNXRemoteException, InterruptedException, UpdaterException {
+        logger.info("\nRequesting crc32 of {} flash pages...", pageCount);
+        long[] crcs = new long[pageCount];
+        int page = 0;
+        while (page < pageCount) {
+            int count = Math.min(PAGE_CRC_MAX_COUNT, pageCount - page);
+            byte[] telegram = new byte[6];
+            Utils.longToStream(telegram, 0, startAddress + (long) page * Mcu.FLASH_PAGE_SIZE);
+            telegram[4] = (byte) count;
+            telegram[5] = 1; // one page per crc32
+            byte[] result = sendWithRetry(UPDCommand.REQUEST_PAGE_CRC, telegram, MAX_UPD_COMMAND_RETRY).data();
+            if ((result[COMMAND_POSITION] != UPDCommand.RESPONSE_PAGE_CRC.id) || (result[DATA_POSITION] != count)) {
+                UPDProtocol.checkResult(result);
+                restartProgrammingDevice();
+                throw new UpdaterException("Requesting crc32 of the flash pages failed.");
+            }
+            for (int i = 0; i < count; i++) {
+                crcs[page + i] = Utils.streamToLong(result, DATA_POSITION + 1 + i * 4);
+            }
+            page += count;
+        }
+        return crcs;
+    }
+
     public String requestAppVersionString()
             throws KNXTimeoutException, KNXLinkClosedException, KNXDisconnectException, KNXRemoteException, InterruptedException, UpdaterException {
         byte[] result = sendWithRetry(UPDCommand.APP_VERSION_REQUEST, new byte[0], MAX_UPD_COMMAND_RETRY).data();
@@ -250,18 +283,31 @@ public final class DeviceManagement {
         while (nIndex < data.length)
         {
 
+            // ram buffer addresses above 255 need a two byte address
+            UPDCommand command = UPDCommand.SEND_DATA;
+            int headerLength = 1;
+            if (nIndex > 0xff) {
+                command = UPDCommand.SEND_DATA_LONG_OFFSET;
+                headerLength = 2;
+            }
+
             byte[] txBuffer;
-            if ((data.length - nIndex) >= Mcu.MAX_PAYLOAD){
+            if ((data.length - nIndex) >= Mcu.MAX_PAYLOAD + 1 - headerLength){
                 txBuffer = new byte[Mcu.MAX_PAYLOAD + 1];
             }
             else {
-                txBuffer = new byte[data.length - nIndex + 1];
+                txBuffer = new byte[data.length - nIndex + headerLength];
+            }
+            // First byte(s) contain start address of following data
+            if (headerLength == 1) {
+                txBuffer[0] = (byte)nIndex;
+            }
+            else {
+                Utils.shortToStream(txBuffer, 0, (short)nIndex);
             }
-            // First byte contains start address of following data
-            txBuffer[0] = (byte)nIndex;
-            System.arraycopy(data, nIndex, txBuffer, 1, txBuffer.length - 1);
+            System.arraycopy(data, nIndex, txBuffer, headerLength, txBuffer.length - headerLength);
 
-            ResponseResult tmp = sendWithRetry(UPDCommand.SEND_DATA, txBuffer, maxRetry);
+            ResponseResult tmp = sendWithRetry(command, txBuffer, maxRetry);
             result.addCounters(tmp);
 
             if ((tmp.dropCount() > 0) || (tmp.timeoutCount() > 0)) {
@@ -278,7 +324,7 @@ public final class DeviceManagement {
                 Thread.sleep(delay); //Reduce bus load during data upload, without 2:04, 50ms 2:33, 60ms 2:41, 70ms 2:54, 80ms 3:04
             }
 
-            nIndex += txBuffer.length - 1;
+            nIndex += txBuffer.length - headerLength;
         }
         result.addWritten(nIndex);
         return result;
@@ -1,5 +1,6 @@
 package org.selfbus.updater;
 
+import org.selfbus.updater.bootloader.BootloaderIdentity;
 import org.selfbus.updater.upd.UDPResult;
 import org.selfbus.updater.upd.UPDCommand;
 import org.selfbus.updater.upd.UPDProtocol;
@@ -12,6 +13,7 @@ import tuwien.auto.calimero.mgmt.KNXDisconnectException;
 
 import java.io.ByteArrayInputStream;
 import java.io.IOException;
+import java.util.Arrays;
 
 /**
  * Provides full flash mode for the bootloader (MCU)
@@ -21,8 +23,12 @@ public class FlashFullMode {
 
     /**
      * Normal update routine, sending complete image
+     * The image is sent in blocks of the bootloader's ram buffer size.
+     * If the bootloader reports the crc32 of its flash pages, only pages with a different crc32
+     * are erased and sent. Each run of consecutive different pages is erased with one command.
      */
-    public static ResponseResult doFullFlash(DeviceManagement dm, BinImage newFirmware, int dataSendDelay, boolean eraseFirmwareRange, boolean logStatistics)
+    public static ResponseResult doFullFlash(DeviceManagement dm, BinImage newFirmware, int dataSendDelay, boolean eraseFirmwareRange, boolean logStatistics,
+                                             BootloaderIdentity blIdentity)
             throws IOException, KNXDisconnectException, KNXTimeoutException, KNXLinkClosedException,
             InterruptedException, UpdaterException, KNXRemoteException {
         ResponseResult resultSendData, resultProgramData;
@@ -31,21 +37,54 @@ public class FlashFullMode {
         long totalLength = newFirmware.length();
         ByteArrayInputStream fis = new ByteArrayInputStream(newFirmware.getBinData());
 
-        if (eraseFirmwareRange) {
+        long[] deviceCrcs = null;
+        if (eraseFirmwareRange && blIdentity.supportsPageCrc()) {
+            // erase and send only the pages which differ from the device
+            int pageCount = (int) ((totalLength + Mcu.FLASH_PAGE_SIZE - 1) / Mcu.FLASH_PAGE_SIZE);
+            deviceCrcs = dm.requestPageCrcs(newFirmware.startAddress(), pageCount);
+            eraseChangedPages(dm, newFirmware, deviceCrcs);
+        }
+        else if (eraseFirmwareRange) {
             dm.eraseAddressRange(newFirmware.startAddress(), totalLength); // erase affected flash range
         }
+        long skippedBytes = 0;
 
-        byte[] buffer = new byte[Mcu.FLASH_PAGE_SIZE]; // buffer to hold one flash page
+        byte[] buffer = new byte[blIdentity.getRamBufferSize()]; // buffer to hold one ram buffer of the bootloader
         long progAddress = newFirmware.startAddress();
 
         logger.info("\nStart sending application data ({} bytes) with telegram delay of {}ms", totalLength, dataSendDelay);
 
         int nRead;
-        while ((nRead = fis.read(buffer)) != -1) { // Read up to size of buffer, default 1 Page of 256Bytes from file
-            byte[] txBuffer = new byte[nRead];
-            System.arraycopy(buffer, 0, txBuffer, 0, nRead);
+        while ((nRead = fis.read(buffer)) != -1) { // Read up to size of buffer, at least 1 Page of 256Bytes from file
+            // skip leading and trailing pages of the buffer, which are already on the device
+            int first = 0;
+            int last = nRead;
+            if (deviceCrcs != null) {
+                int firstPage = (int) ((progAddress - newFirmware.startAddress()) / Mcu.FLASH_PAGE_SIZE);
+                while ((first < last) && pageUnchanged(buffer, first, nRead, deviceCrcs[firstPage + first / Mcu.FLASH_PAGE_SIZE])) {
+                    first = Math.min(first + Mcu.FLASH_PAGE_SIZE, last);
+                }
+                while (last > first) {
+                    int lastPageStart = ((last - 1) / Mcu.FLASH_PAGE_SIZE) * Mcu.FLASH_PAGE_SIZE;
+                    if (!pageUnchanged(buffer, lastPageStart, nRead, deviceCrcs[firstPage + lastPageStart / Mcu.FLASH_PAGE_SIZE])) {
+                        break;
+                    }
+                    last = lastPageStart;
+                }
+            }
+            skippedBytes += nRead - (last - first);
+            if (first == last) {
+                logger.info("Skipping {} bytes at 0x{}, already programmed", nRead, String.format("%04X", progAddress));
+                progAddress += nRead;
+                continue;
+            }
+            long blockAddress = progAddress;
+            progAddress += first;
+
+            byte[] txBuffer = new byte[last - first];
+            System.arraycopy(buffer, first, txBuffer, 0, txBuffer.length);
 
-            logger.info("Sending {} bytes: {}%", txBuffer.length, String.format("%3.1f", (float) 100 * (resultTotal.written() + txBuffer.length) / totalLength));
+            logger.info("Sending {} bytes: {}%", txBuffer.length, String.format("%3.1f", (float) 100 * (blockAddress - newFirmware.startAddress() + nRead) / totalLength));
 
             // send data to the bootloader
             long flashTimeStart = System.currentTimeMillis(); // time this run started
@@ -80,13 +119,51 @@ public class FlashFullMode {
                 throw new UpdaterException("ProgramData update failed.");
             }
             resultTotal.addCounters(resultProgramData); // keep track of static data
-            progAddress += txBuffer.length;
+            progAddress = blockAddress + nRead;
 
             if (logStatistics) {
                 dm.requestBootLoaderStatistic();
             }
         }
         fis.close();
+        if (deviceCrcs != null) {
+            logger.info("{} of {} bytes were already programmed and skipped", skippedBytes, totalLength);
+        }
         return resultTotal;
     }
+
+    /**
+     * Checks a page of buffer against the crc32 the bootloader reported for it.
+     * The bootloader fills a page behind the data with 0xff.
+     */
+    /**
+     * Erase the runs of consecutive pages whose crc32 differs from the new firmware.
+     * The bootloader erases the whole sectors of a run with one sector erase
+     * and would otherwise erase every programmed block separately.
+     */
+    private static void eraseChangedPages(DeviceManagement dm, BinImage newFirmware, long[] deviceCrcs)
+            throws KNXLinkClosedException, InterruptedException, UpdaterException, KNXTimeoutException {
+        byte[] image = newFirmware.getBinData();
+        int page = 0;
+        while (page < deviceCrcs.length) {
+            if (pageUnchanged(image, page * Mcu.FLASH_PAGE_SIZE, image.length, deviceCrcs[page])) {
+                page++;
+                continue;
+            }
+            int runStart = page;
+            while ((page < deviceCrcs.length) &&
+                   !pageUnchanged(image, page * Mcu.FLASH_PAGE_SIZE, image.length, deviceCrcs[page])) {
+                page++;
+            }
+            dm.eraseAddressRange(newFirmware.startAddress() + (long) runStart * Mcu.FLASH_PAGE_SIZE,
+                                 (long) (page - runStart) * Mcu.FLASH_PAGE_SIZE);
+        }
+    }
+
+    private static boolean pageUnchanged(byte[] buffer, int offset, int length, long deviceCrc) {
+        byte[] page = new byte[Mcu.FLASH_PAGE_SIZE];
+        Arrays.fill(page, (byte) 0xff);
+        System.arraycopy(buffer, offset, page, 0, Math.min(Mcu.FLASH_PAGE_SIZE, length - offset));
+        return (Utils.crc32Value(page) & 0xffffffffL) == deviceCrc;
+    }
 }
@@ -75,6 +75,6 @@ public final class ToolInfo
     public static String minVersionBootloader() {
         return new BootloaderIdentity(minMajorVersionBootloader(),
                                       minMinorVersionBootloader(),
-                        0, 0, 0, 0).getVersion();
+                        0, 0, 0, 0, Mcu.FLASH_PAGE_SIZE).getVersion();
     }
 }
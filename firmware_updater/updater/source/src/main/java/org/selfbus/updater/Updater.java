@@ -403,7 +403,8 @@ public class Updater implements Runnable {
                     resultTotal = FlashDiffMode.doDifferentialFlash(dm, newFirmware.startAddress(), newFirmware.getBinData());
                 }
                 else {
-                    resultTotal = FlashFullMode.doFullFlash(dm, newFirmware, cliOptions.delay(), !cliOptions.eraseFullFlash(), cliOptions.logStatistics());
+                    resultTotal = FlashFullMode.doFullFlash(dm, newFirmware, cliOptions.delay(), !cliOptions.eraseFullFlash(), cliOptions.logStatistics(),
+                            bootLoaderIdentity);
                 }
                 logger.info("\nRequesting Bootloader statistic...");
                 dm.requestBootLoaderStatistic();
@@ -1,5 +1,6 @@
 package org.selfbus.updater.bootloader;
 
+import org.selfbus.updater.Mcu;
 import org.selfbus.updater.Utils;
 
 /**
@@ -7,14 +8,19 @@ import org.selfbus.updater.Utils;
  *  see software-arm-lib/Bus-Updater/src/update.cpp (method updRequestBootloaderIdentity) for more information.
  */
 public class BootloaderIdentity {
+    public static final long FEATURE_PAGE_CRC = 0x0002; //!< Bootloader supports UPDCommand.REQUEST_PAGE_CRC
+
     private final long versionMajor;
     private final long versionMinor;
     private final long versionSBLibMajor;
     private final long versionSBLibMinor;
     private final long features;
     private final long applicationFirstAddress;
+    private final int ramBufferSize;
 
-    public BootloaderIdentity(long versionMajor, long versionMinor, long versionSBLibMajor, long versionSBLibMinor, long features, long applicationFirstAddress) {
+    public BootloaderIdentity(long versionMajor, long versionMinor, long versionSBLibMajor, long versionSBLibMinor, long features, long applicationFirstAddress,
+                              int ramBufferSize) {
+        this.ramBufferSize = ramBufferSize;
         this.versionSBLibMajor = versionSBLibMajor;
         this.versionSBLibMinor = versionSBLibMinor;
         this.features = features;
@@ -30,12 +36,16 @@ public class BootloaderIdentity {
         long versionSBLibMajor = parse[4] & 0xff;
         long versionSBLibMinor= parse[5] & 0xff;
         long applicationFirstAddress = Utils.streamToLong(parse, 6);
-        return new BootloaderIdentity(vMajor, vMinor, versionSBLibMajor, versionSBLibMinor, features, applicationFirstAddress );
+        int ramBufferSize = Mcu.FLASH_PAGE_SIZE; // older bootloaders don't report their ram buffer size
+        if (parse.length >= 12) {
+            ramBufferSize = Utils.streamToShort(parse, 10) & 0xffff;
+        }
+        return new BootloaderIdentity(vMajor, vMinor, versionSBLibMajor, versionSBLibMinor, features, applicationFirstAddress, ramBufferSize);
     }
 
     public String toString() {
-        return String.format("Version: %s, sbLib Version: %s, Features: 0x%04X, App-start: 0x%04X",
-                              getVersion(), getVersionSBLib(), getFeatures(), getApplicationFirstAddress());
+        return String.format("Version: %s, sbLib Version: %s, Features: 0x%04X, App-start: 0x%04X, RAM buffer: %d",
+                              getVersion(), getVersionSBLib(), getFeatures(), getApplicationFirstAddress(), getRamBufferSize());
     }
 
     public long getFeatures()
@@ -43,6 +53,16 @@ public class BootloaderIdentity {
         return features;
     }
 
+    public boolean supportsPageCrc()
+    {
+        return (features & FEATURE_PAGE_CRC) != 0;
+    }
+
+    public int getRamBufferSize()
+    {
+        return ramBufferSize;
+    }
+
     public long getApplicationFirstAddress()
     {
         return applicationFirstAddress;
@@ -5,22 +5,29 @@ import org.selfbus.updater.Utils;
 public class BootloaderStatistic {
     private final int disconnectCount;
     private final int repeatedT_ACKcount;
+    private final int iapCallsSaved;
 
 
-    public BootloaderStatistic(int disconnectCount, int repeatedT_ACKcount) {
+    public BootloaderStatistic(int disconnectCount, int repeatedT_ACKcount, int iapCallsSaved) {
         this.disconnectCount = disconnectCount;
         this.repeatedT_ACKcount = repeatedT_ACKcount;
+        this.iapCallsSaved = iapCallsSaved;
     }
 
     public static BootloaderStatistic fromArray(byte[] parse) {
         int disConnectCount = Utils.streamToShort(parse, 0);
         int repeatedT_ACKcount = Utils.streamToShort(parse, 2);
-        return new BootloaderStatistic(disConnectCount, repeatedT_ACKcount);
+        int iapCallsSaved = 0;
+        if (parse.length >= 6) {
+            // older bootloaders don't send the IAP calls saved by the differential update
+            iapCallsSaved = Utils.streamToShort(parse, 4) & 0xffff;
+        }
+        return new BootloaderStatistic(disConnectCount, repeatedT_ACKcount, iapCallsSaved);
     }
 
     public String toString() {
-        return String.format("#Disconnect: %d #repeated T_ACK: %d",
-                              getDisconnectCount(), getRepeatedT_ACKcount());
+        return String.format("#Disconnect: %d #repeated T_ACK: %d #IAP calls saved: %d",
+                              getDisconnectCount(), getRepeatedT_ACKcount(), getIapCallsSaved());
     }
 
     public long getDisconnectCount()
@@ -32,4 +39,9 @@ public class BootloaderStatistic {
     {
         return repeatedT_ACKcount;
     }
+
+    public long getIapCallsSaved()
+    {
+        return iapCallsSaved;
+    }
 }
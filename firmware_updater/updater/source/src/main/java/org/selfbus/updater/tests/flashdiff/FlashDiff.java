@@ -55,13 +55,18 @@ public class FlashDiff {
     }
 
     public SearchResult letLongestCommonBytes(byte[] ar1, byte[] ar2, int patternOffset, int oldDataMinimumAddr, int maxLength) {
-        // search as long as possible ar2[beginOffset..n] bytes (pattern) common with ar1[s..t], where n and t are up to length-1 of appropriate arrays and s is unknown
+        return letLongestCommonBytes(ar1, ar2, patternOffset, oldDataMinimumAddr, ar1.length, maxLength);
+    }
+
+    public SearchResult letLongestCommonBytes(byte[] ar1, byte[] ar2, int patternOffset, int oldDataMinimumAddr, int oldDataEndAddr, int maxLength) {
+        // search as long as possible ar2[beginOffset..n] bytes (pattern) common with ar1[s..t], where n is up to length-1 of ar2, t up to oldDataEndAddr-1 and s is unknown
         int logestCandidateSrcOffset = 0;
         int logestCandidateLength = 0;
-        for (int i = oldDataMinimumAddr; i < ar1.length; i++) {
+        oldDataEndAddr = Math.min(oldDataEndAddr, ar1.length);
+        for (int i = oldDataMinimumAddr; i < oldDataEndAddr; i++) {
             int j = 0;
             while ((patternOffset + j < ar2.length)
-                    && (i + j < ar1.length)
+                    && (i + j < oldDataEndAddr)
                     && (ar1[i + j] == ar2[patternOffset + j])
                     && j < maxLength
             ) {
@@ -127,9 +132,11 @@ public class FlashDiff {
 
     public void generateDiff(BinImage img1Orig, BinImage img2, FlashProgrammer flashProgrammer)
             throws InterruptedException, KNXTimeoutException, KNXLinkClosedException, KNXDisconnectException, KNXRemoteException, UpdaterException {
-        // TODO check if old image can be truncated for smaller new image, first test was fine
-    	//BinImage img1 = new BinImage(img1Orig); // make copy to keep img1Orig untouched, this fails if arraycopy at 203, when new image is larger than old
-        BinImage img1 = new BinImage(img1Orig,img2.getBinData().length); // make copy to keep img1Orig untouched, ensure old bin buffer is same size as new bin file
+        // Make a copy to keep img1Orig untouched. It is not truncated to a smaller new image,
+        // the device keeps the old content behind the new image and the stream can reference it.
+        // The buffer grows if the new image is larger than the old one.
+        int oldImageLength = img1Orig.getBinData().length;
+        BinImage img1 = new BinImage(img1Orig, Math.max(oldImageLength, img2.getBinData().length));
        
         List<Byte> outputDiffStream = new ArrayList<>();
         List<Byte> rawBuffer = new ArrayList<>();
@@ -145,7 +152,9 @@ public class FlashDiff {
             //SearchResult rBackwardRamWindow = letLongestCommonBytes(img1.getBinData(), img2.getBinData(), i, 0);  // in case we would have two flash banks, ie. full old image available
             int currentPage = i / FlashPage.PAGE_SIZE;
             int firstAddressInThisPage = currentPage * FlashPage.PAGE_SIZE;
-            SearchResult rForwardOldFlash = letLongestCommonBytes(img1.getBinData(), img2.getBinData(), i, 0, MAX_COPY_LENGTH);
+            // Valid flash content are the pages already written and the old image, the flash behind the old image is unknown
+            int romEndAddr = Math.max(oldImageLength, firstAddressInThisPage);
+            SearchResult rForwardOldFlash = letLongestCommonBytes(img1.getBinData(), img2.getBinData(), i, 0, romEndAddr, MAX_COPY_LENGTH);
             rForwardOldFlash.sourceType = SourceType.FORWARD_ROM;
             // which result is better, from FORWARD ROM or BACKWARD RAM?
             SearchResult bestResult = (rForwardOldFlash.length > rBackwardRamWindow.length) ? rForwardOldFlash : rBackwardRamWindow;
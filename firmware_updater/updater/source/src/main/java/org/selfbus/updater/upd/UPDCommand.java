@@ -19,6 +19,7 @@ public enum UPDCommand {
     ERASE_ADDRESS_RANGE((byte)0xe9, "ERASE_ADDRESS_RANGE"),              //!< Erase flash from given start address to end address (start: data[3-6] end: data[7-10]) @note device must be unlocked
     REQ_DATA((byte)0xe8, "REQ_DATA"),                                   //!< Return bytes from flash at given address?  @note device must be unlocked
                                                                 //!<@warning Not implemented
+    SEND_DATA_LONG_OFFSET((byte)0xe5, "SEND_DATA_LONG_OFFSET"),         //!< Like SEND_DATA, but with a 16bit ramBuffer address in data[0-1] @note device must be unlocked
     DUMP_FLASH((byte)0xe7, "DUMP_FLASH"),                               //!< DUMP the flash of a given address range (data[0-3] - data[4-7]) to serial port of the mcu, works only with DEBUG version of bootloader
     REQUEST_STATISTIC((byte)0xdf, "STATISTIC_REQUEST"),                 //!< Return some statistic data for the active connection
     RESPONSE_STATISTIC((byte)0xde, "STATISTIC_RESPONSE"),               //!< Response for @ref UPD_STATISTIC_RESPONSE containing the statistic data
@@ -34,6 +35,8 @@ public enum UPDCommand {
     REQUEST_BL_IDENTITY((byte)0xb8, "REQUEST_BL_IDENTITY"),             //!< Return the bootloader's identity @note device must be unlocked
     RESPONSE_BL_IDENTITY((byte)0xb7, "RESPONSE_BL_IDENTITY"),           //!< Response for @ref UPD_REQUEST_BL_IDENTITY containing the identity
     RESPONSE_BL_VERSION_MISMATCH((byte)0xb6, "RESPONSE_BL_VERSION_MISMATCH"), //!< Response for @ref UPD_REQUEST_BL_IDENTITY containing the minimum required major and minor version of Selfbus Updater
+    REQUEST_PAGE_CRC((byte)0xb5, "REQUEST_PAGE_CRC"),                   //!< Return the crc32 of a range of flash pages @note device must be unlocked
+    RESPONSE_PAGE_CRC((byte)0xb4, "RESPONSE_PAGE_CRC"),                 //!< Response for @ref REQUEST_PAGE_CRC containing the crc32 of the pages
     SET_EMULATION((byte)0x01, "SET_EMULATION");                        //!<@warning Not implemented
 
     private static final Map<Byte, UPDCommand> BY_INDEX = new HashMap<>();
@@ -12,10 +12,15 @@
 
 #include <stdint.h>
 #include <sblib/types.h>
+#include <sblib/platform.h>
+#include <sblib/eib/table_cache.h>
 
-class AddrTables
+class AddrTables : public TableCache
 {
 public:
+    AddrTables();
+    virtual ~AddrTables() = default;
+
 	/**
 	 * Get the index of a group address in the address table.
 	 *
@@ -26,7 +31,17 @@ public:
 	 * own physical address. This function skips the own physical address and
 	 * only scans the group addresses.
 	 */
-	virtual int indexOfAddr(int addr) = 0;
+	virtual int indexOfAddr(int addr);
+
+	/**
+	 * Get the index of a group address in the group addresses of the last rebuild().
+	 * Used by the bus interrupt. It does not access the flash, so with IAP_KEEP_BUS_INTERRUPTS
+	 * group telegrams are also acknowledged while the flash is erased or programmed.
+	 *
+	 * @param addr - the address to find.
+	 * @return The index of the address, -1 if not found.
+	 */
+	RAM_FUNC int cachedIndexOfAddr(int addr);
 
 	/**
 	 * Get the communication object of a group address.
@@ -66,6 +81,60 @@ public:
     virtual uint16_t addrCount();
 
 	int addrForSendObject(int objno);
+
+	/**
+	 * Get the size of the address table in bytes.
+	 *
+	 * @return The size of the address table including the length field.
+	 */
+	virtual int addrTableSize();
+
+	/**
+	 * Get the size of the association table in bytes.
+	 *
+	 * @return The size of the association table including the length field.
+	 */
+	virtual int assocTableSize();
+
+	/**
+	 * Check if the group addresses are in ascending order. Called from the main loop only,
+	 * the lookups from the bus interrupt only read the result.
+	 */
+	void rebuild() override;
+
+	/**
+	 * Forget the result of the sortedness check, the group addresses are scanned
+	 * linearly until the next rebuild().
+	 */
+	void invalidate() override;
+
+	/**
+	 * Get the group addresses of the address table.
+	 *
+	 * @param num - set to the number of group addresses.
+	 * @return Pointer to the first group address, 2 bytes per address, big endian.
+	 */
+	virtual const byte* groupAddresses(int& num) = 0;
+
+protected:
+	/**
+	 * Find a group address in a list of group addresses.
+	 *
+	 * @brief ETS downloads the group addresses in ascending order. The order of the list is
+	 * checked by rebuild(), afterwards a binary search is used. Unsorted lists, and lists which
+	 * were changed since the last check, are scanned linearly.
+	 *
+	 * @param tab - pointer to the first group address, 2 bytes per address, big endian.
+	 * @param num - the number of group addresses in the list.
+	 * @param addr - the address to find.
+	 * @return The index of the address, starting at 1, -1 if not found.
+	 */
+	RAM_FUNC int indexOfAddr(const byte* tab, int num, int addr);
+
+private:
+	const byte* checkedTab; //!< Address list the sortedness check was done for
+	int checkedNum;         //!< Number of addresses the sortedness check was done for
+	bool sorted;            //!< true if the checked address list is in ascending order
 };
 
 #endif /*sblib_addr_tables_h*/
@@ -20,18 +20,6 @@ public:
 	AddrTablesBCU1(BCU1* bcuInstance) : bcu(bcuInstance) {};
 	~AddrTablesBCU1() = default;
 
-	/**
-	 * Get the index of a group address in the address table.
-	 *
-	 * @param addr - the address to find.
-	 * @return The index of the address, -1 if not found.
-	 *
-	 * @brief The address table contains the configured group addresses and our
-	 * own physical address. This function skips the own physical address and
-	 * only scans the group addresses.
-	 */
-	int indexOfAddr(int addr) override;
-
 	/**
 	 * Get the address table. The address table contains the configured group addresses
 	 * and our own physical address.
@@ -55,6 +43,17 @@ public:
 	 */
 	byte* assocTable() override;
 
+	/**
+	 * Get the group addresses of the address table.
+	 *
+	 * @param num - set to the number of group addresses.
+	 * @return Pointer to the first group address.
+	 *
+	 * @brief The address table contains the configured group addresses and our
+	 * own physical address. This function skips the own physical address.
+	 */
+	const byte* groupAddresses(int& num) override;
+
 private:
 	BCU1* bcu;
 };
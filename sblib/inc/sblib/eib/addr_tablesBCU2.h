@@ -14,24 +14,12 @@
 
 class BCU2;
 
-class AddrTablesBCU2 : public AddrTables ///\todo derive from AddrTablesBCU1, to get rid of indexOfAddr(int addr)
+class AddrTablesBCU2 : public AddrTables ///\todo derive from AddrTablesBCU1, to get rid of groupAddresses(int& num)
 {
 public:
 	AddrTablesBCU2(BCU2* bcuInstance) : bcu(bcuInstance) {};
 	~AddrTablesBCU2() = default;
 
-	/**
-	 * Get the index of a group address in the address table.
-	 *
-	 * @param addr - the address to find.
-	 * @return The index of the address, -1 if not found.
-	 *
-	 * @brief The address table contains the configured group addresses and our
-	 * own physical address. This function skips the own physical address and
-	 * only scans the group addresses.
-	 */
-	int indexOfAddr(int addr) override;
-
 	/**
 	 * Get the address table. The address table contains the configured group addresses
 	 * and our own physical address.
@@ -61,6 +49,17 @@ public:
      */
     uint16_t addrCount() override;
 
+	/**
+	 * Get the group addresses of the address table.
+	 *
+	 * @param num - set to the number of group addresses.
+	 * @return Pointer to the first group address.
+	 *
+	 * @brief The address table contains the configured group addresses and our
+	 * own physical address. This function skips the own physical address.
+	 */
+	const byte* groupAddresses(int& num) override;
+
 private:
 	BCU2* bcu;
 };
@@ -20,17 +20,20 @@ public:
 	AddrTablesSYSTEMB(SYSTEMB* bcuInstance) : AddrTablesMASK0701((MASK0701*)bcuInstance), bcu(bcuInstance) {};
 	~AddrTablesSYSTEMB() = default;
 
+	int addrTableSize() override;
+	int assocTableSize() override;
+
 	/**
-	 * Get the index of a group address in the address table.
+	 * Get the group addresses of the address table.
 	 *
-	 * @param addr - the address to find.
-	 * @return The index of the address, -1 if not found.
+	 * @param num - set to the number of group addresses.
+	 * @return Pointer to the first group address.
 	 *
-	 * @brief The address table contains the configured group addresses and our
-	 * own physical address. This function skips the own physical address and
-	 * only scans the group addresses.
+	 * @brief The address table contains the 2 byte length and the configured
+	 * group addresses, without our own physical address.
 	 */
-	int indexOfAddr(int addr) override;
+	const byte* groupAddresses(int& num) override;
+
 private:
 	SYSTEMB* bcu;
 };
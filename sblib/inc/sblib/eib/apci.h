@@ -133,6 +133,8 @@ enum RestartPDUErrorcode
 
 #define BOOTLOADER_MAGIC_WORD (0x5E1FB055)      //!< magic word which will be checked on startup of the bootloader
                                                 //!< weather or not to go into bootloader mode
+#define BOOTLOADER_MAGIC_WORD_VERIFY (0x5E1FC4EC) //!< magic word which requests a full crc check of the application
+                                                  //!< from the bootloader on the next reset
 #define BOOTLOADER_MAGIC_ADDRESS ((unsigned int *) 0x10000000) //!< magic address for the magic word to be checked on startup of the bootloader
                                                                //!< weather or not to go into bootloader mode
 #define BOOTLOADER_MAGIC_ERASE T_MASTERRESET_FACTORY_WO_IA     //!< bootloader magic erase = FactoryResetWithoutIndividualAddress in calimero-core
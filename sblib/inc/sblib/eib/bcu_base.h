@@ -14,6 +14,7 @@
 #include <sblib/eib/userRam.h>
 #include <sblib/eib/addr_tables.h>
 #include <sblib/eib/com_objects.h>
+#include <sblib/eib/table_cache.h>
 #include <sblib/timer.h>
 #include <sblib/debounce.h>
 #include <sblib/eib/knx_tlayer4.h>
@@ -97,6 +98,25 @@ public:
 
     virtual int maxTelegramSize();
 
+    /**
+     * Register a lookup cache which is rebuilt whenever the tables were changed.
+     * The address tables are registered automatically.
+     *
+     * @param cache - the cache to register, must exist as long as the BCU is used.
+     */
+    void registerTableCache(TableCache* cache);
+
+    /**
+     * Notify the BCU that the address, association or communication object table was changed.
+     * The registered caches are invalidated now and rebuilt from the next loop() call.
+     */
+    void tablesChanged();
+
+    /**
+     * Rebuild all registered caches now, if the tables were changed.
+     */
+    void updateTableCaches();
+
 protected:
     /**
      * Special initialization for the BCU
@@ -138,5 +158,8 @@ protected:
     };
     BcuRestartType requestedRestartType;
 
+    TableCache* tableCaches;  //!< First registered table cache
+    bool tableCachesOutdated; //!< The tables were changed, the caches need a rebuild
+
 };
 #endif /*sblib_BcuBase_h*/
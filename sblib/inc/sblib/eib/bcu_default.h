@@ -15,11 +15,20 @@
 #include <sblib/mem_mapper.h>
 #include <sblib/usr_callback.h>
 #include <sblib/eib/userEeprom.h>
+#include <sblib/eib/memory_region.h>
 #include <sblib/timer.h>
 #include <sblib/eib/bcu_base.h>
 
 class Bus;
 
+/**
+ * Maximum number of memory regions, including the regions of the user EEPROM and user RAM
+ * which are registered by the BCU.
+ */
+#ifndef MAX_MEMORY_REGIONS
+#   define MAX_MEMORY_REGIONS 8
+#endif
+
 /**
  * Class for controlling all BCU related things.
  *
@@ -176,6 +185,15 @@ public:
 
 
 
+    /**
+     * Register a memory region which is accessible by memory read and write telegrams.
+     * The user EEPROM and the user RAM are registered automatically.
+     *
+     * @param region - the region to register, must exist as long as the BCU is used.
+     * @return true if registered, false if @ref MAX_MEMORY_REGIONS regions are already registered
+     */
+    bool registerMemoryRegion(MemoryRegion* region);
+
     /**
      * Set a callback class to notify the user program of some events
      */
@@ -199,6 +217,22 @@ public:
      */
     void setGroupTelRateLimit(unsigned int limit);
 
+    /**
+     * Spread the initial group telegrams after startup (e.g. after bus voltage recovery)
+     * over a time window, to avoid that all devices of a line send at the same moment.
+     *
+     * The window starts when the bus is ready, or when this function is called later.
+     * Only the read and write requests raised until then form the startup burst:
+     * communication objects with priority system or alarm are sent immediately.
+     * Objects with priority high are sent after a device specific offset within the
+     * first half of the window, objects with priority low half a window later.
+     * The offset is derived from the UID of the CPU and the physical address.
+     * Requests raised by the application after the start of the window are not delayed.
+     *
+     * @param windowMillis - length of the startup window in milliseconds, 0 disables it (default).
+     */
+    void setStartupDelay(unsigned int windowMillis);
+
 protected:
     /*
      * Special initialization for the BCU
@@ -242,11 +276,71 @@ protected:
      */
     bool flushUserMemory(UsrCallbackType reason, bool waitIdle);
 
+    /**
+     * Check if a memory range overlaps the address, association or communication object table
+     * or the table pointers.
+     *
+     * @param addressStart - memory start address
+     * @param length - length of the memory range
+     * @return True if the range overlaps a table, otherwise false
+     */
+    bool tablesOverlap(unsigned int addressStart, unsigned int length);
+
+
+    /**
+     * Rebuild the address sorted table of the memory regions, if a region was registered.
+     */
+    void updateMemoryRegions();
+
+    /**
+     * Get the number of bytes from an address on which are mapped by the memory mapper.
+     *
+     * @param address - the start address
+     * @param length - the maximum number of bytes
+     * @return number of mapped bytes, 0 if the address is not mapped
+     */
+    unsigned int memMapperMappedLength(unsigned int address, unsigned int length);
+
+    /**
+     * An entry of the address sorted table of memory regions.
+     */
+    struct MemoryRegionEntry
+    {
+        uint32_t start;       //!< First address of the region
+        uint32_t end;         //!< Last address of the region
+        MemoryRegion* region; //!< The region
+    };
+
+    /**
+     * Find the registered memory region which contains an address.
+     *
+     * @param address - the address to search for
+     * @return the table entry of the region or nullptr if the address is not within a region
+     */
+    const MemoryRegionEntry* findMemoryRegion(uint32_t address);
+
     MemMapper *memMapper;
+    UserEepromRegion userEepromRegion;
+    UserRamRegion userRamRegion;
+    UserRamStatusRegion userRamStatusRegion;
+    MemoryRegion* memoryRegionList;                        //!< First registered memory region
+    MemoryRegionEntry memoryRegions[MAX_MEMORY_REGIONS];  //!< The non empty regions, sorted by start address
+    byte memoryRegionCount;                                //!< Number of entries in memoryRegions
+    byte registeredMemoryRegions;                          //!< Number of registered regions
+    bool memoryRegionsOutdated;                            //!< A region was registered, the table needs a rebuild
     UsrCallback *usrCallback;
     bool sendGrpTelEnabled;        //!< Sending of group telegrams is enabled. Usually set, but can be disabled.
     unsigned int groupTelWaitMillis;
     unsigned int groupTelSent;
+    unsigned int startupWindowMillis; //!< Length of the startup window, 0 = disabled
+    bool startupArmed;                //!< The bus is ready and the startup window is running
+    unsigned int startupTime;         //!< millis() timestamp of the start of the startup window
+    unsigned int startupSeed;         //!< Device specific value to calculate the startup offset
+
+    /**
+     * Update the priority limit of the com-objects according to the startup window.
+     */
+    void handleStartupDelay();
 
 private:
 };
@@ -92,6 +92,14 @@ public:
      */
     bool idle() const;
 
+    /**
+     * Test if the bus is ready, the start-up wait for 50 bit times of inactivity
+     * on the bus (e.g. after bus voltage recovery) is over.
+     *
+     * @return true when ready, false when not.
+     */
+    bool ready() const;
+
     /**
      * Interface to upper layer for sending a telegram
      *
@@ -117,7 +125,7 @@ public:
      * This method is called by the timer interrupt handler.
      * Consider it to be a private method and do not call it.
      */
-    void timerInterruptHandler();
+    RAM_FUNC void timerInterruptHandler();
 
     /**
      * Test if there is a telegram being sent.
@@ -255,19 +263,20 @@ private:
      *          Configure the capture to falling edge and interrupt
      *          match register for low PWM output
      */
-    void idleState();
+    RAM_FUNC void idleState();
 
     /**
      * Initializes all class variables to prepare for the next transmission.
      */
-    void prepareForSending();
+    RAM_FUNC void prepareForSending();
 
     /**
      * Finish the telegram sending process.
      *
      * Notify upper layer of completion and prepare for next telegram transmission.
+     * During an IAP call the notification is deferred to @ref loop().
      */
-    void finishSendingTelegram();
+    RAM_FUNC void finishSendingTelegram();
 
     /**
      * @fn void prepareTelegram(unsigned char*, unsigned short)const
@@ -286,7 +295,7 @@ private:
      *
      * @param valid - 1 if all bytes had correct parity and the checksum is correct, 0 if not
      */
-    void handleTelegram(bool valid);
+    RAM_FUNC void handleTelegram(bool valid);
 
 protected:
     friend class TLayer4;
@@ -311,7 +320,10 @@ private:
     int currentByte;                //!< The current byte that is received/sent, including the parity bit
     int sendTelegramLen;            //!< The size of the to be sent telegram in bytes (including the checksum).
     byte *sendCurTelegram;          //!< The telegram that is currently being sent.
-    byte *rx_telegram = new byte[bcu->maxTelegramSize()](); //!< Telegram buffer for the L1/L2 receiving process
+    int maxTelegramLength = bcu->maxTelegramSize();  //!< Maximum telegram size of the BCU
+    byte *rx_telegram = new byte[maxTelegramLength](); //!< Telegram buffer for the L1/L2 receiving process
+    volatile bool finishedSendingPending = false;     //!< Sending finished during an IAP call, the BCU is notified from loop()
+    bool finishedSendingSuccessful = false;           //!< Result of the deferred sending notification
 
     int bitMask;
     int bitTime;                 //!< The bit-time within a byte when receiving
@@ -336,7 +348,7 @@ private:
  * @param busObj - the bus object that shall receive the interrupt.
  */
 #define BUS_TIMER_INTERRUPT_HANDLER(handler, busObj) \
-    extern "C" void handler() { busObj.timerInterruptHandler(); }
+    extern "C" RAM_FUNC void handler() { busObj.timerInterruptHandler(); }
 
 //define some error states
 #define RX_OK 0
@@ -368,6 +380,11 @@ inline bool Bus::idle() const
     return ((state == IDLE) || (state == INIT)) && (sendCurTelegram == nullptr);
 }
 
+inline bool Bus::ready() const
+{
+    return state != INIT;
+}
+
 inline void Bus::maxSendTries(int tries)
 {
     sendTriesMax = tries;
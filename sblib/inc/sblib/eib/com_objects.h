@@ -36,11 +36,24 @@
 #include <sys/param.h>
 #include <sblib/eib/types.h>
 #include <sblib/eib/datapoint_types.h>
+#include <sblib/eib/dpt_codecs.h>
+#include <sblib/eib/apci.h>
 
 class BcuBase;
 
 #define INVALID_OBJECT_NUMBER -1
 
+/** Maximum number of group addresses with a group read request in flight */
+#define MAX_PENDING_GROUP_READS 8
+
+/** Time in milliseconds after which a group read request without a response is considered finished */
+#define PENDING_GROUP_READ_TIMEOUT_MS 3000
+
+/** Number of communication objects which can be held back during the startup window */
+#ifndef MAX_STARTUP_BURST_OBJECTS
+#   define MAX_STARTUP_BURST_OBJECTS 256
+#endif
+
 class ComObjects
 {
 public:
@@ -70,6 +83,19 @@ public:
 	 */
 	float objectReadFloat(int objno);
 
+	/**
+	 * Get the value of a communication object, decoded with a datapoint type codec.
+	 *
+	 * Example: int temp = objectRead<Dpt9>(objno); // 2101 for 21.01
+	 *
+	 * @param objno - the ID of the communication object.
+	 * @return The decoded value of the com-object.
+	 *
+	 * @see dpt_codecs.h
+	 */
+	template <class DPT>
+	typename DPT::Type objectRead(int objno);
+
 	/**
 	 * Request the read of a communication object. Calling this function triggers the
 	 * sending of a read-group-value telegram, to read the value of the communication
@@ -78,6 +104,12 @@ public:
 	 * When the answer is received, the communication object's value will be updated.
 	 * You can cycle through all updated communication objects with nextUpdatedObject().
 	 *
+	 * Read requests of several objects sharing the same group address are coalesced into
+	 * one read-group-value telegram. While a read request for a group address is waiting
+	 * for its response, no further read request is sent for this address. The requests of
+	 * the other objects stay pending and are completed by the response, without a response
+	 * within @ref PENDING_GROUP_READ_TIMEOUT_MS the read is sent again.
+	 *
 	 * @param objno - the ID of the communication object to mark for reading.
 	 *
 	 * @see objectWritten(int)
@@ -145,6 +177,32 @@ public:
 	 */
 	void objectWriteFloat(int objno, int value);
 
+	/**
+	 * Set the value of a communication object, encoded with a datapoint type codec.
+	 * Calling this function triggers the sending of a write-group-value telegram.
+	 *
+	 * Example: objectWrite<Dpt9>(objno, 2101); // 21.01
+	 *
+	 * @param objno - the ID of the communication object.
+	 * @param value - the new value of the communication object.
+	 *
+	 * @see dpt_codecs.h
+	 */
+	template <class DPT>
+	void objectWrite(int objno, typename DPT::Type value);
+
+	/**
+	 * Set the value of a communication object, encoded with a datapoint type codec, and mark
+	 * the communication object as updated. This does not trigger a write-group-value telegram.
+	 *
+	 * @param objno - the ID of the communication object.
+	 * @param value - the new value of the communication object.
+	 *
+	 * @see dpt_codecs.h
+	 */
+	template <class DPT>
+	void objectUpdate(int objno, typename DPT::Type value);
+
 	/**
 	 * Mark a communication object as written. Use this function if you directly change
 	 * the value of a communication object without using objectWrite(). Calling this
@@ -261,6 +319,13 @@ public:
 	 */
 	virtual byte* objectConfigTable() = 0;
 
+	/**
+	 * Get the size of the communication object configuration table in bytes.
+	 *
+	 * @return The size of the table, 0 if there is no table.
+	 */
+	virtual int objectConfigTableSize() = 0;
+
 	/**
 	 * Get the communication object status flags table. This is the table with the
 	 * status flags that are stored in RAM and get changed during normal operation.
@@ -288,6 +353,24 @@ public:
 	 */
 	bool sendNextGroupTelegram();
 
+	/**
+	 * Limit the sending of the startup burst to communication objects with a transmission
+	 * priority equal or higher than prio. Used by the BCU to spread the initial group
+	 * telegrams after startup. Only the objects marked with markStartupBurst() are held back,
+	 * transmit requests of the application raised later are sent immediately.
+	 *
+	 * @param prio - lowest priority allowed to send (@ref COMCONF_PRIO_SYSTEM ... @ref COMCONF_PRIO_LOW)
+	 *               @ref COMCONF_PRIO_LOW allows all communication objects to send and ends
+	 *               the startup burst (default).
+	 */
+	void setSendPriorityLimit(int prio);
+
+	/**
+	 * Add all communication objects with a pending read or write request to the startup burst,
+	 * see setSendPriorityLimit(). Objects behind @ref MAX_STARTUP_BURST_OBJECTS are never held back.
+	 */
+	void markStartupBurst();
+
 protected:
 	/**
 	 * Get the size of the com-object in bytes, for sending/receiving telegrams.
@@ -358,11 +441,58 @@ protected:
 	void sendGroupWriteTelegram(int objno, int addr, bool isResponse);
 	void processGroupWriteTelegram(int objno, byte* tel);
 
+	/**
+	 * Set the transmission status of a communication object after its read/write request
+	 * was handed to the bus and clear the data request flag.
+	 *
+	 * @param objno - the ID of the communication object
+	 */
+	void setObjectTransmitted(int objno);
+
+	/**
+	 * Check if a group read request for the group address is still waiting for its response.
+	 * Entries older than @ref PENDING_GROUP_READ_TIMEOUT_MS are dropped.
+	 *
+	 * @param addr - the group address
+	 * @return true if a read request for addr is in flight, otherwise false
+	 */
+	bool isGroupReadPending(uint16_t addr);
+
+	/**
+	 * Remember a sent group read request, so further read requests for the same group address
+	 * are not sent again until the response was received.
+	 *
+	 * @param addr - the group address
+	 */
+	void addPendingGroupRead(uint16_t addr);
+
+	/**
+	 * Mark a group read request as answered. Called for every received group value
+	 * write or response telegram. If a read request for addr was in flight, the read
+	 * requests of all objects waiting for it are completed.
+	 *
+	 * @param addr - the group address
+	 */
+	void removePendingGroupRead(uint16_t addr);
+
+	/**
+	 * Complete the read requests of all communication objects with the group address,
+	 * which were held back while the read request of another object was in flight.
+	 * The response to that read request updated their values.
+	 *
+	 * @param addr - the group address of the answered read request
+	 */
+	void completeGroupReads(uint16_t addr);
+
     BcuBase* bcu;
     int le_ptr;
     int transmitting_object_no; //!< Object number of last transmitted bus message - status should be in transmitting
     int sendNextObjIndex;       //!< Next object number which  will be checked in sendNextGroupTelegram() for transmission
     int nextUpdatedObjIndex;    //!< Next object number which  will be checked in nextUpdatedObject() for processing by the application
+    int sendPriorityLimit;      //!< Lowest transmission priority allowed to send, see setSendPriorityLimit()
+    uint16_t pendingReadAddr[MAX_PENDING_GROUP_READS];     //!< Group addresses of read requests waiting for a response, 0 = unused
+    unsigned int pendingReadTime[MAX_PENDING_GROUP_READS]; //!< millis() timestamp of the respective read request
+    byte startupBurst[(MAX_STARTUP_BURST_OBJECTS + 7) / 8]; //!< Bit per object with a request from before the startup, see markStartupBurst()
 
 };
 
@@ -379,6 +509,8 @@ inline void ComObjects::objectEndian(int val)
 inline void ComObjects::processGroupTelegram(int addr, int apci, byte* tel)
 { // call with neg/invalid object
 
+	if (apci != APCI_GROUP_VALUE_READ_PDU)
+	    removePendingGroupRead(addr); // answer to a read request (ours or from another device)
 	processGroupTelegram(addr, apci, tel, INVALID_OBJECT_NUMBER);
 }
 
@@ -437,4 +569,22 @@ inline float ComObjects::objectReadFloat(int objno)
     return dpt9ToFloat(objectRead(objno));
 }
 
+template <class DPT>
+inline typename DPT::Type ComObjects::objectRead(int objno)
+{
+    return DPT::decode(objectRead(objno));
+}
+
+template <class DPT>
+inline void ComObjects::objectWrite(int objno, typename DPT::Type value)
+{
+    _objectWrite(objno, DPT::encode(value), COMFLAG_TRANSREQ);
+}
+
+template <class DPT>
+inline void ComObjects::objectUpdate(int objno, typename DPT::Type value)
+{
+    _objectWrite(objno, DPT::encode(value), COMFLAG_UPDATE);
+}
+
 #endif /*sblib_com_objects_h*/
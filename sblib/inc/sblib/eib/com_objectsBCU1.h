@@ -54,6 +54,7 @@ public:
 	virtual byte* objectValuePtr(int objno) override;
 	virtual void processGroupTelegram(uint16_t addr, int apci, byte* tel, int trg_objno) override;
 	virtual byte* objectConfigTable() override;
+	virtual int objectConfigTableSize() override;
 	virtual byte* objectFlagsTable() override;
 
 	const ComConfigBCU1* objectConfigBCU1(int objno); ///\todo make protected again after ramLocation fix, see setup.cpp fixRamLoc(.) of 4sense-bcu1
@@ -47,6 +47,7 @@ public:
 protected:
 	virtual byte* objectValuePtr(int objno) override;
 	virtual byte* objectConfigTable() override;
+	virtual int objectConfigTableSize() override;
 	virtual byte* objectFlagsTable() override;
 	const ComConfig& objectConfig(int objno) override;
 
@@ -49,6 +49,7 @@ protected:
 	virtual byte* objectValuePtr(int objno) override;
 	virtual void processGroupTelegram(uint16_t addr, int apci, byte* tel, int trg_objno) override;
 	virtual byte* objectConfigTable() override;
+	virtual int objectConfigTableSize() override;
 	virtual byte* objectFlagsTable() override;
 
 };
@@ -0,0 +1,250 @@
+/*
+ *  dpt_codecs.h - Typed encoders/decoders for KNX datapoint types.
+ *
+ *  Every datapoint type is a struct with
+ *    - Type: the C++ type of the value used by the application
+ *    - size: the size of the com-object value in bytes
+ *    - encode(): convert a value to the raw com-object value
+ *    - decode(): convert a raw com-object value to a value
+ *
+ *  The raw value is the unsigned integer as returned by ComObjects::objectRead()
+ *  and expected by ComObjects::objectWrite(). All codecs are integer only.
+ *
+ *  Usage: bcu.comObjects->objectWrite<Dpt9>(objno, 2101); // 21.01
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+#ifndef sblib_dpt_codecs_h
+#define sblib_dpt_codecs_h
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Number of significant bits of a positive value, 0 for 0.
+ */
+inline unsigned int dptBitWidth(uint32_t value)
+{
+    return value ? 32 - __builtin_clz(value) : 0;
+}
+
+/**
+ * DPT1.xxx - 1 bit switch, boolean
+ * @note KNX Spec. 2.1 3/7/2 3.1 p.8
+ */
+struct Dpt1
+{
+    typedef bool Type;
+    static const int size = 1;
+
+    static inline unsigned int encode(bool value) { return value ? 1 : 0; }
+    static inline bool decode(unsigned int raw) { return raw & 1; }
+};
+
+/**
+ * DPT3.xxx - 4 bit relative dimming/blinds control
+ * @details The value is the signed step code -7..7: the sign is the direction
+ *          (positive = increase/down), the absolute value is the step code,
+ *          0 is the break telegram.
+ * @note KNX Spec. 2.1 3/7/2 3.3 p.11
+ */
+struct Dpt3
+{
+    typedef int8_t Type;
+    static const int size = 1;
+
+    static inline unsigned int encode(int8_t value)
+    {
+        if (value < 0)
+            return (-value) & 0x07;
+        return 0x08 | (value & 0x07);
+    }
+
+    static inline int8_t decode(unsigned int raw)
+    {
+        int8_t step = raw & 0x07;
+        return (raw & 0x08) ? step : -step;
+    }
+};
+
+/**
+ * DPT5.xxx - 8 bit unsigned value
+ * @note KNX Spec. 2.1 3/7/2 3.5 p.16
+ */
+struct Dpt5
+{
+    typedef uint8_t Type;
+    static const int size = 1;
+
+    static inline unsigned int encode(uint8_t value) { return value; }
+    static inline uint8_t decode(unsigned int raw) { return raw; }
+};
+
+/**
+ * DPT5.001 - scaling, value in percent 0..100 mapped to 0..255
+ * @note KNX Spec. 2.1 3/7/2 3.5 p.16
+ */
+struct Dpt5_001
+{
+    typedef uint8_t Type;
+    static const int size = 1;
+
+    static inline unsigned int encode(uint8_t percent)
+    {
+        if (percent >= 100)
+            return 255;
+        return (percent * 255 + 50) / 100;
+    }
+
+    static inline uint8_t decode(unsigned int raw) { return ((raw & 0xff) * 100 + 127) / 255; }
+};
+
+/**
+ * DPT6.xxx - 8 bit signed value
+ * @note KNX Spec. 2.1 3/7/2 3.6 p.18
+ */
+struct Dpt6
+{
+    typedef int8_t Type;
+    static const int size = 1;
+
+    static inline unsigned int encode(int8_t value) { return (uint8_t) value; }
+    static inline int8_t decode(unsigned int raw) { return (int8_t) raw; }
+};
+
+/**
+ * DPT7.xxx - 16 bit unsigned value
+ * @note KNX Spec. 2.1 3/7/2 3.7 p.19
+ */
+struct Dpt7
+{
+    typedef uint16_t Type;
+    static const int size = 2;
+
+    static inline unsigned int encode(uint16_t value) { return value; }
+    static inline uint16_t decode(unsigned int raw) { return raw; }
+};
+
+/**
+ * DPT8.xxx - 16 bit signed value
+ * @note KNX Spec. 2.1 3/7/2 3.8 p.21
+ */
+struct Dpt8
+{
+    typedef int16_t Type;
+    static const int size = 2;
+
+    static inline unsigned int encode(int16_t value) { return (uint16_t) value; }
+    static inline int16_t decode(unsigned int raw) { return (int16_t) raw; }
+};
+
+/**
+ * DPT9.xxx - 2 byte float, the value is in 1/100
+ * @details Same as floatToDpt9() / dpt9ToFloat(): a value of 2101 is 21.01. The exponent is
+ *          calculated from the bit width of the value instead of a shift loop.
+ *          0x7fff (@ref INVALID_DPT_FLOAT) is the "invalid data" value.
+ * @note KNX Spec. 2.1 3/7/2 3.10 p.32
+ */
+struct Dpt9
+{
+    typedef int Type;
+    static const int size = 2;
+    static const unsigned int invalid = 0x7fff;
+
+    static inline unsigned int encode(int value)
+    {
+        if (value < -67108864 || value > 67076096)
+            return invalid;
+
+        // for negative values ~value has the same bit width as the mantissa of value
+        uint32_t magnitude = (value < 0) ? ~value : value;
+        int exp = dptBitWidth(magnitude) - 11;
+        if (exp < 0)
+            exp = 0;
+
+        // arithmetic shift, rounds towards -infinity like the shift loop of floatToDpt9()
+        int mantissa = value >> exp;
+        return ((value < 0) ? 0x8000 : 0) | (mantissa & 2047) | (exp << 11);
+    }
+
+    static inline int decode(unsigned int raw)
+    {
+        raw &= 0xffff;
+        if (raw == invalid)
+            return invalid;
+
+        int mantissa = raw & 2047;
+        if (raw & 0x8000)
+            mantissa -= 2048;
+        return (int) ((uint32_t) mantissa << ((raw >> 11) & 15));
+    }
+};
+
+/**
+ * DPT12.xxx - 32 bit unsigned value
+ * @note KNX Spec. 2.1 3/7/2 3.14 p.38
+ */
+struct Dpt12
+{
+    typedef uint32_t Type;
+    static const int size = 4;
+
+    static inline unsigned int encode(uint32_t value) { return value; }
+    static inline uint32_t decode(unsigned int raw) { return raw; }
+};
+
+/**
+ * DPT13.xxx - 32 bit signed value
+ * @note KNX Spec. 2.1 3/7/2 3.15 p.39
+ */
+struct Dpt13
+{
+    typedef int32_t Type;
+    static const int size = 4;
+
+    static inline unsigned int encode(int32_t value) { return (uint32_t) value; }
+    static inline int32_t decode(unsigned int raw) { return (int32_t) raw; }
+};
+
+/**
+ * DPT14.xxx - 4 byte IEEE 754 float
+ * @details Only the bit pattern is copied, no floating point arithmetic is used.
+ * @note KNX Spec. 2.1 3/7/2 3.16 p.40
+ */
+struct Dpt14
+{
+    typedef float Type;
+    static const int size = 4;
+
+    static inline unsigned int encode(float value)
+    {
+        uint32_t raw;
+        memcpy(&raw, &value, sizeof(raw));
+        return raw;
+    }
+
+    static inline float decode(unsigned int raw)
+    {
+        uint32_t bits = raw;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+/**
+ * DPT232.600 - 3 byte RGB color, the value is 0x00RRGGBB
+ * @note KNX Spec. 2.1 3/7/2 3.57 p.104
+ */
+struct Dpt232
+{
+    typedef uint32_t Type;
+    static const int size = 3;
+
+    static inline unsigned int encode(uint32_t rgb) { return rgb & 0xffffff; }
+    static inline uint32_t decode(unsigned int raw) { return raw & 0xffffff; }
+};
+
+#endif /*sblib_dpt_codecs_h*/
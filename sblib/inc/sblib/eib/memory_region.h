@@ -0,0 +1,121 @@
+/*
+ *  memory_region.h - Address ranges which are accessible by memory read and write telegrams.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+#ifndef sblib_memory_region_h
+#define sblib_memory_region_h
+
+#include <stdint.h>
+#include <sblib/types.h>
+
+class UserEeprom;
+class UserRam;
+
+/**
+ * A range of the address space which is accessed by ETS with memory read and write
+ * telegrams, e.g. the user EEPROM, the user RAM or an external EEPROM of the application.
+ *
+ * Register the region with BcuDefault::registerMemoryRegion(). The BCU keeps the
+ * registered regions sorted by their start address and splits memory requests at
+ * the region boundaries, every part is handled by one call of read() or write().
+ * Where regions overlap, the region with the higher start address takes precedence.
+ * The address range of the regions is evaluated after a registration and when the
+ * BCU is started with begin().
+ */
+class MemoryRegion
+{
+public:
+    MemoryRegion() : nextMemoryRegion(nullptr) {}
+    virtual ~MemoryRegion() = default;
+
+    /**
+     * Get the first address of the region.
+     */
+    virtual uint32_t startAddr() const = 0;
+
+    /**
+     * Get the last address of the region. The region is empty if this is lower than @ref startAddr().
+     */
+    virtual uint32_t endAddr() const = 0;
+
+    /**
+     * Read from the region.
+     *
+     * @param address - the first address to read, within the region
+     * @param data - buffer for the read bytes
+     * @param length - number of bytes to read, the range ends within the region
+     * @return true if successfully read, otherwise false
+     */
+    virtual bool read(uint32_t address, byte* data, uint32_t length) = 0;
+
+    /**
+     * Write to the region.
+     *
+     * @param address - the first address to write, within the region
+     * @param data - the bytes to write
+     * @param length - number of bytes to write, the range ends within the region
+     * @return true if successfully written, otherwise false
+     */
+    virtual bool write(uint32_t address, byte* data, uint32_t length) = 0;
+
+private:
+    friend class BcuDefault;
+    MemoryRegion* nextMemoryRegion; //!< Next registered region, the regions form a single linked list
+};
+
+/**
+ * The user EEPROM as memory region.
+ */
+class UserEepromRegion : public MemoryRegion
+{
+public:
+    UserEepromRegion(UserEeprom* userEeprom) : userEeprom(userEeprom) {}
+
+    uint32_t startAddr() const override;
+    uint32_t endAddr() const override;
+    bool read(uint32_t address, byte* data, uint32_t length) override;
+    bool write(uint32_t address, byte* data, uint32_t length) override;
+
+private:
+    UserEeprom* userEeprom;
+};
+
+/**
+ * The user RAM as memory region.
+ */
+class UserRamRegion : public MemoryRegion
+{
+public:
+    UserRamRegion(UserRam* userRam) : userRam(userRam) {}
+
+    uint32_t startAddr() const override;
+    uint32_t endAddr() const override;
+    bool read(uint32_t address, byte* data, uint32_t length) override;
+    bool write(uint32_t address, byte* data, uint32_t length) override;
+
+private:
+    UserRam* userRam;
+};
+
+/**
+ * The status byte of the user RAM, if it is located outside of the user RAM.
+ * The region is empty if the status byte is part of the user RAM.
+ */
+class UserRamStatusRegion : public MemoryRegion
+{
+public:
+    UserRamStatusRegion(UserRam* userRam) : userRam(userRam) {}
+
+    uint32_t startAddr() const override;
+    uint32_t endAddr() const override;
+    bool read(uint32_t address, byte* data, uint32_t length) override;
+    bool write(uint32_t address, byte* data, uint32_t length) override;
+
+private:
+    UserRam* userRam;
+};
+
+#endif /*sblib_memory_region_h*/
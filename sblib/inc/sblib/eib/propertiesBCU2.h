@@ -235,6 +235,18 @@ public:
 	 */
 	virtual const PropertyDef* findProperty(PropertyID id, const PropertyDef* table);
 
+	/**
+	 * Find a property definition in a properties table with a binary search.
+	 *
+	 * @param id - the ID of the property to find.
+	 * @param table - the properties table.
+	 * @param index - the indices of the property definitions of the table, sorted by ascending property ID.
+	 * @param count - the number of property definitions in the table.
+	 *
+	 * @return Pointer to the property definition, 0 if not found.
+	 */
+	const PropertyDef* findProperty(PropertyID id, const PropertyDef* table, const byte* index, int count);
+
 	virtual const PropertyDef* propertyDef(int objectIdx, PropertyID propertyId);
 
 	virtual LoadState handleLoadStateMachine(const int objectIdx, const byte* data, const int len);
@@ -301,8 +313,44 @@ public:
 	#endif /*DUMP_PROPERTIES*/
 
 protected:
+	/**
+	 * Get the property tables of the interface objects.
+	 */
 	virtual const PropertyDef* const* propertiesTab() const;
 
+	/**
+	 * Get the number of property definitions of each table of propertiesTab().
+	 */
+	virtual const byte* propertiesTabLength() const;
+
+	/**
+	 * Get the indices of the property definitions of each table of propertiesTab(),
+	 * sorted by ascending property ID.
+	 */
+	virtual const byte* const* propertiesTabIndex() const;
+
+	/**
+	 * Get the maximum number of value bytes of a property value response or write.
+	 * The elements of a property value are copied as one contiguous run, so this
+	 * limits the number of elements which can be accessed with one telegram.
+	 */
+	int maxPropertyValueLength() const;
+
+	/**
+	 * Get the elements of a property value.
+	 *
+	 * @param objectIdx - the interface object index.
+	 * @param def - the property definition.
+	 * @param numElems - set to the number of elements of the property value.
+	 *
+	 * @return Pointer to the first element.
+	 *
+	 * @brief Array pointer properties hold their number of elements in the first byte,
+	 * PID_TABLE of the address table object are the group addresses of the address table.
+	 * All other properties have one element.
+	 */
+	byte* valueElements(int objectIdx, const PropertyDef* def, int& numElems);
+
 private:
 	BCU2* bcu;
 
@@ -310,7 +358,7 @@ private:
 	 * The properties of the device object
 	 * See KNX Spec 06 Profiles/Annex A p.103 and 9/4/1 p.50
 	 */
-	const PropertyDef deviceObjectProps[12] =
+	static constexpr PropertyDef deviceObjectProps[12] =
 	{
 	    /** Interface object type: 2 bytes */
 	    { PID_OBJECT_TYPE, PDT_UNSIGNED_INT, OT_DEVICE },
@@ -355,7 +403,7 @@ private:
 	 * The properties of the address table object
 	 * See KNX Spec 06 Profiles/Annex A p.103 and 9/4/1 p.51
 	 */
-	const PropertyDef addrTabObjectProps[5] =
+	static constexpr PropertyDef addrTabObjectProps[6] =
 	{
 	    /** Interface object type: 2 bytes */
 	    { PID_OBJECT_TYPE, PDT_UNSIGNED_INT, OT_ADDR_TABLE },
@@ -366,6 +414,9 @@ private:
 	    /** Pointer to the address table */
 	    { PID_TABLE_REFERENCE, PDT_UNSIGNED_INT|PC_ARRAY_POINTER, PD_USER_EEPROM_OFFSET(addrTabAddrOffset) },
 
+	    /** The group addresses of the address table, 2 bytes per element. See PropertiesBCU2::valueElements() */
+	    { PID_TABLE, PDT_GENERIC_02|PC_ARRAY, 0 },
+
 	    /** Pointer to the memory control block */
 	    { PID_MCB_TABLE, PDT_GENERIC_08|PC_POINTER|PC_WRITABLE, PD_USER_EEPROM_OFFSET(addrTabMcbOffset) },
 
@@ -377,7 +428,7 @@ private:
 	 * The properties of the association table object,
 	 * See KNX Spec 06 Profiles/Annex A p.103 and 9/4/1 p.51
 	 */
-	const PropertyDef assocTabObjectProps[6] =
+	static constexpr PropertyDef assocTabObjectProps[6] =
 	{
 	    /** Interface object type: 2 bytes */
 	    { PID_OBJECT_TYPE, PDT_UNSIGNED_INT, OT_ASSOC_TABLE },
@@ -402,7 +453,7 @@ private:
 	 * The properties of the application program object,
 	 * See KNX Spec 9/4/1 p.52
 	 */
-	const PropertyDef appObjectProps[8] =
+	static constexpr PropertyDef appObjectProps[8] =
 	{
 	    /** Interface object type: 2 bytes */
 	    { PID_OBJECT_TYPE, PDT_UNSIGNED_INT, OT_APPLICATION },
@@ -429,7 +480,7 @@ private:
 	    PROPERTY_DEF_TABLE_END
 	};
 
-	const PropertyDef interfaceObjectProps[6] =
+	static constexpr PropertyDef interfaceObjectProps[6] =
 	{
 	    /** Interface object type: 2 bytes */
 	    { PID_OBJECT_TYPE, PDT_UNSIGNED_INT, OT_INTERFACE_PROGRAM },
@@ -453,7 +504,7 @@ private:
 	/**
 	 * The properties of the KNX object association table object, could not find the specification in KNX Spec 2.1
 	 */
-	const PropertyDef knxAssocTabObjectProps[6] =
+	static constexpr PropertyDef knxAssocTabObjectProps[6] =
 	{
 	    // XXX check correct properties for object OT_KNX_OBJECT_ASSOCIATATION_TABLE
 	    /** Interface object type: 2 bytes */
@@ -483,7 +534,7 @@ private:
 	 * BIM112   (MASK_VERSIONs 0x0701, 0x0705)
 	 * SYSTEM_B (MASK_VERSIONs 0x07B0)
 	 */
-	const PropertyDef* const propertiesTabInstance[NUM_PROP_OBJECTS] =
+	static constexpr const PropertyDef* propertiesTabInstance[NUM_PROP_OBJECTS] =
 	{
 	    deviceObjectProps,     //!> Interface Object 0, mandatory
 	    addrTabObjectProps,    //!> Interface Object 1, mandatory
@@ -493,6 +544,40 @@ private:
 		knxAssocTabObjectProps //!> Interface Object 5, some newer MASK_VERSIONs (>= 0x0701) use this to set the address of the communication object table
 	};
 
+	/**
+	 * The indices of the property definitions of each interface object, sorted by ascending property ID.
+	 * The tables keep their order, which is the property index of PropertyDescriptionRead.
+	 */
+	static constexpr byte deviceObjectPropsById[11] = { 0, 2, 3, 4, 5, 6, 1, 7, 8, 9, 10 };
+	static constexpr byte addrTabObjectPropsById[5] = { 0, 1, 2, 3, 4 };
+	static constexpr byte assocTabObjectPropsById[5] = { 0, 1, 2, 3, 4 };
+	static constexpr byte appObjectPropsById[7] = { 0, 1, 2, 4, 3, 5, 6 };
+	static constexpr byte interfaceObjectPropsById[5] = { 0, 1, 2, 3, 4 };
+	static constexpr byte knxAssocTabObjectPropsById[5] = { 0, 1, 2, 3, 4 };
+
+	static constexpr const byte* propertiesTabIndexInstance[NUM_PROP_OBJECTS] =
+	{
+	    deviceObjectPropsById,
+	    addrTabObjectPropsById,
+	    assocTabObjectPropsById,
+	    appObjectPropsById,
+	    interfaceObjectPropsById,
+	    knxAssocTabObjectPropsById
+	};
+
+	/**
+	 * The number of properties of the interface objects, without PROPERTY_DEF_TABLE_END
+	 */
+	static constexpr byte propertiesTabLengthInstance[NUM_PROP_OBJECTS] =
+	{
+	    PROPERTY_DEF_TABLE_LENGTH(deviceObjectProps),
+	    PROPERTY_DEF_TABLE_LENGTH(addrTabObjectProps),
+	    PROPERTY_DEF_TABLE_LENGTH(assocTabObjectProps),
+	    PROPERTY_DEF_TABLE_LENGTH(appObjectProps),
+	    PROPERTY_DEF_TABLE_LENGTH(interfaceObjectProps),
+	    PROPERTY_DEF_TABLE_LENGTH(knxAssocTabObjectProps)
+	};
+
 #ifdef DUMP_PROPERTIES
 	const char *objectType_str[20] =
 	{
@@ -547,7 +632,23 @@ private:
 
 inline const PropertyDef* const* PropertiesBCU2::propertiesTab() const
 {
+	static_assert(PROPERTY_DEF_INDEX_SORTED(deviceObjectProps, deviceObjectPropsById), "deviceObjectPropsById must list deviceObjectProps sorted by property ID");
+	static_assert(PROPERTY_DEF_INDEX_SORTED(addrTabObjectProps, addrTabObjectPropsById), "addrTabObjectPropsById must list addrTabObjectProps sorted by property ID");
+	static_assert(PROPERTY_DEF_INDEX_SORTED(assocTabObjectProps, assocTabObjectPropsById), "assocTabObjectPropsById must list assocTabObjectProps sorted by property ID");
+	static_assert(PROPERTY_DEF_INDEX_SORTED(appObjectProps, appObjectPropsById), "appObjectPropsById must list appObjectProps sorted by property ID");
+	static_assert(PROPERTY_DEF_INDEX_SORTED(interfaceObjectProps, interfaceObjectPropsById), "interfaceObjectPropsById must list interfaceObjectProps sorted by property ID");
+	static_assert(PROPERTY_DEF_INDEX_SORTED(knxAssocTabObjectProps, knxAssocTabObjectPropsById), "knxAssocTabObjectPropsById must list knxAssocTabObjectProps sorted by property ID");
 	return propertiesTabInstance;
 }
 
+inline const byte* PropertiesBCU2::propertiesTabLength() const
+{
+	return propertiesTabLengthInstance;
+}
+
+inline const byte* const* PropertiesBCU2::propertiesTabIndex() const
+{
+	return propertiesTabIndexInstance;
+}
+
 #endif /*sblib_properties_bcu2_h*/
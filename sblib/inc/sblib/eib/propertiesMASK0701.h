@@ -35,6 +35,8 @@ public:
 
 protected:
 	virtual const PropertyDef* const* propertiesTab() const;
+	virtual const byte* propertiesTabLength() const;
+	virtual const byte* const* propertiesTabIndex() const;
 
 private:
 	MASK0701* bcu;
@@ -43,7 +45,7 @@ private:
 	 * The properties of the device object
 	 * See KNX Spec 06 Profiles/Annex A p.103 and 9/4/1 p.50
 	 */
-	const PropertyDef deviceObjectProps[12] =
+	static constexpr PropertyDef deviceObjectProps[12] =
 	{
 	    /** Interface object type: 2 bytes */
 	    { PID_OBJECT_TYPE, PDT_UNSIGNED_INT, OT_DEVICE },
@@ -68,6 +70,7 @@ private:
 	     */
 	    { PID_MANUFACTURER_ID, PDT_GENERIC_02|PC_POINTER, PD_USER_EEPROM_OFFSET(manufacturerHOffset) },
 
+
 	    /** Order number: 10 byte data, stored in userEeprom.order, last two bytes represent sblib version in hex */
 	    { PID_ORDER_INFO, PDT_GENERIC_10|PC_POINTER, PD_USER_EEPROM_OFFSET(orderInfoOffset) },
 
@@ -88,7 +91,7 @@ private:
 	 * The properties of the address table object
 	 * See KNX Spec 06 Profiles/Annex A p.103 and 9/4/1 p.51
 	 */
-	const PropertyDef addrTabObjectProps[5] =
+	static constexpr PropertyDef addrTabObjectProps[6] =
 	{
 	    /** Interface object type: 2 bytes */
 	    { PID_OBJECT_TYPE, PDT_UNSIGNED_INT, OT_ADDR_TABLE },
@@ -99,6 +102,9 @@ private:
 	    /** Pointer to the address table */
 	    { PID_TABLE_REFERENCE, PDT_UNSIGNED_INT|PC_ARRAY_POINTER, PD_USER_EEPROM_OFFSET(addrTabAddrOffset) },
 
+	    /** The group addresses of the address table, 2 bytes per element. See PropertiesBCU2::valueElements() */
+	    { PID_TABLE, PDT_GENERIC_02|PC_ARRAY, 0 },
+
 	    /** Pointer to the memory control block */
 	    { PID_MCB_TABLE, PDT_GENERIC_08|PC_POINTER|PC_WRITABLE, PD_USER_EEPROM_OFFSET(addrTabMcbOffset) },
 
@@ -110,7 +116,7 @@ private:
 	 * The properties of the association table object,
 	 * See KNX Spec 06 Profiles/Annex A p.103 and 9/4/1 p.51
 	 */
-	const PropertyDef assocTabObjectProps[6] =
+	static constexpr PropertyDef assocTabObjectProps[6] =
 	{
 	    /** Interface object type: 2 bytes */
 	    { PID_OBJECT_TYPE, PDT_UNSIGNED_INT, OT_ASSOC_TABLE },
@@ -135,7 +141,7 @@ private:
 	 * The properties of the application program object,
 	 * See KNX Spec 9/4/1 p.52
 	 */
-	const PropertyDef appObjectProps[8] =
+	static constexpr PropertyDef appObjectProps[8] =
 	{
 	    /** Interface object type: 2 bytes */
 	    { PID_OBJECT_TYPE, PDT_UNSIGNED_INT, OT_APPLICATION },
@@ -152,6 +158,7 @@ private:
 	    /** Pointer to the communication objects table */
 	    { PID_TABLE_REFERENCE, PDT_UNSIGNED_INT|PC_ARRAY_POINTER, PD_USER_EEPROM_OFFSET(commsTabAddrOffset) },
 
+
 	    /** Pointer to the memory control block */
 	    { PID_MCB_TABLE, PDT_GENERIC_08|PC_POINTER|PC_WRITABLE, PD_USER_EEPROM_OFFSET(commsTabMcbOffset) },
 
@@ -162,7 +169,7 @@ private:
 	    PROPERTY_DEF_TABLE_END
 	};
 
-	const PropertyDef interfaceObjectProps[6] =
+	static constexpr PropertyDef interfaceObjectProps[6] =
 	{
 	    /** Interface object type: 2 bytes */
 	    { PID_OBJECT_TYPE, PDT_UNSIGNED_INT, OT_INTERFACE_PROGRAM },
@@ -186,7 +193,7 @@ private:
 	/**
 	 * The properties of the KNX object association table object, could not find the specification in KNX Spec 2.1
 	 */
-	const PropertyDef knxAssocTabObjectProps[6] =
+	static constexpr PropertyDef knxAssocTabObjectProps[6] =
 	{
 	    // XXX check correct properties for object OT_KNX_OBJECT_ASSOCIATATION_TABLE
 	    /** Interface object type: 2 bytes */
@@ -216,7 +223,7 @@ private:
 	 * BIM112   (MASK_VERSIONs 0x0701, 0x0705)
 	 * SYSTEM_B (MASK_VERSIONs 0x07B0)
 	 */
-	const PropertyDef* const propertiesTabInstance[NUM_PROP_OBJECTS] =
+	static constexpr const PropertyDef* propertiesTabInstance[NUM_PROP_OBJECTS] =
 	{
 	    deviceObjectProps,     //!> Interface Object 0, mandatory
 	    addrTabObjectProps,    //!> Interface Object 1, mandatory
@@ -225,12 +232,62 @@ private:
 		interfaceObjectProps,  //!> Interface Object 4, required for SYSTEM_B
 		knxAssocTabObjectProps //!> Interface Object 5, some newer MASK_VERSIONs (>= 0x0701) use this to set the address of the communication object table
 	};
+
+	/**
+	 * The indices of the property definitions of each interface object, sorted by ascending property ID.
+	 * The tables keep their order, which is the property index of PropertyDescriptionRead.
+	 */
+	static constexpr byte deviceObjectPropsById[11] = { 0, 2, 3, 4, 5, 6, 1, 7, 8, 9, 10 };
+	static constexpr byte addrTabObjectPropsById[5] = { 0, 1, 2, 3, 4 };
+	static constexpr byte assocTabObjectPropsById[5] = { 0, 1, 2, 3, 4 };
+	static constexpr byte appObjectPropsById[7] = { 0, 1, 2, 4, 3, 5, 6 };
+	static constexpr byte interfaceObjectPropsById[5] = { 0, 1, 2, 3, 4 };
+	static constexpr byte knxAssocTabObjectPropsById[5] = { 0, 1, 2, 3, 4 };
+
+	static constexpr const byte* propertiesTabIndexInstance[NUM_PROP_OBJECTS] =
+	{
+	    deviceObjectPropsById,
+	    addrTabObjectPropsById,
+	    assocTabObjectPropsById,
+	    appObjectPropsById,
+	    interfaceObjectPropsById,
+	    knxAssocTabObjectPropsById
+	};
+
+	/**
+	 * The number of properties of the interface objects, without PROPERTY_DEF_TABLE_END
+	 */
+	static constexpr byte propertiesTabLengthInstance[NUM_PROP_OBJECTS] =
+	{
+	    PROPERTY_DEF_TABLE_LENGTH(deviceObjectProps),
+	    PROPERTY_DEF_TABLE_LENGTH(addrTabObjectProps),
+	    PROPERTY_DEF_TABLE_LENGTH(assocTabObjectProps),
+	    PROPERTY_DEF_TABLE_LENGTH(appObjectProps),
+	    PROPERTY_DEF_TABLE_LENGTH(interfaceObjectProps),
+	    PROPERTY_DEF_TABLE_LENGTH(knxAssocTabObjectProps)
+	};
 };
 
 
 inline const PropertyDef* const* PropertiesMASK0701::propertiesTab() const
 {
+	static_assert(PROPERTY_DEF_INDEX_SORTED(deviceObjectProps, deviceObjectPropsById), "deviceObjectPropsById must list deviceObjectProps sorted by property ID");
+	static_assert(PROPERTY_DEF_INDEX_SORTED(addrTabObjectProps, addrTabObjectPropsById), "addrTabObjectPropsById must list addrTabObjectProps sorted by property ID");
+	static_assert(PROPERTY_DEF_INDEX_SORTED(assocTabObjectProps, assocTabObjectPropsById), "assocTabObjectPropsById must list assocTabObjectProps sorted by property ID");
+	static_assert(PROPERTY_DEF_INDEX_SORTED(appObjectProps, appObjectPropsById), "appObjectPropsById must list appObjectProps sorted by property ID");
+	static_assert(PROPERTY_DEF_INDEX_SORTED(interfaceObjectProps, interfaceObjectPropsById), "interfaceObjectPropsById must list interfaceObjectProps sorted by property ID");
+	static_assert(PROPERTY_DEF_INDEX_SORTED(knxAssocTabObjectProps, knxAssocTabObjectPropsById), "knxAssocTabObjectPropsById must list knxAssocTabObjectProps sorted by property ID");
 	return propertiesTabInstance;
 }
 
+inline const byte* PropertiesMASK0701::propertiesTabLength() const
+{
+	return propertiesTabLengthInstance;
+}
+
+inline const byte* const* PropertiesMASK0701::propertiesTabIndex() const
+{
+	return propertiesTabIndexInstance;
+}
+
 #endif /*sblib_properties_mask0701_h*/
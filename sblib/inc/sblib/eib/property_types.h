@@ -495,6 +495,27 @@ enum PropertyPointerType
 /** Mark the end of a property definition table */
 #define PROPERTY_DEF_TABLE_END  { 0, 0, 0 }
 
+/** Number of property definitions in a property definition table, without PROPERTY_DEF_TABLE_END */
+#define PROPERTY_DEF_TABLE_LENGTH(table)  (sizeof(table) / sizeof(PropertyDef) - 1)
+
+/**
+ * Test if an index of a property definition table lists the definitions sorted by ascending property ID.
+ * Can be used in a static_assert.
+ *
+ * @param table - the properties table.
+ * @param index - the indices of the property definitions in the table.
+ * @param count - the number of indices.
+ * @return True if the index is sorted, false if not.
+ */
+constexpr bool propertyDefIndexSorted(const PropertyDef* table, const byte* index, unsigned int count)
+{
+    return (count < 2) ||
+           ((table[index[0]].id < table[index[1]].id) && propertyDefIndexSorted(table, index + 1, count - 1));
+}
+
+/** Test if an index array covers all definitions of a property definition table, sorted by ascending property ID */
+#define PROPERTY_DEF_INDEX_SORTED(table, index) \
+    (sizeof(index) == PROPERTY_DEF_TABLE_LENGTH(table) && propertyDefIndexSorted(table, index, sizeof(index)))
 
 //
 //  Inline functions
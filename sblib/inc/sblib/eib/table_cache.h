@@ -0,0 +1,43 @@
+/*
+ *  table_cache.h - Base class for lookup caches derived from the BCU tables.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+#ifndef sblib_table_cache_h
+#define sblib_table_cache_h
+
+/**
+ * A lookup structure which is derived from the address, association or
+ * communication object table.
+ *
+ * Register the cache with BcuBase::registerTableCache(). Whenever ETS changes
+ * the tables (memory write into the tables or load state "Loaded"), all registered
+ * caches are invalidated at once and rebuilt in one pass from the next
+ * BcuBase::loop() call, before the next telegram is processed.
+ */
+class TableCache
+{
+public:
+    TableCache() : nextTableCache(nullptr) {}
+    virtual ~TableCache() = default;
+
+    /**
+     * Rebuild the cache from the current content of the tables.
+     */
+    virtual void rebuild() = 0;
+
+    /**
+     * Called right when the tables are changed, before the next rebuild().
+     * A cache which is also used from the bus interrupt must stop using its
+     * outdated content here.
+     */
+    virtual void invalidate() {}
+
+private:
+    friend class BcuBase;
+    TableCache* nextTableCache; //!< Next registered cache, the caches form a single linked list
+};
+
+#endif /*sblib_table_cache_h*/
@@ -16,6 +16,27 @@
 /** number of interface objects supported */
 #define INTERFACE_OBJECT_COUNT 8
 
+/** Marker of a flash sector in the log-structured layout of the user EEPROM ("ULOG") */
+#define USER_EEPROM_LOG_MAGIC 0x474f4c55
+
+/** Size of the sector header in front of the base image in the log-structured layout */
+#define USER_EEPROM_LOG_HEADER_SIZE 8
+
+/** Size of the header of a log record: offset, length and CRC with 2 bytes each */
+#define USER_EEPROM_LOG_RECORD_HEADER_SIZE 6
+
+/** Marker of the page table in the default layout of the user EEPROM ("UTAB") */
+#define USER_EEPROM_TABLE_MAGIC 0x42415455
+
+/** Size of the header of the page table, same as the sector header of the log-structured layout */
+#define USER_EEPROM_TABLE_HEADER_SIZE 8
+
+/**
+ * Size of an entry of the page table: slot, page of the user EEPROM, number of the following
+ * entries of the same flush, unused byte, CRC of the slot data and CRC of the entry (2 bytes each)
+ */
+#define USER_EEPROM_TABLE_ENTRY_SIZE 8
+
 /**
  * The user EEPROM
  * @details Can be accessed by name, like userEeprom.manuDataH() and as an array, like
@@ -81,6 +102,33 @@ public:
      */
     void modified(bool newModified);
 
+    /**
+     * Mark a part of the user EEPROM as modified.
+     *
+     * @details The user EEPROM keeps a bitmap of the modified pages of @ref FLASH_PAGE_SIZE bytes.
+     *          A flush only compares and writes the modified pages, in both layouts.
+     *          @ref modified(true) marks all pages as modified.
+     *
+     * @param address - the address of the first modified byte, like for @ref operator[]
+     * @param length - the number of modified bytes
+     */
+    void modified(uint32_t address, unsigned int length);
+
+    /**
+     * Mark a part of the user EEPROM as modified.
+     *
+     * @param data - pointer to the first modified byte in @ref userEepromData
+     * @param length - the number of modified bytes
+     */
+    void modified(const byte* data, unsigned int length);
+
+    /**
+     * Test if a page of the user EEPROM is marked as modified.
+     *
+     * @param page - the number of the page, the page contains the bytes from page * @ref FLASH_PAGE_SIZE on
+     */
+    bool isPageModified(unsigned int page) const;
+
     /**
      * Test if the user EEPROM is modified.
      */
@@ -95,25 +143,221 @@ public:
     byte* flashSectorAddress() const;
 
     /**
-     * If user-eeprom is modified, changes are written to the mcu's flash
-     * @warn While the eeprom is written, all interrupts are disabled.
+     * Select the log-structured flash layout.
+     *
+     * @details In the log-structured layout the flash sector holds a base image of the user EEPROM
+     *          followed by a log of small delta records (offset, length, data, CRC). A flush only appends
+     *          records for the changed bytes. The sector is erased and the base image rewritten only
+     *          when the log is full. The default layout writes the pages of the user EEPROM into the next
+     *          free slots of the sector on every flush, see @ref readTable().
+     *          The layout of the flash content is detected when reading, so the layout can be changed
+     *          at any time. The next flush writes the selected layout.
+     *
+     * @param enable - true to use the log-structured layout, false to use the default layout
+     */
+    void setLogStructured(bool enable);
+
+    /**
+     * Test if the log-structured flash layout is selected.
+     */
+    bool isLogStructured() const;
+
+    /**
+     * If user-eeprom is modified, changes are written to the mcu's flash.
+     * A running incremental flush is finished first. Returns when all changes are written.
+     * @warn Interrupts are disabled during every flash operation.
      */
     void writeUserEeprom();
     void readUserEeprom();
 
+    /**
+     * Start an incremental flush of the modifications. The flash is written by
+     * subsequent calls of @ref flushStep(). A modification after the start restarts
+     * the flush with the next step, so that the flash always gets the content
+     * of one point in time.
+     */
+    void startFlush();
+
+    /**
+     * Perform the next step of an incremental flush: erase the flash sector, program one page,
+     * or append one log record. Interrupts are only disabled during this single flash operation.
+     *
+     * @return True if the flush is finished, false if more steps are required.
+     */
+    bool flushStep();
+
+    /**
+     * Test if an incremental flush is running.
+     */
+    bool isFlushing() const;
+
+    /**
+     * Get the number of flushes which were skipped because the content of the
+     * user EEPROM was identical to the content of the flash.
+     */
+    unsigned int avoidedWriteCount() const;
+
 protected:
     /**
-     * Finds the last valid page in the flash sector.
+     * Read the user EEPROM from a flash sector in the log-structured layout:
+     * copy the base image and replay all valid log records.
      *
-     * @details The search is done backwards from the end of the mcu flash in  @ref FLASH_SECTOR_SIZE steps.
+     * @return True if the sector is in the log-structured layout, false if not.
+     */
+    bool readLog();
+
+    /**
+     * Flush step of the log-structured layout: append records for the changed ranges
+     * of the modified pages. The records which fit into the current page of the log
+     * are programmed together.
      *
-     * @return If successful: number of the last valid flash page, otherwise 0
+     * @return True if all modified pages are written, false if more steps are required.
      */
-    byte* findValidPage();
+    bool appendLogRecords();
+
+    /**
+     * Read the user EEPROM from a flash sector in the default layout.
+     *
+     * @details The first page of the sector holds the page table, the other pages are slots.
+     *          Every slot holds a copy of one flash page of the user EEPROM. The table starts with
+     *          a header like the log-structured layout, followed by one entry per programmed slot.
+     *          A flush programs the modified pages, which differ from their current slot, into the
+     *          next free slots. The other pages stay in their slots. Then the flush appends the
+     *          entries of all these slots with one program operation. The newest entry of a page
+     *          tells its current slot. When the slots or the table are full, the sector is erased
+     *          and all pages are written again.
+     *          Reading checks the data CRC of the newest entry of each page only. The pages of a
+     *          flush are valid together: a slot with a CRC error drops its flush and all later ones.
+     *
+     * @return True if the sector holds a valid page table, false if not.
+     */
+    bool readTable();
+
+    /**
+     * Test if an entry of the page table is valid. The data of its slot is not checked.
+     *
+     * @param entry - the entry in the page table
+     * @param following - the number of entries of the same flush behind this one
+     */
+    bool isTableEntryValid(const byte* entry, unsigned int following) const;
+
+    /**
+     * Test if the data of the slot of a valid entry of the page table matches the CRC of the entry.
+     *
+     * @param entry - the entry in the page table
+     */
+    bool isSlotValid(const byte* entry) const;
+
+    /**
+     * Program the page at @ref flushPos of the base image of the log-structured layout.
+     */
+    void programFlushPage();
+
+    /**
+     * Program the next page of @ref flushPages, starting at @ref flushPos, into the next free slot.
+     */
+    void programSlot();
+
+    /**
+     * Append the entries of the slots programmed by the running flush to the page table.
+     * This makes the new content valid.
+     */
+    void commitTable();
+
+    /**
+     * Finish a flush and remember the CRC of the written content.
+     */
+    void flushFinished();
+
+    /**
+     * Compare the user EEPROM with the content of the flash.
+     *
+     * @return True if the flash contains the same data, false if not.
+     */
+    bool isFlashContentEqual() const;
+
+    /**
+     * Apply all valid log records to a part of the user EEPROM.
+     *
+     * @param offset - the offset of the part in the user EEPROM
+     * @param length - the length of the part
+     * @param dest - the part of the user EEPROM to apply the records to
+     *
+     * @return The position of the first free byte in the log,
+     *         FLASH_SECTOR_SIZE if the log is full or has an invalid record.
+     */
+    unsigned int replayLog(unsigned int offset, unsigned int length, byte* dest) const;
+
+    /**
+     * Get the position of the log in the flash sector, directly behind the page with the end of the base image.
+     */
+    unsigned int logStart() const;
+
+    /**
+     * Finds the last used slot of the layout of older library versions, which
+     * marks a used slot with a last byte of 0. The sector is only taken for this layout
+     * if its first slot is used and it has no header of the other layouts.
+     *
+     * @return If successful: address of the last used slot, otherwise nullptr
+     */
+    byte* findLegacyPage() const;
+
+    /**
+     * Get the number of flash pages of the user EEPROM.
+     */
+    unsigned int numImagePages() const;
+
+    /**
+     * Get the number of bytes of a flash page of the user EEPROM, less than
+     * @ref FLASH_PAGE_SIZE for the last page if the size is not a multiple of it.
+     */
+    unsigned int imagePageLength(unsigned int page) const;
+
+    /**
+     * Get the number of slots in the flash sector. The slots are numbered from 1 on,
+     * the first page of the sector holds the page table.
+     */
+    unsigned int numSlots() const;
+
+    /**
+     * Get the flash address of a slot.
+     */
+    byte* slotAddress(unsigned int slot) const;
 
     bool userEepromModified = false;
     unsigned int writeUserEepromTime = 0;
 
+    /** States of an incremental flush */
+    enum FlushState
+    {
+        FLUSH_IDLE,    //!< no flush running
+        FLUSH_ERASE,   //!< erase the flash sector
+        FLUSH_PROGRAM, //!< program the next slot or page of the base image
+        FLUSH_COMMIT,  //!< program the page table or the page of the base image which makes the new content valid
+        FLUSH_APPEND   //!< append the next log record
+    };
+
+    FlushState flushState = FLUSH_IDLE;
+    byte* flushSlot = nullptr;     //!< start of the base image which is written
+    unsigned int flushPos = 0;     //!< position of the next page of the base image, or the next page of the user EEPROM to program into a slot
+    uint32_t flushPages = 0;       //!< bitmap of the pages which are written by the running flush
+    unsigned int flushFirstSlot = 0; //!< slot of the first page which is written by the running flush
+
+    byte* pageSlots;               //!< current slot of every page of the user EEPROM, 0 if none
+    unsigned int nextFreeSlot = 0; //!< next slot to program, behind all used slots
+    unsigned int tableWritePos = 0; //!< position of the next entry in the page table, 0 if there is no valid page table
+    uint16_t flushCrc = 0;         //!< CRC of the content which is written by the running flush
+    bool modifiedWhileFlushing = false; //!< true if the content was modified after the start of the running flush
+    uint16_t committedCrc = 0;     //!< CRC of the content of the flash
+    bool committedCrcValid = false; //!< true if @ref committedCrc is known
+    unsigned int avoidedWrites = 0; //!< number of skipped flushes, see @ref avoidedWriteCount()
+
+    uint32_t modifiedPages = 0;    //!< bitmap of the modified pages, bit n for the bytes from n * @ref FLASH_PAGE_SIZE on
+
+    bool logStructured = false;    //!< true if the log-structured layout is selected
+    bool logOnFlash = false;       //!< true if the flash sector is in the log-structured layout
+    unsigned int logWritePos = 0;  //!< position of the next log record in the flash sector, below @ref logStart() if there is no usable log
+
     const unsigned int userEepromFlashSize;
 };
 
@@ -9,6 +9,7 @@
 #define SBLIB_EIB_USERRAM_H_
 
 #include <stdint.h>
+#include <sblib/platform.h>
 #include <sblib/eib/memory.h>
 
 /**
@@ -60,7 +61,7 @@ public:
      *          is used for communication objects as well.
      *          Therefore the real status is at the end of the user ram.
      */
-    uint8_t& status();
+    RAM_FUNC uint8_t& status();
     uint8_t& runState();
 
     /**
@@ -91,6 +92,11 @@ public:
 
     bool isStatusAddress(uint32_t address) const;
 
+    /**
+     * Get the address of the status byte.
+     */
+    uint32_t statusAddr() const { return statusOffset(); }
+
     uint8_t* userRamData = 0;
 
 protected:
@@ -92,6 +92,31 @@ IAP_Status iapEraseSectorRange(const unsigned int startSector, const unsigned in
  */
 IAP_Status iapErasePage(const unsigned int pageNumber);
 
+/**
+ * Keep interrupts enabled during IAP calls. Only available with the build option
+ * IAP_KEEP_BUS_INTERRUPTS, otherwise all interrupts are disabled during IAP calls.
+ *
+ * The handlers of the interrupts, and everything they call, must be located in RAM,
+ * see RAM_FUNC. The vector table is copied to the start of the RAM and remapped there,
+ * unless the bootloader did this already. The first 192 bytes of the RAM must therefore
+ * be reserved: the RAM memory region of the application (linker symbol __base_RAM) has
+ * to start at 0x100000C0 or above. Otherwise all interrupts stay disabled during IAP calls.
+ * All other interrupts are masked during IAP calls. SysTick keeps running.
+ *
+ * @param interruptMask - bit mask of the interrupts (1 << IRQn) which stay enabled
+ * @return true if the interrupts stay enabled during IAP calls, false if all interrupts
+ *         are disabled, because the option is not enabled or the RAM is not reserved
+ */
+bool iapKeepInterrupts(unsigned int interruptMask);
+
+/**
+ * Test if an IAP call is in progress. Interrupt handlers which stay enabled during
+ * IAP calls must not access the flash while this is true.
+ *
+ * @return true if an IAP call is in progress, otherwise false
+ */
+ALWAYS_INLINE bool iapBusy();
+
 /**
  * Erase the specified page range.
  *
@@ -144,4 +169,15 @@ IAP_Status iapReadPartID(unsigned int* partId);
 unsigned int iapFlashSize();
 
 
+//
+// Inline functions
+//
+
+extern volatile bool iapCallActive; //!< An IAP call is in progress, use iapBusy()
+
+ALWAYS_INLINE bool iapBusy()
+{
+    return iapCallActive;
+}
+
 #endif /* sblib_iap_h */
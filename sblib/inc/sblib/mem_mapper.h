@@ -22,6 +22,15 @@
 #define MEM_MAPPER_OUT_OF_MEMORY   -4
 #define MEM_MAPPER_INVALID_LENGTH  -8
 
+/**
+ * Number of flash pages the MemMapper keeps in RAM. Modified pages are only written
+ * to flash when they are evicted from the cache or on @ref MemMapper::doFlash().
+ * Every page costs FLASH_PAGE_SIZE bytes of RAM.
+ */
+#ifndef MEM_MAPPER_CACHE_PAGES
+#   define MEM_MAPPER_CACHE_PAGES 2
+#endif
+
 ///\todo class Memory as base class for MemMapper
 class MemMapper
 {
@@ -96,7 +105,7 @@ public:
      * Force writing all pending data to flash
      *
      *
-     * @return 0 nothing flashed, 1 allocation table flashed, 2 data page flashed
+     * @return 0 nothing flashed, 1 allocation table flashed, 2 data page(s) flashed
      */
     int doFlash(void) const;
 
@@ -190,6 +199,71 @@ public:
     virtual bool isMappedRange(int virtStartAddress, int virtEndAddress);
 
 private:
+    /**
+     * Write bytes within one virtual page, same as @ref writeMem() for every byte
+     *
+     * @param virtAddress - a 16 bit virtual address
+     * @param data - bytes that should be written to the address
+     * @param length - number of bytes to write, must not cross a virtual page boundary
+     * @return 0 on success, else error
+     */
+    int writeSpan(int virtAddress, const byte *data, int length);
+
+    /**
+     * Read bytes within one virtual page, same as @ref readMem() for every byte
+     *
+     * @param virtAddress - a 16 bit virtual address
+     * @param data - buffer for the read data
+     * @param length - number of bytes to read, must not cross a virtual page boundary
+     * @param forceFlash - force pending data to be flashed before operation
+     * @return 0 on success, else error
+     */
+    int readSpan(int virtAddress, byte *data, int length, bool forceFlash);
+
+    /**
+     * A flash page held in RAM by the page cache.
+     */
+    struct CachePage
+    {
+        byte data[FLASH_PAGE_SIZE] __attribute__ ((aligned (FLASH_RAM_BUFFER_ALIGNMENT))); //!< Content of the page, word aligned for the IAP
+        int flashPage;     //!< Physical flash page number, 0 if the cache entry is unused
+        unsigned int used; //!< Value of useCounter at the last access, for the LRU replacement
+        bool modified;     //!< true if data differs from the flash page
+    };
+
+    /**
+     * Get the cache entry of a flash page, loading it into the cache if needed.
+     * The least recently used entry is written back and replaced if the cache is full.
+     *
+     * @param flashPage - the physical flash page number
+     * @param load - true to copy the flash page content into the cache, false to zero it
+     * @return the cache entry
+     */
+    CachePage* cachePage(int flashPage, bool load) const;
+
+    /**
+     * Find the cache entry of a flash page.
+     *
+     * @param flashPage - the physical flash page number
+     * @return the cache entry or nullptr if the page is not cached
+     */
+    CachePage* findCachePage(int flashPage) const;
+
+    /**
+     * Write a modified cache entry back to flash.
+     *
+     * @param page - the cache entry
+     * @return true if the page was flashed
+     */
+    bool writeBack(CachePage* page) const;
+
+    /**
+     * Flash the allocation table, if it was modified.
+     *
+     * @return true if the table was flashed
+     */
+    bool flashAllocTable() const;
+
     int allocatePage(int virtPage);
     int getFlashPageNum(int virtAddress) const;
     unsigned int getUIntX(int virtAddress, int length);
@@ -203,14 +277,13 @@ private:
 
     byte allocTable[FLASH_PAGE_SIZE];
 
-    mutable byte writeBuf[FLASH_PAGE_SIZE];
-    mutable int writePage;
+    mutable CachePage cache[MEM_MAPPER_CACHE_PAGES];
+    mutable unsigned int useCounter;
 
     unsigned int lastAllocated;
     int endianess;
 
     bool autoAddPage;
-    mutable bool flashMemModified;
     mutable bool allocTableModified;
 };
 
@@ -81,4 +81,24 @@ unsigned int* ioconPointer(int port, int pinNum);
 #define FLASH_PAGE_ALIGNMENT (FLASH_PAGE_SIZE - 1) //!< Page alignment which is allowed to flash
 #define FLASH_RAM_BUFFER_ALIGNMENT (4)             //!< MCU's RAM buffer alignment which is allowed to flash
 
+/**
+ * Build option IAP_KEEP_BUS_INTERRUPTS: the bus interrupt handler and everything it calls
+ * is located in RAM, so bus reception and ACKs continue while the flash is erased or
+ * programmed. See iapKeepInterrupts().
+ *
+ * RAM_FUNC places a function in RAM, RAM_DATA places constant data in RAM.
+ * The startup code copies both together with the initialized data.
+ * Jump tables and copy loops which the compiler replaces by memcpy()/memset()
+ * calls would reach into the flash, so both are disabled for RAM functions.
+ * Divisions must be avoided, they call the division functions of libgcc.
+ */
+#if defined(IAP_KEEP_BUS_INTERRUPTS) && !defined(IAP_EMULATION)
+#   define RAM_FUNC __attribute__ ((section(".data.ramfunc"), long_call, noinline, \
+                                    optimize("no-jump-tables", "no-tree-loop-distribute-patterns")))
+#   define RAM_DATA __attribute__ ((section(".data.ramdata")))
+#else
+#   define RAM_FUNC
+#   define RAM_DATA
+#endif
+
 #endif /*sblib_platform_h*/
@@ -322,7 +322,7 @@ public:
      * SET:          Set the digital pin of the match channel to 1 on match.
      * TOGGLE:       Toggle the digital pin of the match channel.
      */
-    void matchMode(int channel, int mode);
+    RAM_FUNC void matchMode(int channel, int mode);
 
     /**
      * Get the configuration of a match channel.
@@ -369,7 +369,7 @@ public:
      * FALLING_EDGE: Capture on falling edge: a sequence of 1 then 0 on the capture pin will cause
      *               the capture channel to be loaded with the current timer value.
      */
-    void captureMode(int channel, int mode);
+    RAM_FUNC void captureMode(int channel, int mode);
 
     /**
      * Get the configuration of a capture channel.
@@ -437,7 +437,7 @@ public:
      *
      * Example:  timer16_0.counterMode(CAP0|RISING_EDGE, CAP1|FALLING_EDGE);
      */
-    void counterMode(int mode, int clearMode);
+    RAM_FUNC void counterMode(int mode, int clearMode);
 
     /**
      * Configure a match pin mode of the channel.
@@ -477,6 +477,11 @@ public:
      */
     void setIRQPriority(uint32_t newPriority);
 
+    /**
+     * Get the number of the interrupt of the associated hardware timer.
+     */
+    IRQn_Type irqNumber() const;
+
 protected:
 	LPC_TMR_TypeDef* timer;
     byte timerNum;
@@ -587,6 +592,11 @@ ALWAYS_INLINE int Timer::flagMask(TimerCapture capture)
     return 16 << capture;
 }
 
+ALWAYS_INLINE IRQn_Type Timer::irqNumber() const
+{
+    return (IRQn_Type) (TIMER_16_0_IRQn + timerNum);
+}
+
 ALWAYS_INLINE void Timer::interrupts()
 {
     NVIC_EnableIRQ((IRQn_Type) (TIMER_16_0_IRQn + timerNum));
@@ -25,6 +25,17 @@
  */
 void reverseCopy(byte* dest, const byte* src, int len);
 
+/**
+ * Copy an array of elements from src to dest with reversing the byte order of
+ * each element. The order of the elements is kept.
+ *
+ * @param dest - the destination to copy to
+ * @param src - the source to copy from
+ * @param count - the number of elements to copy
+ * @param size - the size of one element in bytes
+ */
+void reverseCopyElements(byte* dest, const byte* src, int count, int size);
+
 /**
  * Call when a fatal application error happens. This function will never
  * return and the program/fatalError LED (can be changed with setFatalErrorPin) will blink rapidly to indicate the error.
@@ -55,6 +66,17 @@ void setKNX_TX_Pin(int newTxPin);
  */
 int hashUID(byte* uid, const int len_uid, byte* hash, const int len_hash);
 
+/**
+ * Calculate the CRC-16/CCITT (polynomial 0x1021) of a data block.
+ * Pass the result of a previous call as crc to continue the calculation over several blocks.
+ *
+ * @param data - the data to calculate the CRC of
+ * @param len - the number of bytes
+ * @param crc - the start value of the CRC
+ * @return The CRC of the data.
+ */
+uint16_t crc16Ccitt(const byte* data, int len, uint16_t crc = 0xffff);
+
 /**
  * Get the offset of a field in a class, structure or type.
  *
@@ -13,6 +13,86 @@
 #include <sblib/eib/property_types.h>
 #include <sblib/bits.h>
 #include <sblib/eib/userEeprom.h>
+#include <sblib/interrupt.h>
+
+AddrTables::AddrTables() :
+    checkedTab(nullptr),
+    checkedNum(-1),
+    sorted(false)
+{
+}
+
+void AddrTables::rebuild()
+{
+    int num;
+    const byte* tab = groupAddresses(num);
+
+    bool ascending = true;
+    for (int i = 1; i < num; ++i)
+    {
+        if (makeWord(tab[(i - 1) * 2], tab[(i - 1) * 2 + 1]) >= makeWord(tab[i * 2], tab[i * 2 + 1]))
+        {
+            ascending = false;
+            break;
+        }
+    }
+
+    // the bus interrupt must not see the result of one table with another table
+    noInterrupts();
+    checkedTab = tab;
+    checkedNum = num;
+    sorted = ascending;
+    interrupts();
+}
+
+void AddrTables::invalidate()
+{
+    sorted = false;
+}
+
+int AddrTables::indexOfAddr(int addr)
+{
+    int num;
+    const byte* tab = groupAddresses(num);
+    return indexOfAddr(tab, num, addr);
+}
+
+int AddrTables::cachedIndexOfAddr(int addr)
+{
+    return indexOfAddr(checkedTab, checkedNum, addr);
+}
+
+int AddrTables::indexOfAddr(const byte* tab, int num, int addr)
+{
+    if (sorted && (tab == checkedTab) && (num == checkedNum))
+    {
+        int low = 0;
+        int high = num - 1;
+        while (low <= high)
+        {
+            int mid = (low + high) >> 1;
+            int midAddr = (tab[mid * 2] << 8) | tab[mid * 2 + 1]; // no makeWord(), it may be located in flash
+            if (midAddr == addr)
+                return mid + 1;
+            if (midAddr < addr)
+                low = mid + 1;
+            else
+                high = mid - 1;
+        }
+        return -1;
+    }
+
+    int addrHigh = addr >> 8;
+    int addrLow = addr & 255;
+
+    for (int i = 1; i <= num; ++i, tab += 2)
+    {
+        if (tab[0] == addrHigh && tab[1] == addrLow)
+            return i;
+    }
+
+    return -1;
+}
 
 int AddrTables::objectOfAddr(int addr)
 {
@@ -42,3 +122,20 @@ uint16_t AddrTables::addrCount()
     byte* ptrAddrTable = addrTable();
     return (*ptrAddrTable);
 }
+
+int AddrTables::addrTableSize()
+{
+    byte* tab = addrTable();
+    if (tab == nullptr)
+        return 0;
+    // length, own physical address and group addresses, the length counts the own address
+    return 1 + (*tab << 1);
+}
+
+int AddrTables::assocTableSize()
+{
+    byte* tab = assocTable();
+    if (tab == nullptr)
+        return 0;
+    return 1 + (*tab << 1);
+}
@@ -9,25 +9,15 @@
 #include <sblib/eib/bcu2.h>
 #include <sblib/bits.h>
 
-int AddrTablesBCU2::indexOfAddr(int addr)
+const byte* AddrTablesBCU2::groupAddresses(int& num)
 {
     byte* tab = addrTable();
-    int num = 0;
+    num = 0;
 
-    if (tab)
-        num = *tab;
-    tab += 3;
-
-    int addrHigh = addr >> 8;
-    int addrLow = addr & 255;
-
-    for (int i = 1; i <= num; ++i, tab += 2)
-    {
-        if (tab[0] == addrHigh && tab[1] == addrLow)
-            return i;
-    }
-
-    return -1;
+    // the length counts the own physical address in front of the group addresses
+    if (tab && *tab)
+        num = *tab - 1;
+    return tab + 3;
 }
 
 byte* AddrTablesBCU2::addrTable()
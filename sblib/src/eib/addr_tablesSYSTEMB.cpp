@@ -9,23 +9,30 @@
 #include <sblib/eib/systemb.h>
 #include <sblib/bits.h>
 
-int AddrTablesSYSTEMB::indexOfAddr(int addr)
+const byte* AddrTablesSYSTEMB::groupAddresses(int& num)
 {
     byte* tab = addrTable();
-    int num = 0;
+    num = 0;
 
     if (tab)
         num = (tab[0] << 8) + tab[1];
-    tab += 2;
-
-    int addrHigh = addr >> 8;
-    int addrLow = addr & 255;
+    return tab + 2;
+}
 
-    for (int i = 1; i <= num; ++i, tab += 2)
-    {
-        if (tab[0] == addrHigh && tab[1] == addrLow)
-            return i;
-    }
+int AddrTablesSYSTEMB::addrTableSize()
+{
+    byte* tab = addrTable();
+    if (tab == nullptr)
+        return 0;
+    // 2 bytes length, no own physical address
+    return 2 + (makeWord(tab[0], tab[1]) << 1);
+}
 
-    return -1;
+int AddrTablesSYSTEMB::assocTableSize()
+{
+    byte* tab = assocTable();
+    if (tab == nullptr)
+        return 0;
+    // 2 bytes length, 4 bytes per association
+    return 2 + (makeWord(tab[0], tab[1]) << 2);
 }
@@ -39,16 +39,55 @@ BcuBase::BcuBase(UserRam* userRam, AddrTables* addrTables) :
         addrTables(addrTables),
         comObjects(nullptr),
         progButtonDebouncer(),
-        requestedRestartType(NO_RESTART)
+        requestedRestartType(NO_RESTART),
+        tableCaches(nullptr),
+        tableCachesOutdated(true)
 {
     timerBusObj = bus;
     setFatalErrorPin(progPin);
     setKNX_TX_Pin(bus->txPin);
+    registerTableCache(addrTables);
+}
+
+void BcuBase::registerTableCache(TableCache* cache)
+{
+    if (cache == nullptr)
+    {
+        return;
+    }
+    cache->nextTableCache = tableCaches;
+    tableCaches = cache;
+    tableCachesOutdated = true;
+}
+
+void BcuBase::tablesChanged()
+{
+    tableCachesOutdated = true;
+
+    for (TableCache* cache = tableCaches; cache != nullptr; cache = cache->nextTableCache)
+    {
+        cache->invalidate();
+    }
+}
+
+void BcuBase::updateTableCaches()
+{
+    if (!tableCachesOutdated)
+    {
+        return;
+    }
+    tableCachesOutdated = false;
+
+    for (TableCache* cache = tableCaches; cache != nullptr; cache = cache->nextTableCache)
+    {
+        cache->rebuild();
+    }
 }
 
 void BcuBase::_begin()
 {
     TLayer4::_begin();
+    updateTableCaches(); // the bus interrupt uses the caches
     bus->begin();
     progButtonDebouncer.init(1);
 }
@@ -57,6 +96,8 @@ void BcuBase::loop()
 {
     bus->loop();
     TLayer4::loop();
+    updateTableCaches();
+
     bool telegramInQueu = bus->telegramReceived();
     telegramInQueu &= (!bus->sendingTelegram());
 
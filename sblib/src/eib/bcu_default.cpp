@@ -30,12 +30,26 @@ BcuDefault::BcuDefault(UserRam* userRam, UserEeprom* userEeprom, ComObjects* com
         BcuBase(userRam, addrTables),
         userEeprom(userEeprom),
         memMapper(nullptr),
+        userEepromRegion(userEeprom),
+        userRamRegion(userRam),
+        userRamStatusRegion(userRam),
+        memoryRegionList(nullptr),
+        memoryRegionCount(0),
+        registeredMemoryRegions(0),
+        memoryRegionsOutdated(true),
 		usrCallback(nullptr),
 		sendGrpTelEnabled(false),
 		groupTelWaitMillis(DEFAULT_GROUP_TEL_WAIT_MILLIS),
-		groupTelSent(millis())
+		groupTelSent(millis()),
+		startupWindowMillis(0),
+		startupArmed(false),
+		startupTime(millis()),
+		startupSeed(0)
 {
     this->comObjects = comObjects;
+    registerMemoryRegion(&userEepromRegion);
+    registerMemoryRegion(&userRamRegion);
+    registerMemoryRegion(&userRamStatusRegion);
 }
 
 void BcuDefault::_begin()
@@ -47,6 +61,7 @@ void BcuDefault::_begin()
     }
 #endif
     BcuBase::_begin();
+    memoryRegionsOutdated = true; // the application may have moved the user RAM
 
 #ifdef DUMP_PROPERTIES ///\todo move to BCU2::begin(...)
     IF_DEBUG(serial.println("Properties dump enabled."));
@@ -89,6 +104,73 @@ void BcuDefault::_begin()
 
     // set limit to max of 28 telegrams per second (wait 35ms) -  to avoid risk of thermal destruction of the sending circuit
     groupTelWaitMillis = DEFAULT_GROUP_TEL_WAIT_MILLIS ;
+
+    // device specific seed for the startup window, devices of a line have consecutive physical addresses
+    byte uniqueID[IAP_UID_LENGTH];
+    byte uidHash[sizeof(startupSeed)] = {};
+    if (iapReadUID(&uniqueID[0]) == IAP_SUCCESS)
+    {
+        hashUID(&uniqueID[0], sizeof(uniqueID), &uidHash[0], sizeof(uidHash));
+    }
+    memcpy(&startupSeed, &uidHash[0], sizeof(startupSeed));
+    startupSeed ^= ownAddress();
+    startupArmed = false;
+    startupTime = millis();
+    handleStartupDelay();
+}
+
+void BcuDefault::setStartupDelay(unsigned int windowMillis)
+{
+    startupWindowMillis = windowMillis;
+    startupArmed = false;
+    startupTime = millis();
+    handleStartupDelay();
+}
+
+void BcuDefault::handleStartupDelay()
+{
+    if (comObjects == nullptr)
+    {
+        return;
+    }
+
+    unsigned int halfWindow = startupWindowMillis / 2;
+    if (halfWindow == 0)
+    {
+        comObjects->setSendPriorityLimit(COMCONF_PRIO_LOW);
+        return;
+    }
+
+    // everything requested until the bus is ready belongs to the startup burst,
+    // the window starts when the bus is ready (e.g. after bus voltage recovery)
+    if (!startupArmed)
+    {
+        comObjects->markStartupBurst();
+        startupTime = millis();
+        if (!bus->ready())
+        {
+            comObjects->setSendPriorityLimit(COMCONF_PRIO_ALARM);
+            return;
+        }
+        startupArmed = true;
+    }
+
+    unsigned int offset = startupSeed % halfWindow;
+    unsigned int sinceStart = elapsed(startupTime);
+
+    if (sinceStart >= offset + halfWindow)
+    {
+        comObjects->setSendPriorityLimit(COMCONF_PRIO_LOW);
+        startupWindowMillis = 0; // startup done
+    }
+    else if (sinceStart >= offset)
+    {
+        comObjects->setSendPriorityLimit(COMCONF_PRIO_HIGH);
+    }
+    else
+    {
+        comObjects->setSendPriorityLimit(COMCONF_PRIO_ALARM);
+    }
 }
 
 void BcuDefault::begin(int manufacturer, int deviceType, int version)
@@ -119,7 +201,7 @@ void BcuDefault::setOwnAddress(uint16_t addr)
     {
         userEeprom->addrTab()[0] = HIGH_BYTE(addr);
         userEeprom->addrTab()[1] = lowByte(addr);
-        userEeprom->modified(true);
+        userEeprom->modified(userEeprom->addrTab(), 2);
     }
     BcuBase::setOwnAddress(addr);
 }
@@ -141,6 +223,11 @@ void BcuDefault::loop()
     // check for next telegram to be send
     if (sendGrpTelEnabled && applicationRunning())
     {
+        if (startupWindowMillis)
+        {
+            handleStartupDelay();
+        }
+
         // Send group telegram if group telegram rate limit not exceeded
         if (elapsed(groupTelSent) >= groupTelWaitMillis)
         {
@@ -157,11 +244,30 @@ void BcuDefault::loop()
         }
     }
 
-    if (userEeprom->isModified() && bus->idle() && bus->telegramLen == 0 && !directConnection())
+    if (userEeprom->isFlushing())
+    {
+        // Incremental flush: one flash operation per call and only while the bus is idle,
+        // so the bus interrupt is blocked at most for a single flash operation
+        if (bus->idle())
+        {
+            userEeprom->flushStep();
+        }
+    }
+    else if (userEeprom->isModified() && bus->idle() && bus->telegramLen == 0 && !directConnection())
     {
         if (userEeprom->writeDelayElapsed())
         {
-            flushUserMemory(UsrCallbackType::flash, true);
+            if (usrCallback)
+            {
+                usrCallback->Notify(UsrCallbackType::flash);
+            }
+
+            userEeprom->startFlush();
+
+            if (memMapper)
+            {
+                memMapper->doFlash();
+            }
         }
     }
 }
@@ -308,6 +414,126 @@ bool BcuDefault::processApciMemoryReadPDU(int addressStart, byte *payLoad, int l
     return result;
 }
 
+static bool rangesOverlap(const byte* start, unsigned int length, const byte* tabStart, int tabLength)
+{
+    if ((tabStart == nullptr) || (tabLength <= 0))
+    {
+        return false;
+    }
+    return (start < tabStart + tabLength) && (tabStart < start + length);
+}
+
+bool BcuDefault::tablesOverlap(unsigned int addressStart, unsigned int length)
+{
+    const byte* start = userMemoryPtr(addressStart);
+    if (start == nullptr)
+    {
+        return false;
+    }
+
+    // writing the table pointers moves the tables
+    if (rangesOverlap(start, length, &userEeprom->assocTabPtr(), 1) ||
+        rangesOverlap(start, length, &userEeprom->commsTabPtr(), 1) ||
+        rangesOverlap(start, length, &userEeprom->addrTabSize(), 1))
+    {
+        return true;
+    }
+
+    return rangesOverlap(start, length, addrTables->addrTable(), addrTables->addrTableSize()) ||
+           rangesOverlap(start, length, addrTables->assocTable(), addrTables->assocTableSize()) ||
+           rangesOverlap(start, length, comObjects->objectConfigTable(), comObjects->objectConfigTableSize());
+}
+
+bool BcuDefault::registerMemoryRegion(MemoryRegion* region)
+{
+    if ((region == nullptr) || (registeredMemoryRegions >= MAX_MEMORY_REGIONS))
+    {
+        return (false);
+    }
+    region->nextMemoryRegion = memoryRegionList;
+    memoryRegionList = region;
+    registeredMemoryRegions++;
+    memoryRegionsOutdated = true;
+    return (true);
+}
+
+void BcuDefault::updateMemoryRegions()
+{
+    if (!memoryRegionsOutdated)
+    {
+        return;
+    }
+    memoryRegionsOutdated = false;
+
+    // insertion sort by start address, empty regions are left out
+    memoryRegionCount = 0;
+    for (MemoryRegion* region = memoryRegionList; region != nullptr; region = region->nextMemoryRegion)
+    {
+        MemoryRegionEntry entry = { region->startAddr(), region->endAddr(), region };
+        if (entry.end < entry.start)
+        {
+            continue;
+        }
+
+        int i = memoryRegionCount++;
+        while ((i > 0) && (memoryRegions[i - 1].start > entry.start))
+        {
+            memoryRegions[i] = memoryRegions[i - 1];
+            i--;
+        }
+        memoryRegions[i] = entry;
+    }
+
+    // where regions overlap, the region with the higher start address takes precedence
+    for (int i = 0; i + 1 < memoryRegionCount; i++)
+    {
+        if (memoryRegions[i].end >= memoryRegions[i + 1].start)
+        {
+            memoryRegions[i].end = memoryRegions[i + 1].start - 1;
+        }
+    }
+}
+
+const BcuDefault::MemoryRegionEntry* BcuDefault::findMemoryRegion(uint32_t address)
+{
+    updateMemoryRegions();
+
+    // binary search for the last region which starts at or before the address
+    int low = 0;
+    int high = memoryRegionCount - 1;
+    const MemoryRegionEntry* found = nullptr;
+    while (low <= high)
+    {
+        int mid = (low + high) / 2;
+        if (memoryRegions[mid].start <= address)
+        {
+            found = &memoryRegions[mid];
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    if ((found == nullptr) || (found->end < address))
+    {
+        return nullptr;
+    }
+    return found;
+}
+
+unsigned int BcuDefault::memMapperMappedLength(unsigned int address, unsigned int length)
+{
+    // the memory mapper maps whole pages
+    unsigned int mapped = 0;
+    while ((mapped < length) && memMapper->isMapped(address + mapped))
+    {
+        mapped += FLASH_PAGE_SIZE - ((address + mapped) & (FLASH_PAGE_SIZE - 1));
+    }
+    return (mapped < length) ? mapped : length;
+}
+
 bool BcuDefault::processApciMemoryOperation(unsigned int addressStart, byte *payLoad, unsigned int lengthPayLoad, const bool &readMem)
 {
     if (lengthPayLoad == 0)
@@ -328,158 +554,80 @@ bool BcuDefault::processApciMemoryOperation(unsigned int addressStart, byte *pay
         return (false);
     }
 
-    bool startNotFound = false; // we need this as a exit condition, in case memory range is no where found
-    bool startFound;
-    bool endFound;
+    const unsigned int writeStart = addressStart;
+    const unsigned int writeLength = lengthPayLoad;
+    bool result = true;
+
+    // the bus interrupt looks up group addresses, it must not use the caches of the old tables while they are written
+    if ((!readMem) && tablesOverlap(writeStart, writeLength))
+    {
+        tablesChanged();
+    }
 
-    while ((!startNotFound) && (addressStart <= addressEnd))
+    while (lengthPayLoad > 0)
     {
-        startNotFound = true;
-        // check if we have a memMapper and if payLoad is handled by it
+        bool operationResult;
+        unsigned int count = 0;
+
+        // the memory mapper takes precedence over the memory regions
         if (memMapper != nullptr)
         {
-            startFound = memMapper->isMapped(addressStart);
-            endFound = memMapper->isMapped(addressEnd);
-            if (startFound && endFound)
-            {
-                // start & end fit into memMapper
-                bool operationResult = false;
-                if (readMem)
-                    operationResult = memMapper->readMemPtr(addressStart, &payLoad[0], lengthPayLoad) == MEM_MAPPER_SUCCESS;
-                else
-                    operationResult = memMapper->writeMemPtr(addressStart, &payLoad[0], lengthPayLoad) == MEM_MAPPER_SUCCESS;
-
-                if (operationResult)
-                {
-                    DB_MEM_OPS(serial.println(" -> memmapped ", lengthPayLoad, DEC));
-                    return (true);
-                }
-                else
-                    return (false);
-            }
-            else if (startFound)
-            {
-                // we only know that start is mapped so lets do memory operation byte by byte
-                for (unsigned int i = 0; i < lengthPayLoad; i++)
-                {
-                    bool operationResult = memMapper->isMapped(addressStart);
-                    if (operationResult)
-                    {
-                        if (readMem)
-                            operationResult = memMapper->readMemPtr(addressStart, &payLoad[0], 1) == MEM_MAPPER_SUCCESS;
-                        else
-                            operationResult = memMapper->writeMemPtr(addressStart, &payLoad[0], 1) == MEM_MAPPER_SUCCESS;
-                    }
-
-                    if (operationResult)
-                    {
-                        // address is mapped and memory operation was successful
-                        addressStart++;
-                        payLoad++;
-                        startNotFound = false;
-                    }
-                    else
-                    {
-                        DB_MEM_OPS(serial.println(" -> memmapped processed : ", i , DEC));
-                        break;
-                    }
-                }
-            }
+            count = memMapperMappedLength(addressStart, lengthPayLoad);
         }
 
-        // check if payLoad is in userEeprom
-        if (userEeprom->inRange(addressStart, addressEnd)) // start & end in userEeprom ?
+        if (count != 0)
         {
-            const int copyCount = addressEnd - addressStart + 1;
-            uint8_t* mem = this->userMemoryPtr(addressStart);
             if (readMem)
-            {
-                memcpy(&payLoad[0], mem, copyCount);
-            }
+                operationResult = memMapper->readMemPtr(addressStart, &payLoad[0], count) == MEM_MAPPER_SUCCESS;
             else
-            {
-                memcpy(mem, &payLoad[0], copyCount);
-                userEeprom->modified(true);
-            }
-            DB_MEM_OPS(serial.println(" -> EEPROM ", copyCount, DEC));
-            return (true);
+                operationResult = memMapper->writeMemPtr(addressStart, &payLoad[0], count) == MEM_MAPPER_SUCCESS;
+            DB_MEM_OPS(serial.println(" -> memmapped ", count, DEC));
         }
-        else if (userEeprom->inRange(addressStart))
+        else
         {
-            // start is in USER_EEPROM, but payLoad is too long, we need to cut it down to fit
-            const int copyCount = (userEeprom->endAddr() - addressStart + 1);
-            uint8_t* mem = this->userMemoryPtr(addressStart);
-            if (readMem)
+            const MemoryRegionEntry* entry = findMemoryRegion(addressStart);
+            if (entry == nullptr)
             {
-                memcpy(&payLoad[0], mem, copyCount);
+                DB_MEM_OPS(
+                    serial.print(" not found start: 0x", addressStart, HEX, 4);
+                    serial.print(" end: 0x", addressEnd, HEX, 4);
+                    serial.println(" lengthPayLoad:", lengthPayLoad);
+                );
+                result = false;
+                break;
             }
-            else
+
+            // cut the request at the end of the region
+            count = entry->end - addressStart + 1;
+            if (count > lengthPayLoad)
             {
-                memcpy(mem, &payLoad[0], copyCount);
-                userEeprom->modified(true);
+                count = lengthPayLoad;
             }
-            addressStart += copyCount;
-            payLoad += copyCount;
-            startNotFound = false;
-            DB_MEM_OPS(serial.println(" -> EEPROM processed: ", copyCount, DEC));
-        }
 
-        // check if payLoad is in UserRam
-        if ((userRam->inRange(addressStart, addressEnd)) ||
-            ((userRam->isStatusAddress(addressStart)) && (userRam->isStatusAddress(addressEnd)))) // USER_RAM_STATUS_ADDRESS (0x60) is system state specific
-        {
-            // start & end are in UserRAM
             if (readMem)
-                userRam->cpyFromUserRam(addressStart, &payLoad[0], addressEnd - addressStart + 1);
+                operationResult = entry->region->read(addressStart, &payLoad[0], count);
             else
-                userRam->cpyToUserRam(addressStart, &payLoad[0], addressEnd - addressStart + 1);
-            DB_MEM_OPS(serial.println(" -> UserRAM ", addressEnd - addressStart + 1, DEC));
-            return (true);
-        }
-        else if (userRam->inRange(addressStart))
-        {
-            // start is in UserRAM, but payLoad is too long, we need to cut it down to fit
-            const int copyCount = userRam->endAddr() - addressStart + 1;
-            if (readMem)
-                userRam->cpyFromUserRam(addressStart, &payLoad[0], copyCount);
-            else
-                userRam->cpyToUserRam(addressStart, &payLoad[0], copyCount);
-            addressStart += copyCount;
-            payLoad += copyCount;
-            startNotFound = false;
-            DB_MEM_OPS(serial.println(" -> UserRAM processed: ", copyCount, DEC));
+                operationResult = entry->region->write(addressStart, &payLoad[0], count);
+            DB_MEM_OPS(serial.println(" -> region ", count, DEC));
         }
 
-        // ok, lets prepare for another try, maybe we find the remaining bytes in another memory
-        lengthPayLoad = addressEnd - addressStart + 1;
-        if (!startNotFound)
+        if (!operationResult)
         {
-            DB_MEM_OPS(
-                (readMem) ? serial.print(" -> MemoryRead :", addressStart, HEX, 4) : serial.print(" -> MemoryWrite:", addressStart, HEX, 4);
-                serial.print(" Data:");
-                for(unsigned int i=0; i<lengthPayLoad ; i++)
-                {
-                    serial.print(" ", payLoad[i], HEX, 2);
-                }
-                serial.print(" count: ", lengthPayLoad, DEC);
-            );
+            result = false;
+            break;
         }
-    }
 
-    DB_MEM_OPS(
-       if (lengthPayLoad != 0)
-       {
-           serial.print(" not found start: 0x", addressStart, HEX, 4);
-           serial.print(" end: 0x", addressEnd, HEX, 4);
-           serial.println(" lengthPayLoad:", lengthPayLoad);
-       }
-       else
-       {
-           serial.println();
-       }
-    );
+        addressStart += count;
+        payLoad += count;
+        lengthPayLoad -= count;
+    }
 
-    return (lengthPayLoad == 0);
+    // check with the table sizes after the write, a new length field can extend a table behind its old end
+    if ((!readMem) && tablesOverlap(writeStart, writeLength))
+    {
+        tablesChanged();
+    }
+    return (result);
 }
 
 bool BcuDefault::processApci(ApciCommand apciCmd, unsigned char * telegram, uint8_t telLength, uint8_t * sendBuffer)
@@ -20,6 +20,7 @@
 #include <sblib/eib/addr_tables.h>
 #include <sblib/eib/bcu_base.h>
 #include <sblib/eib/bus_debug.h>
+#include <sblib/internal/iap.h>
 
 /* L1/L2 msg header control field data bits meaning */
 #define ALWAYS0       	   0          // bit 0 is always 0
@@ -80,6 +81,23 @@
 // Default time between two bits (104 usec)
 #define BIT_TIME 104
 
+// The Cortex-M0 has no divide instruction and the division functions of libgcc are located in flash,
+// so the interrupt handler divides 16 bit timer values by BIT_TIME with a multiplication.
+#define BIT_TIME_RECIPROCAL_SHIFT 22
+#define BIT_TIME_RECIPROCAL (((1u << BIT_TIME_RECIPROCAL_SHIFT) + BIT_TIME - 1) / BIT_TIME)
+
+static_assert(BIT_TIME_RECIPROCAL * BIT_TIME - (1u << BIT_TIME_RECIPROCAL_SHIFT) <= (1u << (BIT_TIME_RECIPROCAL_SHIFT - 16)),
+        "BIT_TIME_RECIPROCAL is not exact for 16 bit timer values");
+static_assert(0xffffull * BIT_TIME_RECIPROCAL <= 0xffffffffull, "BIT_TIME_RECIPROCAL overflows for 16 bit timer values");
+
+/**
+ * Number of complete bit times in a 16 bit timer value, same as time / BIT_TIME.
+ */
+ALWAYS_INLINE unsigned int bitTimes(unsigned int time)
+{
+    return (time * BIT_TIME_RECIPROCAL) >> BIT_TIME_RECIPROCAL_SHIFT;
+}
+
 // Time between two bits (69 usec) - high level part of the pulse on the bus
 #define BIT_WAIT_TIME 69
 
@@ -194,6 +212,10 @@ void Bus::begin()
 	timer.matchMode(timeChannel, INTERRUPT | RESET); // at timeout we have a bus idle state
 	timer.match(pwmChannel, 0xffff);
 
+#ifdef IAP_KEEP_BUS_INTERRUPTS
+	iapKeepInterrupts(1 << timer.irqNumber()); // keep receiving while the flash is programmed
+#endif
+
 	// wait until output is driven low before enabling output pin.
 	// Using digitalWrite(txPin, 0) does not work with MAT channels.
 	timer.value(0xffff); // trigger the next event immediately
@@ -397,7 +419,7 @@ void Bus::handleTelegram(bool valid)
 	// Received a valid telegram with correct checksum and valid control byte (normal data frame with preamble bits)?
 	//todo extended tel, check tel len, give upper layer error info
 	if ( nextByteIndex >= 8 && valid  &&  (( rx_telegram[0] & VALID_DATA_FRAME_TYPE_MASK) == VALID_DATA_FRAME_TYPE_VALUE)
-			&& nextByteIndex <= bcu->maxTelegramSize()  )
+			&& nextByteIndex <= maxTelegramLength  )
 	{
 		int destAddr = (rx_telegram[3] << 8) | rx_telegram[4];
 		bool processTel = false;
@@ -406,7 +428,7 @@ void Bus::handleTelegram(bool valid)
 		if (rx_telegram[5] & 0x80) // group address or physical address
 		{
 		    processTel = (destAddr == 0); // broadcast
-		    processTel |= (bcu->addrTables != nullptr) && (bcu->addrTables->indexOfAddr(destAddr) >= 0); // known group address
+		    processTel |= (bcu->addrTables != nullptr) && (bcu->addrTables->cachedIndexOfAddr(destAddr) >= 0); // known group address
 		}
 		else if (destAddr == bcu->ownAddress())
 		{
@@ -546,7 +568,16 @@ void Bus::finishSendingTelegram()
     if (sendCurTelegram != nullptr)
     {
         sendCurTelegram = nullptr;
-        bcu->finishedSendingTelegram(!(tx_error & TX_RETRY_ERROR));
+        if (iapBusy())
+        {
+            // the upper layers run from flash, notify them from loop()
+            finishedSendingSuccessful = !(tx_error & TX_RETRY_ERROR);
+            finishedSendingPending = true;
+        }
+        else
+        {
+            bcu->finishedSendingTelegram(!(tx_error & TX_RETRY_ERROR));
+        }
     }
 
     prepareForSending();
@@ -766,7 +797,7 @@ __attribute__((optimize("Os"))) void Bus::timerInterruptHandler()
 			if ( (!nextByteIndex) && (currentByte & PREAMBLE_MASK) )
 				rx_error |= RX_PREAMBLE_ERROR;// preamble error, continue to read bytes - possibility to discard the telegram at higher layer
 
-			if (nextByteIndex < bcu->maxTelegramSize())
+			if (nextByteIndex < maxTelegramLength)
 			{
 				rx_telegram[nextByteIndex++] = currentByte;
 				checksum ^= currentByte;
@@ -1089,7 +1120,7 @@ __attribute__((optimize("Os"))) void Bus::timerInterruptHandler()
 		if (timer.flag(captureChannel))
 		{
 			auto captureTime = timer.capture(captureChannel);
-			if ((captureTime % BIT_TIME) < (BIT_WAIT_TIME - 7))
+			if ((captureTime - bitTimes(captureTime) * BIT_TIME) < (BIT_WAIT_TIME - 7))
 			{
 				// Falling edge captured between a rising edge (reference time 0) and when a falling edge would be ok
 				// (up to 7us early and 33us late per KNX spec 2.1 chapter 3/2/2 section 1.2.2.8 figure 22 p.19).
@@ -1136,7 +1167,7 @@ __attribute__((optimize("Os"))) void Bus::timerInterruptHandler()
 				// Scale back bitMask to match the collided bit. pwmChannel is when we would have sent
 				// the next falling edge, captureChannel when we received it. The 33 is to account for
 				// slight timing differences and integer arithmetic.
-				auto collisionBitCount = (timer.match(pwmChannel) - captureTime + 33) / BIT_TIME;
+				auto collisionBitCount = bitTimes(timer.match(pwmChannel) - captureTime + 33);
 				bitMask >>= collisionBitCount + 1;
 
 				// Pretend that we also received a 0 bit last time, such that there is no need to set any
@@ -1310,6 +1341,12 @@ void Bus::loop()
         return;
     }
     */
+    if (finishedSendingPending)
+    {
+        finishedSendingPending = false;
+        bcu->finishedSendingTelegram(finishedSendingSuccessful);
+    }
+
     DB_TELEGRAM(dumpTelegrams());
 #if defined (DEBUG_BUS) || defined (DEBUG_BUS_BITLEVEL)
     debugBus();
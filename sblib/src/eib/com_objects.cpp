@@ -186,6 +186,8 @@
 #include <sblib/eib/property_types.h>
 #include <sblib/eib/bcu_base.h>
 #include <sblib/eib/bus.h>
+#include <sblib/timer.h>
+#include <string.h>
 
 #if defined(DUMP_COM_OBJ)
 #   include <sblib/serial.h>
@@ -208,8 +210,12 @@ ComObjects::ComObjects(BcuBase* bcuInstance) :
     le_ptr(BIG_ENDIAN),
     transmitting_object_no(INVALID_OBJECT_NUMBER),
     sendNextObjIndex(0),
-    nextUpdatedObjIndex(0)
+    nextUpdatedObjIndex(0),
+    sendPriorityLimit(COMCONF_PRIO_LOW)
 {
+    memset(pendingReadAddr, 0, sizeof(pendingReadAddr));
+    memset(pendingReadTime, 0, sizeof(pendingReadTime));
+    memset(startupBurst, 0, sizeof(startupBurst));
 }
 
 ComObjects::~ComObjects()
@@ -469,6 +475,13 @@ bool ComObjects::sendNextGroupTelegram()
              continue;  // no communication allowed or no grp-adr associated, next obj.
         }
 
+        // objects of the startup burst with a lower priority have to wait
+        bool inStartupBurst = (objno < MAX_STARTUP_BURST_OBJECTS) && (startupBurst[objno >> 3] & (1 << (objno & 7)));
+        if (inStartupBurst && ((config & COMCONF_PRIO_MASK) > sendPriorityLimit))
+        {
+            continue;
+        }
+
         // check ram-flags for read or write request
     	flags = flagsTab[objno >> 1];
         if (objno & 1)
@@ -480,19 +493,27 @@ bool ComObjects::sendNextGroupTelegram()
         {
             //app is triggering a object read or write request on the bus
             if (flags & COMFLAG_DATAREQ)
+            {
+                if (isGroupReadPending(addr))
+                {
+                    // a read request for this group address is already on its way, keep the request
+                    // of this object until the response completes it or the pending read times out
+                    continue;
+                }
             	// app triggered a read request on the bus - no further search for local objects belonging to the same group,
             	// they will be updated by the response to the read request
                 sendGroupReadTelegram(objno, addr);
+                addPendingGroupRead(addr);
+            }
             else
             	// app triggered a write request on the bus  and check for additional associations to Grp Addr for local writes
             	sendGroupWriteTelegram(objno, addr, false);
 
-            // we set the status to TRANSMITING (0x02), clear DATAREQ flag
-          	unsigned int mask = (COMFLAG_TRANS_MASK | COMFLAG_DATAREQ)  << (objno & 1 ? 4 :  0);
-            flagsTab[objno >> 1] &= ~mask;
-            mask = (COMFLAG_ERROR) << (objno & 1 ? 4 :  0);
-            flagsTab[objno >> 1] |= mask;
-
+            setObjectTransmitted(objno);
+            if (inStartupBurst)
+            {
+                startupBurst[objno >> 3] &= ~(1 << (objno & 7));
+            }
 
             sendNextObjIndex = objno + 1;
             return true;
@@ -503,6 +524,154 @@ bool ComObjects::sendNextGroupTelegram()
     return false;
 }
 
+void ComObjects::setSendPriorityLimit(int prio)
+{
+    sendPriorityLimit = prio & COMCONF_PRIO_MASK;
+    if (sendPriorityLimit == COMCONF_PRIO_LOW)
+    {
+        memset(startupBurst, 0, sizeof(startupBurst)); // nothing is held back anymore
+    }
+}
+
+void ComObjects::markStartupBurst()
+{
+    byte* flagsTab = objectFlagsTable();
+    if (flagsTab == nullptr)
+    {
+        return;
+    }
+
+    uint16_t numObjs = objectCount();
+    if (numObjs > MAX_STARTUP_BURST_OBJECTS)
+    {
+        numObjs = MAX_STARTUP_BURST_OBJECTS;
+    }
+
+    for (uint16_t objno = 0; objno < numObjs; ++objno)
+    {
+        uint8_t flags = flagsTab[objno >> 1];
+        if (objno & 1)
+        {
+            flags >>= 4;
+        }
+
+        if ((flags & COMFLAG_TRANSREQ) == COMFLAG_TRANSREQ)
+        {
+            startupBurst[objno >> 3] |= 1 << (objno & 7);
+        }
+    }
+}
+
+void ComObjects::setObjectTransmitted(int objno)
+{
+    byte* flagsTab = objectFlagsTable();
+    if (flagsTab == nullptr)
+    {
+        return;
+    }
+
+    // we set the status to TRANSMITING (0x02), clear DATAREQ flag
+    unsigned int mask = (COMFLAG_TRANS_MASK | COMFLAG_DATAREQ)  << (objno & 1 ? 4 :  0);
+    flagsTab[objno >> 1] &= ~mask;
+    mask = (COMFLAG_ERROR) << (objno & 1 ? 4 :  0);
+    flagsTab[objno >> 1] |= mask;
+}
+
+bool ComObjects::isGroupReadPending(uint16_t addr)
+{
+    for (int i = 0; i < MAX_PENDING_GROUP_READS; ++i)
+    {
+        if (pendingReadAddr[i] == 0)
+        {
+            continue;
+        }
+
+        if (elapsed(pendingReadTime[i]) >= PENDING_GROUP_READ_TIMEOUT_MS)
+        {
+            pendingReadAddr[i] = 0; // no response received in time, forget it
+            continue;
+        }
+
+        if (pendingReadAddr[i] == addr)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ComObjects::addPendingGroupRead(uint16_t addr)
+{
+    // reuse a free slot, if all are in use replace the oldest one
+    int slot = 0;
+    for (int i = 0; i < MAX_PENDING_GROUP_READS; ++i)
+    {
+        if (pendingReadAddr[i] == 0)
+        {
+            slot = i;
+            break;
+        }
+        if (elapsed(pendingReadTime[i]) > elapsed(pendingReadTime[slot]))
+        {
+            slot = i;
+        }
+    }
+    pendingReadAddr[slot] = addr;
+    pendingReadTime[slot] = millis();
+}
+
+void ComObjects::removePendingGroupRead(uint16_t addr)
+{
+    bool wasPending = false;
+    for (int i = 0; i < MAX_PENDING_GROUP_READS; ++i)
+    {
+        if (pendingReadAddr[i] == addr)
+        {
+            pendingReadAddr[i] = 0;
+            wasPending = true;
+        }
+    }
+
+    if (wasPending)
+    {
+        completeGroupReads(addr);
+    }
+}
+
+void ComObjects::completeGroupReads(uint16_t addr)
+{
+    byte* flagsTab = objectFlagsTable();
+    if (flagsTab == nullptr)
+    {
+        return;
+    }
+
+    uint16_t numObjs = objectCount();
+    for (uint16_t objno = 0; objno < numObjs; ++objno)
+    {
+        uint8_t flags = flagsTab[objno >> 1];
+        if (objno & 1)
+        {
+            flags >>= 4;
+        }
+
+        if (((flags & COMFLAG_TRANSREQ) != COMFLAG_TRANSREQ) || !(flags & COMFLAG_DATAREQ))
+        {
+            continue;
+        }
+
+        if (firstObjectAddr(objno) != addr)
+        {
+            continue;
+        }
+
+        // the response updated the value, the read request of this object is done
+        d(serial.println(" read completed by response obj: ", objno, DEC);)
+        unsigned int mask = (COMFLAG_TRANS_MASK | COMFLAG_DATAREQ) << (objno & 1 ? 4 : 0);
+        flagsTab[objno >> 1] &= ~mask;
+    }
+}
+
 int ComObjects::nextUpdatedObject()
 {
     byte* flagsTab = objectFlagsTable();
@@ -145,6 +145,17 @@ byte* ComObjectsBCU1::objectConfigTable() // stored in eeprom
     return ((BcuDefault*)bcu)->userMemoryPtr(commsTabPtr);
 }
 
+int ComObjectsBCU1::objectConfigTableSize()
+{
+    const byte* configTab = objectConfigTable();
+    if (configTab == nullptr)
+    {
+        return 0;
+    }
+    // number of objects, RAM flags table pointer, configs of the objects
+    return 1 + sizeof(ComConfigBCU1::DataPtrType) + (*configTab) * sizeof(ComConfigBCU1);
+}
+
 byte* ComObjectsBCU1::objectFlagsTable() // stored in RAM
 {
     uint8_t* objCfgTablePtr = objectConfigTable();
@@ -30,6 +30,17 @@ byte* ComObjectsBCU2::objectConfigTable()
     return ((BcuDefault*)bcu)->userMemoryPtr(comObjTableAddr);
 }
 
+int ComObjectsBCU2::objectConfigTableSize()
+{
+    const byte* configTab = objectConfigTable();
+    if (configTab == nullptr)
+    {
+        return 0;
+    }
+    // number of objects, RAM flags table pointer, configs of the objects
+    return 1 + sizeof(ComConfigBCU2::DataPtrType) + (*configTab) * sizeof(ComConfigBCU2);
+}
+
 byte* ComObjectsBCU2::objectFlagsTable()
 {
     const byte* configTable = objectConfigTable();
@@ -102,6 +102,17 @@ byte* ComObjectsSYSTEMB::objectConfigTable()
     return ((BcuDefault*)bcu)->userMemoryPtr (makeWord (*(addr + 1), * addr));
 }
 
+int ComObjectsSYSTEMB::objectConfigTableSize()
+{
+    const byte* configTab = objectConfigTable();
+    if (configTab == nullptr)
+    {
+        return 0;
+    }
+    // the config of object n starts at 2 + (n - 1) * sizeof(ComConfigSYSTEMB), see objectConfig()
+    return 2 + (*configTab) * sizeof(ComConfigSYSTEMB);
+}
+
 byte* ComObjectsSYSTEMB::objectFlagsTable()
 {
     const byte* configTable = objectConfigTable();
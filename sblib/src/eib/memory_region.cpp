@@ -0,0 +1,92 @@
+/*
+ *  memory_region.cpp - Address ranges which are accessible by memory read and write telegrams.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include <sblib/eib/memory_region.h>
+#include <sblib/eib/userEeprom.h>
+#include <sblib/eib/userRam.h>
+#include <string.h>
+
+uint32_t UserEepromRegion::startAddr() const
+{
+    return userEeprom->startAddr();
+}
+
+uint32_t UserEepromRegion::endAddr() const
+{
+    return userEeprom->endAddr();
+}
+
+bool UserEepromRegion::read(uint32_t address, byte* data, uint32_t length)
+{
+    memcpy(data, &(*userEeprom)[address], length);
+    return true;
+}
+
+bool UserEepromRegion::write(uint32_t address, byte* data, uint32_t length)
+{
+    memcpy(&(*userEeprom)[address], data, length);
+    userEeprom->modified(address, length);
+    return true;
+}
+
+uint32_t UserRamRegion::startAddr() const
+{
+    return userRam->startAddr();
+}
+
+uint32_t UserRamRegion::endAddr() const
+{
+    return userRam->endAddr();
+}
+
+bool UserRamRegion::read(uint32_t address, byte* data, uint32_t length)
+{
+    userRam->cpyFromUserRam(address, data, length);
+    return true;
+}
+
+bool UserRamRegion::write(uint32_t address, byte* data, uint32_t length)
+{
+    userRam->cpyToUserRam(address, data, length);
+    return true;
+}
+
+uint32_t UserRamStatusRegion::startAddr() const
+{
+    if (userRam->inRange(userRam->statusAddr()))
+    {
+        return userRam->statusAddr() + 1; // empty, handled by the user RAM region
+    }
+    return userRam->statusAddr();
+}
+
+uint32_t UserRamStatusRegion::endAddr() const
+{
+    return userRam->statusAddr();
+}
+
+bool UserRamStatusRegion::read(uint32_t address, byte* data, uint32_t length)
+{
+    // the status is only accessible as a single byte
+    if (length != 1)
+    {
+        return false;
+    }
+    userRam->cpyFromUserRam(address, data, 1);
+    return true;
+}
+
+bool UserRamStatusRegion::write(uint32_t address, byte* data, uint32_t length)
+{
+    if (length != 1)
+    {
+        return false;
+    }
+    userRam->cpyToUserRam(address, data, 1);
+    return true;
+}
@@ -25,6 +25,22 @@
 // see KNX 6/6 Profiles, p. 94+
 // see KNX 3/7/3 Standardized Identifier Tables, p. 11+
 
+constexpr PropertyDef PropertiesBCU2::deviceObjectProps[];
+constexpr PropertyDef PropertiesBCU2::addrTabObjectProps[];
+constexpr PropertyDef PropertiesBCU2::assocTabObjectProps[];
+constexpr PropertyDef PropertiesBCU2::appObjectProps[];
+constexpr PropertyDef PropertiesBCU2::interfaceObjectProps[];
+constexpr PropertyDef PropertiesBCU2::knxAssocTabObjectProps[];
+constexpr const PropertyDef* PropertiesBCU2::propertiesTabInstance[];
+constexpr byte PropertiesBCU2::propertiesTabLengthInstance[];
+constexpr byte PropertiesBCU2::deviceObjectPropsById[];
+constexpr byte PropertiesBCU2::addrTabObjectPropsById[];
+constexpr byte PropertiesBCU2::assocTabObjectPropsById[];
+constexpr byte PropertiesBCU2::appObjectPropsById[];
+constexpr byte PropertiesBCU2::interfaceObjectPropsById[];
+constexpr byte PropertiesBCU2::knxAssocTabObjectPropsById[];
+constexpr const byte* PropertiesBCU2::propertiesTabIndexInstance[];
+
 const PropertyDef* PropertiesBCU2::findProperty(PropertyID propertyId, const PropertyDef* table)
 {
     const PropertyDef* defFound = nullptr;
@@ -46,6 +62,28 @@ const PropertyDef* PropertiesBCU2::findProperty(PropertyID propertyId, const Pro
     return defFound;
 }
 
+const PropertyDef* PropertiesBCU2::findProperty(PropertyID propertyId, const PropertyDef* table, const byte* index, int count)
+{
+    int low = 0;
+    int high = count - 1;
+
+    while (low <= high)
+    {
+        int mid = (low + high) >> 1;
+        const PropertyDef* def = &table[index[mid]];
+        if (def->id == propertyId)
+            return def;
+
+        if (def->id < propertyId)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+
+    DB_PROPERTIES(serial.print("findProperty: "); printObjectIdx(table->id); serial.print(" "); printPropertyID(propertyId); serial.println(" not implemented"););
+    return nullptr;
+}
+
 /**
  * Get a property definition of an interface object.
  *
@@ -61,7 +99,7 @@ const PropertyDef* PropertiesBCU2::propertyDef(int objectIdx, PropertyID propert
         DB_PROPERTIES(serial.print("propertyDef: ");printObjectIdx(objectIdx); serial.println(" not implemented!"););
         return nullptr;
     }
-    return findProperty(propertyId, propertiesTab()[objectIdx]);
+    return findProperty(propertyId, propertiesTab()[objectIdx], propertiesTabIndex()[objectIdx], propertiesTabLength()[objectIdx]);
 }
 
 /**
@@ -96,6 +134,7 @@ LoadState PropertiesBCU2::handleLoadStateMachine(const int objectIdx, const byte
         case LC_LOAD_COMPLETED: // Load completed
         {
             newLoadState =  LS_LOADED; // reply: Loaded
+            bcu->tablesChanged();
             break;
         }
         case LC_ADDITIONAL_LOAD_CONTROLS: // Load data: handled below
@@ -604,6 +643,25 @@ int PropertiesBCU2::loadProperty(int objectIdx, const byte* data, int len)
     return LS_LOADING;
 }
 
+int PropertiesBCU2::maxPropertyValueLength() const
+{
+    // Only standard frames are sent. Their length nibble limits the APDU to 15 bytes,
+    // 5 of them are used by the APCI, object index, property ID, count and start index
+    return 10;
+}
+
+byte* PropertiesBCU2::valueElements(int objectIdx, const PropertyDef* def, int& numElems)
+{
+    if (objectIdx == OT_ADDR_TABLE && def->id == PID_TABLE)
+        return (byte*) bcu->addrTables->groupAddresses(numElems);
+
+    byte* valuePtr = def->valuePointer(bcu);
+    if ((def->control & PC_ARRAY_POINTER) == PC_ARRAY_POINTER)
+        numElems = *valuePtr;
+    else numElems = 1;
+    return valuePtr;
+}
+
 bool PropertiesBCU2::propertyValueReadTelegram(int objectIdx, PropertyID propertyId, int count, int start, uint8_t * sendBuffer)
 {
     DB_PROPERTIES(serial.print("propertyValueReadTelegram: "); printObjectIdx(objectIdx); serial.print(" "); printPropertyID(propertyId);serial.println(););
@@ -611,16 +669,18 @@ bool PropertiesBCU2::propertyValueReadTelegram(int objectIdx, PropertyID propert
     if (!def) return false; // not found
 
     PropertyDataType type = (PropertyDataType) (def->control & PC_TYPE_MASK);
-    byte* valuePtr = def->valuePointer(bcu);
+    int numElems;
+    byte* valuePtr = valueElements(objectIdx, def, numElems);
 
+    if (start < 1 || start - 1 + count > numElems) return false; // elements out of range
     --start;
     int size = def->size();
     int len = count * size;
-    if(len > 10) return false; // length error
+    if (len > maxPropertyValueLength()) return false; // length error
 
     if (type < PDT_CHAR_BLOCK)
     {
-        reverseCopy(sendBuffer + 12, valuePtr + start * size, len);
+        reverseCopyElements(sendBuffer + 12, valuePtr + start * size, count, size);
     }
     else
     {
@@ -645,7 +705,8 @@ bool PropertiesBCU2::propertyValueWriteTelegram(int objectIdx, PropertyID proper
     }
 
     PropertyDataType type = def->type();
-    byte* valuePtr = def->valuePointer(bcu);
+    int numElems;
+    byte* valuePtr = valueElements(objectIdx, def, numElems);
 
     const byte* data = bcu->bus->telegram + 12;
     int state, len;
@@ -660,14 +721,18 @@ bool PropertiesBCU2::propertyValueWriteTelegram(int objectIdx, PropertyID proper
     }
     else
     {
+        if (start < 1 || start - 1 + count > numElems)
+            return false; // elements out of range
         --start;
         int size = def->size();
         len = count * size;
         DB_PROPERTIES(serial.print("propertyValueWriteTelegram: "); printObjectIdx(objectIdx); serial.print(" "); printPropertyID(propertyId);serial.println(););
-        reverseCopy(valuePtr + start * size, data, len);
-        reverseCopy(sendBuffer + 12, valuePtr + start * size, len);
+        if (len > maxPropertyValueLength())
+            return false; // length error
+        reverseCopyElements(valuePtr + start * size, data, count, size);
+        reverseCopyElements(sendBuffer + 12, valuePtr + start * size, count, size);
         if (def->isEepromPointer())
-            bcu->userEeprom->modified(true);
+            bcu->userEeprom->modified(valuePtr + start * size, len);
     }
 
     sendBuffer[5] += len;
@@ -695,9 +760,7 @@ bool PropertiesBCU2::propertyDescReadTelegram(int objectIdx, PropertyID property
     }
 
     int numElems;
-    if ((def->control & PC_ARRAY_POINTER) == PC_ARRAY_POINTER)
-        numElems = *def->valuePointer(bcu);
-    else numElems = 1;
+    valueElements(objectIdx, def, numElems);
 
     sendBuffer[9] = def->id;
     sendBuffer[11] = def->control & (PC_TYPE_MASK | PC_WRITABLE);
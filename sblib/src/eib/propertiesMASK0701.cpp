@@ -18,6 +18,22 @@
 
 #include <sblib/eib/mask0701.h>
 
+constexpr PropertyDef PropertiesMASK0701::deviceObjectProps[];
+constexpr PropertyDef PropertiesMASK0701::addrTabObjectProps[];
+constexpr PropertyDef PropertiesMASK0701::assocTabObjectProps[];
+constexpr PropertyDef PropertiesMASK0701::appObjectProps[];
+constexpr PropertyDef PropertiesMASK0701::interfaceObjectProps[];
+constexpr PropertyDef PropertiesMASK0701::knxAssocTabObjectProps[];
+constexpr const PropertyDef* PropertiesMASK0701::propertiesTabInstance[];
+constexpr byte PropertiesMASK0701::propertiesTabLengthInstance[];
+constexpr byte PropertiesMASK0701::deviceObjectPropsById[];
+constexpr byte PropertiesMASK0701::addrTabObjectPropsById[];
+constexpr byte PropertiesMASK0701::assocTabObjectPropsById[];
+constexpr byte PropertiesMASK0701::appObjectPropsById[];
+constexpr byte PropertiesMASK0701::interfaceObjectPropsById[];
+constexpr byte PropertiesMASK0701::knxAssocTabObjectPropsById[];
+constexpr const byte* PropertiesMASK0701::propertiesTabIndexInstance[];
+
 /**
  * NOT IMPLEMENTED!
  * should handle Additional Load Control: LoadEvent: AllocAbsDataSeg (segment type 0) <LdCtrlAbsSegment>
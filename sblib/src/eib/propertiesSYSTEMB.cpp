@@ -311,8 +311,10 @@ bool PropertiesSYSTEMB::propertyValueReadTelegram(int objectIdx, PropertyID prop
     if (!def) return false; // not found
 
     PropertyDataType type = (PropertyDataType) (def->control & PC_TYPE_MASK);
-    byte* valuePtr = def->valuePointer(bcu);
+    int numElems;
+    byte* valuePtr = valueElements(objectIdx, def, numElems);
 
+    if (start < 1 || start - 1 + count > numElems) return false; // elements out of range
     --start;
     int size = def->size();
     int len = count * size;
@@ -324,11 +326,11 @@ bool PropertiesSYSTEMB::propertyValueReadTelegram(int objectIdx, PropertyID prop
         {
             sendBuffer[12] = 0;
             sendBuffer[13] = 0;
-            reverseCopy(sendBuffer + 14, valuePtr + start * size, len);
+            reverseCopyElements(sendBuffer + 14, valuePtr + start * size, count, size);
             len += 2;
         }
         else
-            reverseCopy(sendBuffer + 12, valuePtr + start * size, len);
+            reverseCopyElements(sendBuffer + 12, valuePtr + start * size, count, size);
     }
     else memcpy(sendBuffer + 12, valuePtr + start * size, len);
 
@@ -350,7 +352,8 @@ bool PropertiesSYSTEMB::propertyValueWriteTelegram(int objectIdx, PropertyID pro
     }
 
     PropertyDataType type = def->type();
-    byte* valuePtr = def->valuePointer(bcu);
+    int numElems;
+    byte* valuePtr = valueElements(objectIdx, def, numElems);
 
     const byte* data = bcu->bus->telegram + 12;
     int state, len;
@@ -365,6 +368,8 @@ bool PropertiesSYSTEMB::propertyValueWriteTelegram(int objectIdx, PropertyID pro
     }
     else
     {
+        if (start < 1 || start - 1 + count > numElems)
+            return false; // elements out of range
         --start;
         int size = def->size();
         len = count * size;
@@ -376,11 +381,11 @@ bool PropertiesSYSTEMB::propertyValueWriteTelegram(int objectIdx, PropertyID pro
         }
         else
         {
-            reverseCopy(valuePtr + start * size, data, len);
-            reverseCopy(sendBuffer + 12, valuePtr + start * size, len);
+            reverseCopyElements(valuePtr + start * size, data, count, size);
+            reverseCopyElements(sendBuffer + 12, valuePtr + start * size, count, size);
         }
         if (def->isEepromPointer())
-            bcu->userEeprom->modified(true);
+            bcu->userEeprom->modified(valuePtr + start * size, len);
     }
 
     sendBuffer[5] += len;
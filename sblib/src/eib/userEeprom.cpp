@@ -9,6 +9,7 @@
 #include <sblib/internal/iap.h>
 #include <sblib/eib/bcu_base.h>
 #include <sblib/eib/bus.h>
+#include <sblib/utils.h>
 #include <cstring>
 
 uint32_t UserEeprom::flashSize() const
@@ -31,14 +32,199 @@ byte* UserEeprom::flashSectorAddress() const
 	return (FLASH_BASE_ADDRESS + iapFlashSize() - FLASH_SECTOR_SIZE);
 }
 
-byte* UserEeprom::findValidPage()
+// Buffer for programming one flash page, iapProgram() needs a word aligned source
+static byte flashPageBuffer[FLASH_PAGE_SIZE] __attribute__ ((aligned (FLASH_RAM_BUFFER_ALIGNMENT)));
+
+static unsigned int getLE16(const byte* data)
+{
+    return data[0] | (data[1] << 8);
+}
+
+static void putLE16(byte* data, unsigned int value)
+{
+    data[0] = value;
+    data[1] = value >> 8;
+}
+
+static unsigned int getLE32(const byte* data)
+{
+    return getLE16(data) | (getLE16(data + 2) << 16);
+}
+
+static void putLE32(byte* data, unsigned int value)
+{
+    putLE16(data, value);
+    putLE16(data + 2, value >> 16);
+}
+
+static bool isErased(const byte* data, unsigned int length)
+{
+    for (; length > 0; --length)
+    {
+        if (*data++ != 0xff)
+            return false;
+    }
+    return true;
+}
+
+// Sector header of both layouts: magic, size of the user EEPROM, CRC of both
+static bool isSectorHeaderValid(const byte* header, uint32_t magic, unsigned int size)
+{
+    return getLE32(header) == magic && getLE16(header + 4) == size &&
+           getLE16(header + 6) == crc16Ccitt(header, 6);
+}
+
+static void putSectorHeader(byte* header, uint32_t magic, unsigned int size)
+{
+    putLE32(header, magic);
+    putLE16(header + 4, size);
+    putLE16(header + 6, crc16Ccitt(header, 6));
+}
+
+unsigned int UserEeprom::numImagePages() const
+{
+    return (size() + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+}
+
+unsigned int UserEeprom::imagePageLength(unsigned int page) const
+{
+    unsigned int length = size() - page * FLASH_PAGE_SIZE;
+    return (length > FLASH_PAGE_SIZE) ? FLASH_PAGE_SIZE : length;
+}
+
+unsigned int UserEeprom::numSlots() const
+{
+    return FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE - 1;
+}
+
+byte* UserEeprom::slotAddress(unsigned int slot) const
+{
+    return flashSectorAddress() + slot * FLASH_PAGE_SIZE;
+}
+
+bool UserEeprom::isTableEntryValid(const byte* entry, unsigned int following) const
+{
+    unsigned int slot = entry[0];
+    unsigned int page = entry[1];
+
+    return getLE16(entry + 6) == crc16Ccitt(entry, 6) && entry[2] == following &&
+           slot >= 1 && slot <= numSlots() && page < numImagePages();
+}
+
+bool UserEeprom::isSlotValid(const byte* entry) const
+{
+    return getLE16(entry + 4) == crc16Ccitt(slotAddress(entry[0]), imagePageLength(entry[1]));
+}
+
+bool UserEeprom::readTable()
+{
+    const byte* table = flashSectorAddress();
+
+    tableWritePos = 0;
+    nextFreeSlot = 0; // unknown, the next flush erases the sector
+    if (!isSectorHeaderValid(table, USER_EEPROM_TABLE_MAGIC, size()))
+        return false;
+
+    // The entries are appended, behind the last one the table is erased
+    unsigned int end = USER_EEPROM_TABLE_HEADER_SIZE;
+    unsigned int freeSlot = 1;
+    while (end + USER_EEPROM_TABLE_ENTRY_SIZE <= FLASH_PAGE_SIZE && !isErased(table + end, USER_EEPROM_TABLE_ENTRY_SIZE))
+    {
+        if (table[end] <= numSlots() && table[end] >= freeSlot)
+            freeSlot = table[end] + 1;
+        end += USER_EEPROM_TABLE_ENTRY_SIZE;
+    }
+
+    // An interrupted flush may have programmed the slots behind the used ones
+    while (freeSlot <= numSlots() && !isErased(slotAddress(freeSlot), FLASH_PAGE_SIZE))
+        ++freeSlot;
+
+    // Find the flushes. The entries of a flush are only used if all of them are valid.
+    byte flushStart[(FLASH_PAGE_SIZE - USER_EEPROM_TABLE_HEADER_SIZE) / USER_EEPROM_TABLE_ENTRY_SIZE];
+    unsigned int numFlushes = 0;
+    unsigned int pos = USER_EEPROM_TABLE_HEADER_SIZE;
+    unsigned int validEnd = end;
+    while (pos < end)
+    {
+        unsigned int count = table[pos + 2] + 1;
+        unsigned int valid = 0;
+        while (valid < count && pos + (valid + 1) * USER_EEPROM_TABLE_ENTRY_SIZE <= end &&
+               isTableEntryValid(table + pos + valid * USER_EEPROM_TABLE_ENTRY_SIZE, count - 1 - valid))
+        {
+            ++valid;
+        }
+
+        if (valid < count)
+        {
+            // Invalid entry, e.g. from an interrupted flush. Ignore it and all following entries,
+            // the next flush erases the sector.
+            validEnd = pos;
+            end = FLASH_PAGE_SIZE;
+            break;
+        }
+
+        flushStart[numFlushes++] = pos;
+        pos += count * USER_EEPROM_TABLE_ENTRY_SIZE;
+    }
+
+    // Apply the newest entry of each page, newest flush first. Older entries of a page are
+    // superseded, the CRC of their slots is not calculated.
+    memset(pageSlots, 0, numImagePages());
+    unsigned int missingPages = numImagePages();
+    while (numFlushes > 0 && missingPages > 0)
+    {
+        pos = flushStart[--numFlushes];
+        for (; pos < validEnd; pos += USER_EEPROM_TABLE_ENTRY_SIZE)
+        {
+            const byte* entry = table + pos;
+            if (pageSlots[entry[1]])
+                continue;
+
+            if (!isSlotValid(entry))
+            {
+                // The pages of this flush are not valid together, use the flushes in front of it.
+                // The next flush erases the sector.
+                memset(pageSlots, 0, numImagePages());
+                missingPages = numImagePages();
+                end = FLASH_PAGE_SIZE;
+                break;
+            }
+
+            pageSlots[entry[1]] = entry[0];
+            --missingPages;
+        }
+        validEnd = flushStart[numFlushes];
+    }
+
+    for (unsigned int page = 0; page < numImagePages(); ++page)
+    {
+        if (!pageSlots[page])
+            return false;
+        memcpy(userEepromData + page * FLASH_PAGE_SIZE, slotAddress(pageSlots[page]), imagePageLength(page));
+    }
+
+    tableWritePos = end;
+    nextFreeSlot = freeSlot;
+    return true;
+}
+
+byte* UserEeprom::findLegacyPage() const
 {
-    byte* firstPage = FLASH_BASE_ADDRESS + iapFlashSize() - FLASH_SECTOR_SIZE;
+    byte* firstPage = flashSectorAddress();
     byte* page = lastEepromPage();
 
+    // Layout of older versions: slots of flashSize() bytes, the last byte of a used slot is 0.
+    // The first slot is programmed first after an erase. A sector with an erased first page or a
+    // header of the other layouts holds the slots of an interrupted flush, not the older layout.
+    if (firstPage[size() - 1] == 0xff || isErased(firstPage, FLASH_PAGE_SIZE) ||
+        getLE32(firstPage) == USER_EEPROM_TABLE_MAGIC || getLE32(firstPage) == USER_EEPROM_LOG_MAGIC)
+    {
+        return nullptr;
+    }
+
     while (page >= firstPage)
     {
-        if (page[size() - 1] != 0xff)  ///\todo check more then  only one byte for 0xff (empty flash)
+        if (page[size() - 1] != 0xff)
             return page;
 
         page -= userEepromFlashSize;
@@ -49,72 +235,510 @@ byte* UserEeprom::findValidPage()
 
 void UserEeprom::readUserEeprom()
 {
-    byte* page = findValidPage();
+    committedCrcValid = true;
+    if (!readLog() && !readTable())
+    {
+        // No valid layout. Try the layout of older versions, the next flush converts it.
+        byte* page = findLegacyPage();
 
-    if (page)
-        memcpy(userEepromData, page, size());
-    else
-        memset(userEepromData, 0, size()); ///\todo should filling with zeros indicate a readError? if yes, then it should be somewhere reported
+        if (page)
+            memcpy(userEepromData, page, size());
+        else
+        {
+            memset(userEepromData, 0, size()); ///\todo should filling with zeros indicate a readError? if yes, then it should be somewhere reported
+            committedCrcValid = false;
+        }
+    }
 
+    committedCrc = crc16Ccitt(userEepromData, size());
     modified(false);
 }
 
 void UserEeprom::writeUserEeprom()
 {
-    if (!isModified())
+    // Finish a running incremental flush, then flush all remaining modifications
+    while (isFlushing() || isModified())
+    {
+        if (!isFlushing())
+            startFlush();
+        flushStep();
+    }
+}
+
+bool UserEeprom::isFlushing() const
+{
+    return flushState != FLUSH_IDLE;
+}
+
+void UserEeprom::startFlush()
+{
+    if (isFlushing() || !isModified())
     {
         return;
     }
 
-    noInterrupts();
+    // Modifications from now on restart the flush, see flushStep()
+    flushPages = modifiedPages;
+    modified(false);
+    modifiedWhileFlushing = false;
+
+    // Skip the flush if the content did not change since the last flush.
+    // The CRC is only a fast check, the flash content has the final say.
+    flushCrc = crc16Ccitt(userEepromData, size());
+    if (committedCrcValid && flushCrc == committedCrc && isFlashContentEqual())
+    {
+        ++avoidedWrites;
+        return;
+    }
 
-    byte* page = findValidPage();
-    if (page == lastEepromPage())
+    if (logStructured)
     {
-        page = flashSectorAddress();
+        flushSlot = flashSectorAddress();
+        if (logOnFlash && logWritePos >= logStart())
+            flushState = FLUSH_APPEND;
+        else
+            flushState = FLUSH_ERASE;
+        return;
     }
-    else if (page)
-        page += userEepromFlashSize;
-    else{
-    	page = flashSectorAddress();
+
+    if (logOnFlash || nextFreeSlot == 0)
+    {
+        flushState = FLUSH_ERASE; // the free slots are not known
+        return;
     }
 
-    if (page == flashSectorAddress())
+    unsigned int entryPos = tableWritePos;
+    if (entryPos == 0)
     {
-        // Erase the sector
-        int sectorId = iapSectorOfAddress(page);
-        IAP_Status rc = iapEraseSector(sectorId);
-        if (rc != IAP_SUCCESS)
+        // The sector was erased by a restarted flush, the page table is still empty
+        flushPages = (1u << numImagePages()) - 1;
+        entryPos = USER_EEPROM_TABLE_HEADER_SIZE;
+    }
+    else
+    {
+        // Write the modified pages which differ from their current slot into the slots behind the used ones.
+        // The other pages stay in their slots.
+        for (unsigned int page = 0; page < numImagePages(); ++page)
+        {
+            if (memcmp(slotAddress(pageSlots[page]), userEepromData + page * FLASH_PAGE_SIZE, imagePageLength(page)) == 0)
+                flushPages &= ~(1u << page);
+        }
+    }
+
+    unsigned int count = __builtin_popcount(flushPages);
+    flushPos = 0;
+    flushFirstSlot = nextFreeSlot;
+    if (count == 0)
+        flushFinished(); // only pages which are not marked as modified changed
+    else if (nextFreeSlot + count > numSlots() + 1 ||
+             entryPos + count * USER_EEPROM_TABLE_ENTRY_SIZE > FLASH_PAGE_SIZE)
+    {
+        flushState = FLUSH_ERASE; // not enough free slots or table entries, write all pages again
+    }
+    else
+        flushState = FLUSH_PROGRAM;
+}
+
+bool UserEeprom::flushStep()
+{
+    if (modifiedWhileFlushing && isFlushing())
+    {
+        // The data is copied to the flash step by step. Start again, so that the flush
+        // writes the content of one point in time. Uncommitted slots and records are not used.
+        modifiedPages |= flushPages;
+        userEepromModified = true;
+        flushState = FLUSH_IDLE;
+        startFlush();
+        return !isFlushing();
+    }
+
+    switch (flushState)
+    {
+    case FLUSH_ERASE:
+        if (iapEraseSector(iapSectorOfAddress(flashSectorAddress())) != IAP_SUCCESS)
         {
             fatalError(); // erasing failed
         }
+
+        logOnFlash = false;
+        logWritePos = 0;
+        tableWritePos = 0;
+        nextFreeSlot = 0;
+
+        if (logStructured)
+        {
+            // The new base image contains all modifications.
+            // It is programmed backwards, the page with the sector header is the last one.
+            flushPages = 0;
+            flushPos = logStart() - FLASH_PAGE_SIZE;
+            flushState = (flushPos == 0) ? FLUSH_COMMIT : FLUSH_PROGRAM;
+        }
+        else
+        {
+            // All pages are written again
+            nextFreeSlot = 1;
+            flushPages = (1u << numImagePages()) - 1;
+            flushPos = 0;
+            flushFirstSlot = nextFreeSlot;
+            flushState = FLUSH_PROGRAM;
+        }
+        return false;
+
+    case FLUSH_PROGRAM:
+        if (logStructured)
+        {
+            programFlushPage();
+            flushPos -= FLASH_PAGE_SIZE;
+            if (flushPos == 0)
+                flushState = FLUSH_COMMIT;
+        }
+        else
+        {
+            programSlot();
+            if (!(flushPages >> flushPos))
+                flushState = FLUSH_COMMIT;
+        }
+        return false;
+
+    case FLUSH_COMMIT:
+        if (logStructured)
+        {
+            programFlushPage();
+            logOnFlash = true;
+            logWritePos = logStart();
+        }
+        else
+            commitTable();
+        flushFinished();
+        return true;
+
+    case FLUSH_APPEND:
+        return appendLogRecords();
+
+    default:
+        return true;
+    }
+}
+
+void UserEeprom::flushFinished()
+{
+    committedCrc = flushCrc;
+    committedCrcValid = true;
+    flushState = FLUSH_IDLE;
+}
+
+bool UserEeprom::isFlashContentEqual() const
+{
+    if (!logOnFlash)
+    {
+        if (tableWritePos == 0)
+            return false;
+
+        for (unsigned int page = 0; page < numImagePages(); ++page)
+        {
+            if (memcmp(slotAddress(pageSlots[page]), userEepromData + page * FLASH_PAGE_SIZE, imagePageLength(page)) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    const byte* base = flashSectorAddress() + USER_EEPROM_LOG_HEADER_SIZE;
+    for (unsigned int chunk = 0; chunk < size(); chunk += FLASH_PAGE_SIZE)
+    {
+        unsigned int chunkSize = size() - chunk;
+        if (chunkSize > FLASH_PAGE_SIZE)
+            chunkSize = FLASH_PAGE_SIZE;
+
+        memcpy(flashPageBuffer, base + chunk, chunkSize);
+        replayLog(chunk, chunkSize, flashPageBuffer);
+        if (memcmp(flashPageBuffer, userEepromData + chunk, chunkSize) != 0)
+            return false;
+    }
+    return true;
+}
+
+unsigned int UserEeprom::avoidedWriteCount() const
+{
+    return avoidedWrites;
+}
+
+void UserEeprom::programFlushPage()
+{
+    // Position of the user EEPROM in the base image
+    unsigned int start = flushPos;
+
+    memset(flashPageBuffer, 0xff, FLASH_PAGE_SIZE);
+
+    if (start < USER_EEPROM_LOG_HEADER_SIZE)
+    {
+        putSectorHeader(flashPageBuffer, USER_EEPROM_LOG_MAGIC, size());
+        start = USER_EEPROM_LOG_HEADER_SIZE;
+    }
+
+    unsigned int end = flushPos + FLASH_PAGE_SIZE;
+    if (end > USER_EEPROM_LOG_HEADER_SIZE + size())
+        end = USER_EEPROM_LOG_HEADER_SIZE + size();
+
+    if (start < end)
+        memcpy(flashPageBuffer + start - flushPos, userEepromData + start - USER_EEPROM_LOG_HEADER_SIZE, end - start);
+
+    if (iapProgram(flushSlot + flushPos, flashPageBuffer, FLASH_PAGE_SIZE) != IAP_SUCCESS)
+    {
+        fatalError(); // flashing failed
+    }
+}
+
+void UserEeprom::programSlot()
+{
+    unsigned int page = flushPos + __builtin_ctz(flushPages >> flushPos);
+    unsigned int length = imagePageLength(page);
+
+    memset(flashPageBuffer + length, 0xff, FLASH_PAGE_SIZE - length);
+    memcpy(flashPageBuffer, userEepromData + page * FLASH_PAGE_SIZE, length);
+
+    if (iapProgram(slotAddress(nextFreeSlot), flashPageBuffer, FLASH_PAGE_SIZE) != IAP_SUCCESS)
+    {
+        fatalError(); // flashing failed
+    }
+
+    ++nextFreeSlot;
+    flushPos = page + 1;
+}
+
+void UserEeprom::commitTable()
+{
+    byte* table = flashSectorAddress();
+    unsigned int count = __builtin_popcount(flushPages);
+
+    // The table may already contain entries. They are programmed again with the same content.
+    memcpy(flashPageBuffer, table, FLASH_PAGE_SIZE);
+    if (tableWritePos == 0)
+    {
+        putSectorHeader(flashPageBuffer, USER_EEPROM_TABLE_MAGIC, size());
+        tableWritePos = USER_EEPROM_TABLE_HEADER_SIZE;
+    }
+
+    byte* entry = flashPageBuffer + tableWritePos;
+    unsigned int slot = flushFirstSlot;
+    for (unsigned int page = 0; count > 0; ++page)
+    {
+        if (!(flushPages & (1u << page)))
+            continue;
+
+        entry[0] = slot;
+        entry[1] = page;
+        entry[2] = --count;
+        entry[3] = 0;
+        putLE16(entry + 4, crc16Ccitt(slotAddress(slot), imagePageLength(page)));
+        putLE16(entry + 6, crc16Ccitt(entry, 6));
+        entry += USER_EEPROM_TABLE_ENTRY_SIZE;
+        ++slot;
+    }
+
+    if (iapProgram(table, flashPageBuffer, FLASH_PAGE_SIZE) != IAP_SUCCESS)
+    {
+        fatalError(); // flashing failed
+    }
+
+    // The new slots are valid now
+    unsigned int end = entry - flashPageBuffer;
+    for (; tableWritePos < end; tableWritePos += USER_EEPROM_TABLE_ENTRY_SIZE)
+        pageSlots[table[tableWritePos + 1]] = table[tableWritePos];
+}
+
+void UserEeprom::setLogStructured(bool enable)
+{
+    logStructured = enable;
+}
+
+bool UserEeprom::isLogStructured() const
+{
+    return logStructured;
+}
+
+unsigned int UserEeprom::logStart() const
+{
+    unsigned int baseSize = USER_EEPROM_LOG_HEADER_SIZE + size();
+    return (baseSize + FLASH_PAGE_SIZE - 1) & ~(FLASH_PAGE_SIZE - 1);
+}
+
+bool UserEeprom::readLog()
+{
+    const byte* sector = flashSectorAddress();
+
+    logOnFlash = false;
+    logWritePos = 0;
+
+    if (!isSectorHeaderValid(sector, USER_EEPROM_LOG_MAGIC, size()))
+        return false;
+
+    memcpy(userEepromData, sector + USER_EEPROM_LOG_HEADER_SIZE, size());
+    logWritePos = replayLog(0, size(), userEepromData);
+    logOnFlash = true;
+    return true;
+}
+
+unsigned int UserEeprom::replayLog(unsigned int offset, unsigned int length, byte* dest) const
+{
+    const byte* sector = flashSectorAddress();
+    unsigned int pos = logStart();
+    unsigned int freePos = FLASH_SECTOR_SIZE;
+
+    while (pos + USER_EEPROM_LOG_RECORD_HEADER_SIZE <= FLASH_SECTOR_SIZE)
+    {
+        const byte* record = sector + pos;
+        unsigned int recOffset = getLE16(record);
+        unsigned int recLength = getLE16(record + 2);
+        unsigned int pageOffset = pos & (FLASH_PAGE_SIZE - 1);
+
+        if (recOffset == 0xffff && recLength == 0xffff)
+        {
+            // Erased: the end of the log, or the rest of the page was too small for the next record
+            if (freePos == FLASH_SECTOR_SIZE)
+                freePos = pos;
+            if (pageOffset == 0)
+                break;
+            pos += FLASH_PAGE_SIZE - pageOffset;
+            continue;
+        }
+
+        // Records behind an unused page end must not be followed by new records in that page
+        freePos = FLASH_SECTOR_SIZE;
+
+        if (recLength == 0 || recOffset + recLength > size() ||
+            pageOffset + USER_EEPROM_LOG_RECORD_HEADER_SIZE + recLength > FLASH_PAGE_SIZE ||
+            getLE16(record + 4) != crc16Ccitt(record + USER_EEPROM_LOG_RECORD_HEADER_SIZE, recLength, crc16Ccitt(record, 4)))
+        {
+            // Invalid record, e.g. from an interrupted flush. Ignore it and all following records.
+            break;
+        }
+
+        // Apply the part of the record which overlaps the requested part of the user EEPROM
+        unsigned int start = recOffset > offset ? recOffset : offset;
+        unsigned int end = recOffset + recLength;
+        if (end > offset + length)
+            end = offset + length;
+        if (start < end)
+            memcpy(dest + start - offset, record + USER_EEPROM_LOG_RECORD_HEADER_SIZE + start - recOffset, end - start);
+
+        pos += USER_EEPROM_LOG_RECORD_HEADER_SIZE + recLength;
     }
 
-    userEepromData[size() - 1] = 0; // mark the page as in use
+    return freePos;
+}
 
-    IAP_Status rc;
+bool UserEeprom::appendLogRecords()
+{
+    const byte* base = flashSectorAddress() + USER_EEPROM_LOG_HEADER_SIZE;
+    const unsigned int maxRecordLength = FLASH_PAGE_SIZE - USER_EEPROM_LOG_RECORD_HEADER_SIZE;
+    const unsigned int maxRecords = 8; // bounds the stack usage
+    uint16_t recordOffset[maxRecords];
+    uint16_t recordLength[maxRecords];
+    unsigned int count = 0;
+    unsigned int start = logWritePos;
+    unsigned int pos = logWritePos;
+    uint32_t pages = flushPages;
 
-    for (unsigned int i = 0; i < size(); i += 1024)
+    // Collect the changed ranges of the modified pages as long as they fit into the current log page.
+    // All records of a step are programmed together, the log page is not programmed again for every record.
+    while (pages && count < maxRecords)
     {
-    	int chunk = size() - i;
-    	if (chunk > 1024)
-    	{
-    		chunk = 1024;
-    	}
-    	rc = iapProgram(page + i, userEepromData + i, chunk);
-    	if (rc != IAP_SUCCESS)
-    	{
+        unsigned int page = __builtin_ctz(pages);
+        pages &= ~(1u << page);
+        unsigned int chunk = page * FLASH_PAGE_SIZE;
+        unsigned int chunkSize = size() - chunk;
+        if (chunkSize > FLASH_PAGE_SIZE)
+            chunkSize = FLASH_PAGE_SIZE;
+
+        // Get the current flash content of this page of the user EEPROM
+        memcpy(flashPageBuffer, base + chunk, chunkSize);
+        replayLog(chunk, chunkSize, flashPageBuffer);
+
+        const byte* data = userEepromData + chunk;
+        unsigned int first = 0;
+        while (first < chunkSize && flashPageBuffer[first] == data[first])
+            ++first;
+
+        if (first == chunkSize)
+        {
+            flushPages &= ~(1u << page); // page is written completely
+            continue;
+        }
+
+        unsigned int last = chunkSize - 1;
+        while (flashPageBuffer[last] == data[last])
+            --last;
+
+        // Records do not cross a page boundary
+        unsigned int length = last + 1 - first;
+        unsigned int pageOffset = pos & (FLASH_PAGE_SIZE - 1);
+        if (count > 0 && (pageOffset == 0 || pageOffset + USER_EEPROM_LOG_RECORD_HEADER_SIZE + length > FLASH_PAGE_SIZE))
+            break; // the next step writes this range into the next log page
+
+        if (pageOffset + USER_EEPROM_LOG_RECORD_HEADER_SIZE + length > FLASH_PAGE_SIZE)
+        {
+            if (pageOffset != 0)
+                pos += FLASH_PAGE_SIZE - pageOffset;
+            start = pos;
+            if (length > maxRecordLength)
+                length = maxRecordLength;
+        }
+
+        if (pos + USER_EEPROM_LOG_RECORD_HEADER_SIZE + length > FLASH_SECTOR_SIZE)
+        {
+            if (count > 0)
+                break;
+
+            flushState = FLUSH_ERASE; // log is full, write a new base image
+            return false;
+        }
+
+        // A partially written page is compared again in the next step
+        if (first + length == last + 1)
+            flushPages &= ~(1u << page);
+
+        recordOffset[count] = chunk + first;
+        recordLength[count] = length;
+        ++count;
+        pos += USER_EEPROM_LOG_RECORD_HEADER_SIZE + length;
+    }
+
+    if (count)
+    {
+        // The log page may already contain records. They are programmed again with the same content,
+        // the rest of the page stays erased.
+        byte* page = flashSectorAddress() + (start & ~(FLASH_PAGE_SIZE - 1));
+        memcpy(flashPageBuffer, page, FLASH_PAGE_SIZE);
+
+        byte* record = flashPageBuffer + (start & (FLASH_PAGE_SIZE - 1));
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            unsigned int length = recordLength[i];
+            putLE16(record, recordOffset[i]);
+            putLE16(record + 2, length);
+            memcpy(record + USER_EEPROM_LOG_RECORD_HEADER_SIZE, userEepromData + recordOffset[i], length);
+            putLE16(record + 4, crc16Ccitt(record + USER_EEPROM_LOG_RECORD_HEADER_SIZE, length, crc16Ccitt(record, 4)));
+            record += USER_EEPROM_LOG_RECORD_HEADER_SIZE + length;
+        }
+
+        if (iapProgram(page, flashPageBuffer, FLASH_PAGE_SIZE) != IAP_SUCCESS)
+        {
             fatalError(); // flashing failed
-    	}
+        }
+        logWritePos = pos;
     }
 
-    modified(false);
-    interrupts();
+    if (flushPages)
+        return false;
+
+    flushFinished();
+    return true;
 }
 
 UserEeprom::UserEeprom(unsigned int start, unsigned int size, unsigned int flashSize) :
 		Memory(start, size),
 		userEepromData(new byte[size]()),
+		pageSlots(new byte[(size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE]()),
 		userEepromFlashSize(flashSize)
 {
     readUserEeprom();
@@ -152,14 +776,52 @@ void UserEeprom::modified(bool newModified)
     userEepromModified = newModified;
     if (userEepromModified)
     {
+        modifiedWhileFlushing = isFlushing();
+        unsigned int numPages = (size() + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+        modifiedPages = (numPages >= 32) ? 0xffffffff : (1u << numPages) - 1;
         writeUserEepromTime = millis() + 50;
     }
     else
     {
+        modifiedPages = 0;
         writeUserEepromTime = 0;
     }
 }
 
+void UserEeprom::modified(uint32_t address, unsigned int length)
+{
+    normalizeAddress(&address);
+    if (length == 0 || address >= size())
+    {
+        return;
+    }
+
+    if (address + length > size())
+    {
+        length = size() - address;
+    }
+
+    unsigned int lastPage = (address + length - 1) / FLASH_PAGE_SIZE;
+    for (unsigned int page = address / FLASH_PAGE_SIZE; page <= lastPage; ++page)
+    {
+        modifiedPages |= 1u << page;
+    }
+
+    userEepromModified = true;
+    modifiedWhileFlushing = isFlushing();
+    writeUserEepromTime = millis() + 50;
+}
+
+void UserEeprom::modified(const byte* data, unsigned int length)
+{
+    modified(startAddress + (data - userEepromData), length);
+}
+
+bool UserEeprom::isPageModified(unsigned int page) const
+{
+    return (page < 32) && (modifiedPages & (1u << page));
+}
+
 bool UserEeprom::writeDelayElapsed() const
 {
     bool elapsed = userEepromModified;
@@ -71,8 +71,62 @@ typedef void (*IAP_Func)(uintptr_t * cmd, uintptr_t * stat);
 #endif
 
 
+volatile bool iapCallActive = false;
+
+#ifdef IAP_KEEP_BUS_INTERRUPTS
+// Interrupts which stay enabled during IAP calls, their handlers are located in RAM
+static unsigned int iapRamInterruptMask = 0;
+
+// Enabled interrupts before the IAP call
+static unsigned int iapSavedInterrupts;
+
+// Size of the vector table which is copied to RAM, same as the bootloader does
+#define IAP_VECTOR_TABLE_SIZE (192 / sizeof(uint32_t))
+#define IAP_RAM_START         (0x10000000)
+#define SYSMEMREMAP_USER_RAM  (0x01)
+
+// 16 system exception vectors and the 32 interrupt vectors of the LPC11xx
+static_assert(IAP_VECTOR_TABLE_SIZE == 16 + 32, "The vector table copy does not cover all vectors");
+
+#ifndef IAP_EMULATION
+extern uint8_t __base_RAM[]; //!< marks the beginning of the RAM used by the application (inserted by the linker)
+#endif
+
+bool iapKeepInterrupts(unsigned int interruptMask)
+{
+#ifndef IAP_EMULATION
+    if (__base_RAM < (uint8_t*) IAP_RAM_START + IAP_VECTOR_TABLE_SIZE * sizeof(uint32_t))
+    {
+        // the application uses the RAM of the vector table copy, keep all interrupts blocked
+        iapRamInterruptMask = 0;
+        return false;
+    }
+
+    if (LPC_SYSCON->SYSMEMREMAP != SYSMEMREMAP_USER_RAM)
+    {
+        // we were not started by the bootloader, so the vector table is still in flash
+        const uint32_t* rom = (const uint32_t*) FLASH_BASE_ADDRESS;
+        uint32_t* ram = (uint32_t*) IAP_RAM_START;
+        for (unsigned int i = 0; i < IAP_VECTOR_TABLE_SIZE; i++)
+        {
+            ram[i] = rom[i];
+        }
+        LPC_SYSCON->SYSMEMREMAP = SYSMEMREMAP_USER_RAM;
+    }
+#endif
+    iapRamInterruptMask = interruptMask;
+    return true;
+}
+#else
+bool iapKeepInterrupts(unsigned int interruptMask)
+{
+    (void) interruptMask;
+    return false;
+}
+#endif
+
 /**
- * IAP_Call_InterruptSafe(): interrupt-safe IAP_Call function
+ * Block the interrupts for an IAP call.
  *
  * ATTENTION: interrupts shall be blocked during an IAP_Call()!
  *
@@ -80,19 +134,59 @@ typedef void (*IAP_Func)(uintptr_t * cmd, uintptr_t * stat);
  *         the user application. When an interrupt occurs and the Interrupt
  *         Vector Table is located in the Flash this will fail and raise a
  *         non-handled HardFault condition.
+ *
+ * With IAP_KEEP_BUS_INTERRUPTS only the interrupts are masked whose handlers
+ * are located in flash.
+ */
+static void iapLock()
+{
+    noInterrupts();
+#ifdef IAP_KEEP_BUS_INTERRUPTS
+    if (iapRamInterruptMask != 0)
+    {
+        iapSavedInterrupts = NVIC->ISER[0];
+        NVIC->ICER[0] = ~iapRamInterruptMask;
+        __DSB();
+        __ISB();
+        iapCallActive = true;
+        interrupts();
+        return;
+    }
+#endif
+    iapCallActive = true;
+}
+
+/**
+ * Unblock the interrupts after an IAP call.
+ */
+static void iapUnlock()
+{
+#ifdef IAP_KEEP_BUS_INTERRUPTS
+    if (iapRamInterruptMask != 0)
+    {
+        noInterrupts();
+        NVIC->ISER[0] = iapSavedInterrupts;
+    }
+#endif
+    iapCallActive = false;
+    interrupts();
+}
+
+/**
+ * IAP_Call_InterruptSafe(): interrupt-safe IAP_Call function, see iapLock()
  */
 inline void IAP_Call_InterruptSafe(uintptr_t * cmd, uintptr_t * stat, const bool getLock = true)
 {
     if (getLock)
     {
-        noInterrupts();
+        iapLock();
     }
 
     IAP_Call(cmd, stat);
 
     if (getLock)
     {
-        interrupts();
+        iapUnlock();
     }
 }
 
@@ -170,14 +264,14 @@ IAP_Status iapProgram(uint8_t * rom, const uint8_t * ram, unsigned int size)
     IAP_Parameter p;
     unsigned int sector = iapSectorOfAddress(rom);
 
-    // in order to access flash we need to disable all interrupts
-    noInterrupts();
+    // in order to access flash we need to disable the interrupts
+    iapLock();
     // first we need to unlock the sector
     p.stat = _prepareSectorRange(sector, sector, false);
 
     if (p.stat != IAP_SUCCESS)
     {
-        interrupts();
+        iapUnlock();
         return (IAP_Status) p.stat;
     }
 
@@ -191,7 +285,7 @@ IAP_Status iapProgram(uint8_t * rom, const uint8_t * ram, unsigned int size)
 
     if (p.stat != IAP_SUCCESS)
     {
-        interrupts();
+        iapUnlock();
         return (IAP_Status) p.stat;
     }
 
@@ -201,7 +295,7 @@ IAP_Status iapProgram(uint8_t * rom, const uint8_t * ram, unsigned int size)
     p.par[1] = (uintptr_t) ram;
     p.par[2] = size;
     IAP_Call_InterruptSafe(&p.cmd, &p.stat, false);
-    interrupts();
+    iapUnlock();
     return (IAP_Status) p.stat;
 }
 
@@ -24,9 +24,14 @@ MemMapper::MemMapper(unsigned int flashBase, unsigned int flashSize, bool autoAd
     flashSizePages = flashSize / FLASH_PAGE_SIZE;
     flashBasePage = iapPageOfAddress(this->flashBase);
     lastAllocated = 0; // means: nothing allocated in this run
-    writePage = 0;
+    useCounter = 0;
+    for (int i = 0; i < MEM_MAPPER_CACHE_PAGES; i++)
+    {
+        cache[i].flashPage = 0;
+        cache[i].used = 0;
+        cache[i].modified = false;
+    }
     allocTableModified = false;
-    flashMemModified = false;
     memcpy(allocTable, this->flashBase, FLASH_PAGE_SIZE);
     // Quick check if there is more than one zero on the allocTable, a certain
     // sign of table corruption. In this case, clear the table (set all 0xff).
@@ -60,37 +65,109 @@ MemMapper::MemMapper(unsigned int flashBase, unsigned int flashSize, bool autoAd
     }
 }
 
+bool MemMapper::flashAllocTable() const
+{
+    if (!allocTableModified)
+    {
+        return (false);
+    }
+    if (iapErasePage(flashBasePage) != IAP_SUCCESS)
+    {
+        fatalError();
+    }
+    if (iapProgram(flashBase, allocTable, FLASH_PAGE_SIZE) != IAP_SUCCESS)
+    {
+        fatalError();
+    }
+    allocTableModified = false;
+    return (true);
+}
+
+bool MemMapper::writeBack(CachePage* page) const
+{
+    if (!page->modified)
+    {
+        return (false);
+    }
+    if (iapErasePage(page->flashPage) != IAP_SUCCESS)
+    {
+        fatalError();
+    }
+    if (iapProgram(iapAddressOfPage(page->flashPage), page->data, FLASH_PAGE_SIZE)
+            != IAP_SUCCESS)
+    {
+        fatalError();
+    }
+    page->modified = false;
+    return (true);
+}
+
 int MemMapper::doFlash(void) const
 {
     int ret = 0;
-    if (allocTableModified)
+    // data pages first, so the allocation table never references a page which is not yet written
+    for (int i = 0; i < MEM_MAPPER_CACHE_PAGES; i++)
     {
-        if (iapErasePage(flashBasePage) != IAP_SUCCESS)
+        if (writeBack(&cache[i]))
         {
-            fatalError();
+            ret |= 2;
         }
-        if (iapProgram(flashBase, allocTable, FLASH_PAGE_SIZE) != IAP_SUCCESS)
+    }
+    if (flashAllocTable())
+    {
+        ret |= 1;
+    }
+    return ret;
+}
+
+MemMapper::CachePage* MemMapper::findCachePage(int flashPage) const
+{
+    for (int i = 0; i < MEM_MAPPER_CACHE_PAGES; i++)
+    {
+        if (cache[i].flashPage == flashPage)
         {
-            fatalError();
+            cache[i].used = ++useCounter;
+            return &cache[i];
         }
-        allocTableModified = false;
-        ret |= 1;
     }
-    if (flashMemModified)
+    return nullptr;
+}
+
+MemMapper::CachePage* MemMapper::cachePage(int flashPage, bool load) const
+{
+    CachePage* page = findCachePage(flashPage);
+    if (page != nullptr)
     {
-        if (iapErasePage(writePage) != IAP_SUCCESS)
+        return page;
+    }
+
+    // take an unused entry or replace the least recently used one
+    page = &cache[0];
+    for (int i = 0; i < MEM_MAPPER_CACHE_PAGES; i++)
+    {
+        if (cache[i].flashPage == 0)
         {
-            fatalError();
+            page = &cache[i];
+            break;
         }
-        if (iapProgram(iapAddressOfPage(writePage), writeBuf, FLASH_PAGE_SIZE)
-                != IAP_SUCCESS)
+        if (cache[i].used < page->used)
         {
-            fatalError();
+            page = &cache[i];
         }
-        flashMemModified = false;
-        ret |= 2;
     }
-    return ret;
+    writeBack(page);
+
+    page->flashPage = flashPage;
+    page->used = ++useCounter;
+    if (load)
+    {
+        memcpy(page->data, iapAddressOfPage(flashPage), FLASH_PAGE_SIZE);
+    }
+    else
+    {
+        memset(page->data, 0, FLASH_PAGE_SIZE);
+    }
+    return page;
 }
 
 int MemMapper::allocatePage(int virtPage)
@@ -110,23 +187,25 @@ int MemMapper::allocatePage(int virtPage)
     {
         return MEM_MAPPER_OUT_OF_MEMORY; // we are out of memory
     }
+    int flashPage;
     if (lastAllocated == 0)
     {  // no pages allocated yet.
-        writePage = flashBasePage + 1;
+        flashPage = flashBasePage + 1;
     } else
     {
         lastAllocated++;
-        writePage = lastAllocated;
+        flashPage = lastAllocated;
     }
-    memset(writeBuf, 0, FLASH_PAGE_SIZE);
+    allocTable[virtPage] = flashPage ^ 0xff;
+    allocTableModified = true;
 
-    allocTable[virtPage] = writePage ^ 0xff;
+    // a new page starts zeroed in the cache, regardless of the old flash content
+    cachePage(flashPage, false)->modified = true;
     return MEM_MAPPER_SUCCESS;
 }
 
 int MemMapper::addRange(int virtAddress, int length)
 {
-    bool tableModified = false;
     int virtPage = virtAddress >> 8;
 
     if ((virtAddress & 0xff) || virtPage < 0 || virtPage >= FLASH_PAGE_SIZE)
@@ -151,13 +230,8 @@ int MemMapper::addRange(int virtAddress, int length)
             {
                 return result;
             }
-            flashMemModified = true;
-            doFlash();
-            tableModified = true;
         }
     }
-    if (tableModified)
-        allocTableModified = true;
     doFlash();
     return MEM_MAPPER_SUCCESS;
 }
@@ -175,61 +249,69 @@ int MemMapper::getFlashPageNum(int virtAddress) const
 }
 
 int MemMapper::writeMem(int virtAddress, byte data)
+{
+    return writeSpan(virtAddress, &data, 1);
+}
+
+int MemMapper::writeSpan(int virtAddress, const byte *data, int length)
 {
     int flashPageNum = getFlashPageNum(virtAddress);
     if (flashPageNum < 0)
     {
         return flashPageNum;
     }
-    if (writePage != flashPageNum)
-    {
-        doFlash();
-        writePage = flashPageNum;
-        if (writePage != 0)
-        { // swap flash page into write buffer
-            memcpy(writeBuf, iapAddressOfPage(writePage), FLASH_PAGE_SIZE);
-        }
-    }
 
     if (flashPageNum == 0)
     { // not yet allocated in flash memory
-        if (autoAddPage)
+        if (!autoAddPage)
         {
-            int result = allocatePage(virtAddress >> 8);
-            if (result != MEM_MAPPER_SUCCESS)
-            {
-                return result;
-            }
-            allocTableModified = true;
+            return MEM_MAPPER_NOT_MAPPED;
+        }
+        int result = allocatePage(virtAddress >> 8);
+        if (result != MEM_MAPPER_SUCCESS)
+        {
+            return result;
         }
+        flashPageNum = getFlashPageNum(virtAddress);
     }
-    writeBuf[(virtAddress & 0xff)] = data;
-    flashMemModified = true;
+
+    CachePage* page = cachePage(flashPageNum, true);
+    memcpy(&page->data[virtAddress & 0xff], data, length);
+    page->modified = true;
 
     return MEM_MAPPER_SUCCESS;
 }
 
 int MemMapper::writeMemPtr(int virtAddress, byte *data, int length)
 {
-    for (int i = 0; i < length; i++)
+    while (length > 0)
     {
-        int result;
-        result = writeMem(virtAddress + i, data[i]);
+        // split the request at the virtual page boundaries
+        int spanLength = MIN(length, FLASH_PAGE_SIZE - (virtAddress & 0xff));
+        int result = writeSpan(virtAddress, data, spanLength);
         if (result != MEM_MAPPER_SUCCESS)
         {
             return result;
         }
+        virtAddress += spanLength;
+        data += spanLength;
+        length -= spanLength;
     }
     return MEM_MAPPER_SUCCESS;
 }
 
 int MemMapper::readMem(int virtAddress, byte &data, bool forceFlash)
+{
+    return readSpan(virtAddress, &data, 1, forceFlash);
+}
+
+int MemMapper::readSpan(int virtAddress, byte *data, int length, bool forceFlash)
 {
     int flashPageNum = getFlashPageNum(virtAddress);
 
     if (flashPageNum < 0)
     {
-        data = 0x00;
+        data[0] = 0x00;
         return flashPageNum;
     }
     if (forceFlash)
@@ -238,14 +320,17 @@ int MemMapper::readMem(int virtAddress, byte &data, bool forceFlash)
     }
     if (flashPageNum == 0)
     {
-        data = 0x00;
+        data[0] = 0x00;
         return MEM_MAPPER_NOT_MAPPED;
-    } else if ((flashPageNum == writePage) && !forceFlash)
+    }
+
+    CachePage* page = forceFlash ? nullptr : findCachePage(flashPageNum);
+    if (page != nullptr)
     {
-        data = writeBuf[virtAddress & 0xff];
+        memcpy(data, &page->data[virtAddress & 0xff], length);
     } else
     {
-        data = iapAddressOfPage(flashPageNum)[virtAddress & 0xff];
+        memcpy(data, &iapAddressOfPage(flashPageNum)[virtAddress & 0xff], length);
     }
     return MEM_MAPPER_SUCCESS;
 }
@@ -253,14 +338,18 @@ int MemMapper::readMem(int virtAddress, byte &data, bool forceFlash)
 int MemMapper::readMemPtr(int virtAddress, byte *data, int length,
         bool forceFlash)
 {
-    for (int i = 0; i < length; i++)
+    while (length > 0)
     {
-        int result;
-        result = readMem(virtAddress + i, data[i], forceFlash);
+        // split the request at the virtual page boundaries
+        int spanLength = MIN(length, FLASH_PAGE_SIZE - (virtAddress & 0xff));
+        int result = readSpan(virtAddress, data, spanLength, forceFlash);
         if (result != MEM_MAPPER_SUCCESS)
         {
             return result;
         }
+        virtAddress += spanLength;
+        data += spanLength;
+        length -= spanLength;
     }
     return MEM_MAPPER_SUCCESS;
 }
@@ -295,9 +384,12 @@ byte* MemMapper::memoryPtr(int virtAddress, bool forceFlash) const
     if (flashPageNum == 0)
     {
         return NULL;
-    } else if ((flashPageNum == writePage) && !forceFlash)
+    }
+
+    CachePage* page = forceFlash ? nullptr : findCachePage(flashPageNum);
+    if (page != nullptr)
     {
-        return writeBuf + (virtAddress & 0xff);
+        return page->data + (virtAddress & 0xff);
     }
     return (iapAddressOfPage(flashPageNum) + (virtAddress & 0xff));
 }
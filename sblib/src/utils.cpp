@@ -28,6 +28,34 @@ void reverseCopy(byte* dest, const byte* src, int len)
     }
 }
 
+void reverseCopyElements(byte* dest, const byte* src, int count, int size)
+{
+    if (size == 1)
+    {
+        // nothing to reverse, copy the whole run at once
+        memcpy(dest, src, count);
+        return;
+    }
+
+    if (size == 2)
+    {
+        // most array properties hold 16 bit values, swap them without a call per element
+        for (; count > 0; --count, dest += 2, src += 2)
+        {
+            dest[0] = src[1];
+            dest[1] = src[0];
+        }
+        return;
+    }
+
+    for (; count > 0; --count)
+    {
+        reverseCopy(dest, src, size);
+        dest += size;
+        src += size;
+    }
+}
+
 void setPinsInSecureModes()
 {
     pinMode(fatalErrorPin, OUTPUT);
@@ -95,3 +123,19 @@ int hashUID(byte* uid, const int len_uid, byte* hash, const int len_hash)
         hash[i] = uint64_t(a >> (8*i)) & 0xFF;
     return 1;
 }
+
+uint16_t crc16Ccitt(const byte* data, int len, uint16_t crc)
+{
+    while (--len >= 0)
+    {
+        crc ^= (uint16_t) *data++ << 8;
+        for (int i = 0; i < 8; ++i)
+        {
+            if (crc & 0x8000)
+                crc = (crc << 1) ^ 0x1021;
+            else
+                crc <<= 1;
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,17 @@
+/*
+ *  crc_slices1.cpp - The crc32 calculation of the bootloader with CRC32_TABLE_SLICES=1
+ *
+ *  The test builds use the default of the bootloader, so this file compiles crc.cpp once more
+ *  with one lookup table. The functions are renamed to crc32Slices1() and
+ *  crc32BitwiseSlices1(), to keep them apart from the ones of the default build.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#define CRC32_TABLE_SLICES 1
+#define crc32 crc32Slices1
+#define crc32Bitwise crc32BitwiseSlices1
+
+#include "../../../firmware_updater/bootloader/src/crc.cpp"
@@ -0,0 +1,17 @@
+/*
+ *  crc_slices4.cpp - The crc32 calculation of the bootloader with CRC32_TABLE_SLICES=4
+ *
+ *  The test builds use the default of the bootloader, so this file compiles crc.cpp once more
+ *  with the slice-by-4 tables. The functions are renamed to crc32Slices4() and
+ *  crc32BitwiseSlices4(), to keep them apart from the ones of the default build.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#define CRC32_TABLE_SLICES 4
+#define crc32 crc32Slices4
+#define crc32Bitwise crc32BitwiseSlices4
+
+#include "../../../firmware_updater/bootloader/src/crc.cpp"
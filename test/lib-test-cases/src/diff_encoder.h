@@ -0,0 +1,156 @@
+/*
+ *  diff_encoder.h - Reference encoder of the differential stream of the bootloader decompressor
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#ifndef DIFF_ENCODER_H_
+#define DIFF_ENCODER_H_
+
+#include <sblib/internal/iap.h>
+#include "decompressor.h"
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define CMD_RAW 0
+#define CMD_COPY 0x80
+#define FLAG_LONG 0x40
+#define ADDR_FROM_RAM 0x80
+#define MIN_MATCH_LENGTH 6
+#define MAX_SHORT_LENGTH 63
+
+typedef std::vector<uint8_t> Bytes;
+
+/*
+ * Reference compressor like the one of the PC updater tool. It keeps a model of the flash
+ * and of the old pages the decompressor remembers in RAM.
+ *
+ * Without a known old image (oldImageKnown false) only the pages already written
+ * are referenced, the stream is then a plain compression of the new image.
+ */
+struct DiffEncoder
+{
+    Bytes rom;      // flash content relative to the application start
+    Bytes oldPages; // old content of the last overwritten pages, oldest first
+    bool oldImageKnown = true;
+    unsigned int ramCopies = 0;
+    unsigned int romCopies = 0;
+    unsigned int romCopiesBehindImage = 0;
+
+    DiffEncoder()
+        : oldPages(FLASH_PAGE_SIZE * REMEMBER_OLD_PAGES_COUNT, 0)
+    {}
+
+    static unsigned int matchLength(const Bytes& source, unsigned int pos, unsigned int sourceEnd,
+                                    const Bytes& data, unsigned int i, unsigned int end)
+    {
+        unsigned int length = 0;
+        while (i + length < end && pos + length < sourceEnd && source[pos + length] == data[i + length])
+            ++length;
+        return length;
+    }
+
+    static void putLength(Bytes& stream, uint8_t cmd, unsigned int length)
+    {
+        if (length <= MAX_SHORT_LENGTH)
+            stream.push_back(cmd | length);
+        else
+        {
+            stream.push_back(cmd | FLAG_LONG | (length >> 8));
+            stream.push_back(length & 0xff);
+        }
+    }
+
+    static void flushRaw(Bytes& stream, Bytes& raw)
+    {
+        if (raw.empty())
+            return;
+        putLength(stream, CMD_RAW, raw.size());
+        stream.insert(stream.end(), raw.begin(), raw.end());
+        raw.clear();
+    }
+
+    /*
+     * Encode the page of newImage starting at pageStart and update the model
+     * as the decompressor would do when the page is flashed.
+     */
+    Bytes encodePage(const Bytes& newImage, unsigned int pageStart, unsigned int newImageSize)
+    {
+        Bytes stream;
+        Bytes raw;
+        unsigned int end = pageStart + FLASH_PAGE_SIZE;
+        if (end > newImage.size())
+            end = newImage.size();
+        unsigned int romEnd = oldImageKnown ? rom.size() : pageStart;
+
+        unsigned int i = pageStart;
+        while (i < end)
+        {
+            unsigned int bestLength = 0;
+            unsigned int bestAddress = 0;
+            bool fromRam = false;
+            for (unsigned int pos = 0; oldImageKnown && pos < oldPages.size(); ++pos)
+            {
+                unsigned int length = matchLength(oldPages, pos, oldPages.size(), newImage, i, end);
+                if (length > bestLength)
+                {
+                    bestLength = length;
+                    bestAddress = pos;
+                    fromRam = true;
+                }
+            }
+            for (unsigned int pos = 0; pos < romEnd; ++pos)
+            {
+                unsigned int length = matchLength(rom, pos, romEnd, newImage, i, end);
+                if (length > bestLength)
+                {
+                    bestLength = length;
+                    bestAddress = pos;
+                    fromRam = false;
+                }
+            }
+
+            if (bestLength >= MIN_MATCH_LENGTH)
+            {
+                flushRaw(stream, raw);
+                putLength(stream, CMD_COPY, bestLength);
+                stream.push_back((bestAddress >> 16) | (fromRam ? ADDR_FROM_RAM : 0));
+                stream.push_back(bestAddress >> 8);
+                stream.push_back(bestAddress);
+                if (fromRam)
+                    ++ramCopies;
+                else
+                {
+                    ++romCopies;
+                    if (bestAddress >= newImageSize)
+                        ++romCopiesBehindImage;
+                }
+                i += bestLength;
+            }
+            else
+                raw.push_back(newImage[i++]);
+        }
+        flushRaw(stream, raw);
+
+        // remember the old page and "flash" the new one
+        oldPages.erase(oldPages.begin(), oldPages.begin() + FLASH_PAGE_SIZE);
+        oldPages.insert(oldPages.end(), rom.begin() + pageStart, rom.begin() + pageStart + FLASH_PAGE_SIZE);
+        memset(&rom[pageStart], 0, FLASH_PAGE_SIZE);
+        memcpy(&rom[pageStart], &newImage[pageStart], end - pageStart);
+        return stream;
+    }
+};
+
+static inline Bytes randomImage(unsigned int size, unsigned int seed)
+{
+    Bytes image(size);
+    srand(seed);
+    for (unsigned int i = 0; i < size; ++i)
+        image[i] = rand();
+    return image;
+}
+
+#endif /* DIFF_ENCODER_H_ */
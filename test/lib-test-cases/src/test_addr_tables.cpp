@@ -0,0 +1,181 @@
+/*
+ *  test_addr_tables.cpp - Tests for the group address lookup in the address table
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "protocol.h"
+
+/*
+ * Write the group addresses to the address table of the BCU 1 at 0x116,
+ * behind the length and the own physical address.
+ */
+static void setGroupAddresses(BCU1& bcu, const uint16_t* addresses, int count)
+{
+    bcu.userEeprom->addrTabSize() = count + 1;
+    for (int i = 0; i < count; ++i)
+    {
+        bcu.userEeprom->userEepromData[0x19 + i * 2] = addresses[i] >> 8;
+        bcu.userEeprom->userEepromData[0x1A + i * 2] = addresses[i] & 0xff;
+    }
+    bcu.addrTables->rebuild();
+}
+
+TEST_CASE("Index of a group address","[SBLIB][ADDR_TABLES]")
+{
+    BCU1 bcu;
+
+    SECTION("Sorted address table")
+    {
+        const uint16_t addresses[] = { 0x0801, 0x0805, 0x0A10, 0x1234, 0x7FFF };
+        setGroupAddresses(bcu, addresses, 5);
+
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0801) == 1);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0805) == 2);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0A10) == 3);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x1234) == 4);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x7FFF) == 5);
+        REQUIRE(bcu.addrTables->sorted);
+
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0000) == -1);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0800) == -1);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0802) == -1);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x1233) == -1);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x8000) == -1);
+        REQUIRE(bcu.addrTables->indexOfAddr(0xFFFF) == -1);
+    }
+
+    SECTION("Unsorted address table")
+    {
+        const uint16_t addresses[] = { 0x0A10, 0x7FFF, 0x0801, 0x1234, 0x0805 };
+        setGroupAddresses(bcu, addresses, 5);
+
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0A10) == 1);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x7FFF) == 2);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0801) == 3);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x1234) == 4);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0805) == 5);
+        REQUIRE(!bcu.addrTables->sorted);
+
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0000) == -1);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0802) == -1);
+        REQUIRE(bcu.addrTables->indexOfAddr(0xFFFF) == -1);
+    }
+
+    SECTION("Table sorted again after a change")
+    {
+        const uint16_t unsorted[] = { 0x0805, 0x0801 };
+        setGroupAddresses(bcu, unsorted, 2);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0801) == 2);
+        REQUIRE(!bcu.addrTables->sorted);
+
+        const uint16_t sorted[] = { 0x0801, 0x0805 };
+        setGroupAddresses(bcu, sorted, 2);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0801) == 1);
+        REQUIRE(bcu.addrTables->sorted);
+    }
+
+    SECTION("Large sorted address table")
+    {
+        uint16_t addresses[100];
+        for (int i = 0; i < 100; ++i)
+        {
+            addresses[i] = 0x0800 + i * 3;
+        }
+        setGroupAddresses(bcu, addresses, 100);
+
+        for (int i = 0; i < 100; ++i)
+        {
+            REQUIRE(bcu.addrTables->indexOfAddr(addresses[i]) == i + 1);
+            REQUIRE(bcu.addrTables->indexOfAddr(addresses[i] + 1) == -1);
+        }
+        REQUIRE(bcu.addrTables->sorted);
+    }
+
+    SECTION("Empty address tables")
+    {
+        setGroupAddresses(bcu, nullptr, 0);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0801) == -1);
+
+        bcu.userEeprom->addrTabSize() = 0;
+        bcu.addrTables->rebuild();
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0801) == -1);
+    }
+
+    SECTION("Entry behind the last group address is not found")
+    {
+        const uint16_t addresses[] = { 0x0801, 0x0805, 0x0900 };
+        setGroupAddresses(bcu, addresses, 3);
+        bcu.userEeprom->addrTabSize() = 3; // 0x0900 is no longer part of the table
+        bcu.addrTables->rebuild();
+
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0805) == 2);
+        REQUIRE(bcu.addrTables->indexOfAddr(0x0900) == -1);
+    }
+}
+
+TEST_CASE("Group address lookup after a memory write","[SBLIB][ADDR_TABLES]")
+{
+    BCU1 bcu;
+    const uint16_t addresses[] = { 0x0801, 0x0805, 0x0A10, 0x1234, 0x7FFF };
+    setGroupAddresses(bcu, addresses, 5);
+    REQUIRE(bcu.addrTables->sorted);
+
+    // same table and number of addresses, but no longer in ascending order
+    byte unsorted[] = { 0x7F, 0xFF, 0x08, 0x05, 0x0A, 0x10, 0x12, 0x34, 0x08, 0x01 };
+    REQUIRE(bcu.processApciMemoryOperation(0x119, unsorted, sizeof(unsorted), false));
+
+    // the bus interrupt looks up the addresses before the next loop() rebuilds the caches
+    REQUIRE_FALSE(bcu.addrTables->sorted);
+    REQUIRE(bcu.addrTables->cachedIndexOfAddr(0x7FFF) == 1);
+    REQUIRE(bcu.addrTables->cachedIndexOfAddr(0x0801) == 5);
+    REQUIRE(bcu.addrTables->cachedIndexOfAddr(0x1234) == 4);
+    REQUIRE(bcu.addrTables->cachedIndexOfAddr(0x0802) == -1);
+    REQUIRE(bcu.addrTables->indexOfAddr(0x0801) == 5);
+
+    bcu.updateTableCaches();
+    REQUIRE_FALSE(bcu.addrTables->sorted);
+    REQUIRE(bcu.addrTables->cachedIndexOfAddr(0x0801) == 5);
+    REQUIRE(bcu.addrTables->indexOfAddr(0x0801) == 5);
+}
+
+TEST_CASE("Group address lookup of the bus interrupt","[SBLIB][ADDR_TABLES]")
+{
+    BCU1 bcu;
+
+    SECTION("Sorted address table")
+    {
+        const uint16_t addresses[] = { 0x0801, 0x0805, 0x0A10, 0x1234, 0x7FFF };
+        setGroupAddresses(bcu, addresses, 5);
+
+        for (int i = 0; i < 5; ++i)
+            REQUIRE(bcu.addrTables->cachedIndexOfAddr(addresses[i]) == i + 1);
+        REQUIRE(bcu.addrTables->cachedIndexOfAddr(0x0802) == -1);
+    }
+
+    SECTION("Unsorted address table")
+    {
+        const uint16_t addresses[] = { 0x0A10, 0x7FFF, 0x0801, 0x1234, 0x0805 };
+        setGroupAddresses(bcu, addresses, 5);
+
+        for (int i = 0; i < 5; ++i)
+            REQUIRE(bcu.addrTables->cachedIndexOfAddr(addresses[i]) == i + 1);
+        REQUIRE(bcu.addrTables->cachedIndexOfAddr(0x0802) == -1);
+    }
+
+    SECTION("Addresses added behind the table are found after the rebuild")
+    {
+        const uint16_t addresses[] = { 0x0801, 0x0805, 0x0900 };
+        setGroupAddresses(bcu, addresses, 3);
+        bcu.userEeprom->addrTabSize() = 3;
+        bcu.addrTables->rebuild();
+        REQUIRE(bcu.addrTables->cachedIndexOfAddr(0x0900) == -1);
+
+        bcu.userEeprom->addrTabSize() = 4;
+        bcu.tablesChanged();
+        bcu.updateTableCaches();
+        REQUIRE(bcu.addrTables->cachedIndexOfAddr(0x0900) == 3);
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ *  test_boot_descriptor.cpp - Tests for the application boot descriptor of the bootloader
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "catch.hpp"
+#include "iap_emu.h"
+#include <sblib/internal/iap.h>
+#include "boot_descriptor_block.h"
+#include "crc.h"
+#include <string.h>
+
+/*
+ * Flash an application of appSize bytes and its boot descriptor.
+ */
+static AppDescriptionBlock* flashApplication(unsigned int appSize, byte seed)
+{
+    static byte page[FLASH_PAGE_SIZE] __attribute__ ((aligned (FLASH_RAM_BUFFER_ALIGNMENT)));
+    byte* start = applicationFirstAddress();
+
+    REQUIRE(iapErasePageRange(iapPageOfAddress(start), iapPageOfAddress(start + appSize - 1)) == IAP_SUCCESS);
+    for (unsigned int offset = 0; offset < appSize; offset += FLASH_PAGE_SIZE)
+    {
+        for (unsigned int i = 0; i < FLASH_PAGE_SIZE; ++i)
+            page[i] = seed + (offset + i) * 3;
+        REQUIRE(iapProgram(start + offset, page, FLASH_PAGE_SIZE) == IAP_SUCCESS);
+    }
+
+    AppDescriptionBlock* descriptor = (AppDescriptionBlock*) page;
+    memset(page, 0xff, sizeof(page));
+    descriptor->startAddress = start;
+    descriptor->endAddress = start + appSize - 1;
+    descriptor->crc = crc32(0xFFFFFFFF, start, appSize);
+    descriptor->appVersionAddress = (char*) start + 0x40;
+    REQUIRE(iapProgram(bootDescriptorBlockAddress(), page, FLASH_PAGE_SIZE) == IAP_SUCCESS);
+
+    return (AppDescriptionBlock*) bootDescriptorBlockAddress();
+}
+
+TEST_CASE("Verified marker of the application","[BOOTLOADER][BOOT_DESCRIPTOR]")
+{
+    IAP_Init_Flash(0xFF);
+    AppDescriptionBlock* block = flashApplication(0x1000, 0x11);
+
+    REQUIRE(checkApplication(block));
+    REQUIRE(appVerifiedMarkerBlank(block));
+    REQUIRE_FALSE(appVerifiedMarkerValid(block));
+
+    SECTION("First cached check records the marker")
+    {
+        REQUIRE(checkApplicationCached(block));
+        REQUIRE(appVerifiedMarkerValid(block));
+        REQUIRE(checkApplication(block)); // the descriptor itself is unchanged
+
+        // the following checks rely on the marker: a changed application is not detected
+        applicationFirstAddress()[0x100] ^= 0xff;
+        REQUIRE(checkApplicationCached(block));
+        REQUIRE_FALSE(checkApplication(block));
+    }
+
+    SECTION("Invalidated marker forces the full check")
+    {
+        REQUIRE(writeAppVerifiedMarker(block));
+        invalidateAppVerifiedMarker(block);
+        REQUIRE_FALSE(appVerifiedMarkerValid(block));
+        REQUIRE_FALSE(appVerifiedMarkerBlank(block));
+
+        applicationFirstAddress()[0x100] ^= 0xff;
+        REQUIRE_FALSE(checkApplicationCached(block));
+
+        // a new marker needs an erase of the descriptor page
+        applicationFirstAddress()[0x100] ^= 0xff;
+        REQUIRE(checkApplicationCached(block));
+        REQUIRE_FALSE(appVerifiedMarkerValid(block));
+    }
+
+    SECTION("Marker belongs to the descriptor")
+    {
+        REQUIRE(writeAppVerifiedMarker(block));
+        REQUIRE(iapErasePage(bootDescriptorBlockPage()) == IAP_SUCCESS);
+        block = flashApplication(0x800, 0x22);
+        REQUIRE_FALSE(appVerifiedMarkerValid(block));
+        REQUIRE(checkApplicationCached(block));
+        REQUIRE(appVerifiedMarkerValid(block));
+    }
+
+    SECTION("Invalid addresses are rejected despite the marker")
+    {
+        REQUIRE(writeAppVerifiedMarker(block));
+        REQUIRE(iapErasePage(bootDescriptorBlockPage()) == IAP_SUCCESS);
+        REQUIRE_FALSE(checkApplicationCached(block));
+    }
+
+    IAP_Init_Flash(0xFF);
+}
@@ -0,0 +1,100 @@
+/*
+ *  test_bootloader_crc.cpp - Tests for the crc32 calculation of the bootloader
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "catch.hpp"
+#include "crc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+typedef unsigned int (*Crc32Function)(unsigned int startCrc32, unsigned char * data, unsigned int count);
+
+// crc.cpp compiled with the lookup tables, see crc_slices1.cpp and crc_slices4.cpp
+unsigned int crc32Slices1(unsigned int startCrc32, unsigned char * data, unsigned int count);
+unsigned int crc32Slices4(unsigned int startCrc32, unsigned char * data, unsigned int count);
+
+static const struct
+{
+    const char* name;
+    Crc32Function crc32;
+} implementations[] =
+{
+    { "crc32()", crc32 },
+    { "CRC32_TABLE_SLICES=1", crc32Slices1 },
+    { "CRC32_TABLE_SLICES=4", crc32Slices4 },
+};
+
+TEST_CASE("Bootloader crc32","[BOOTLOADER][CRC]")
+{
+    unsigned char text[] = "123456789";
+    REQUIRE(crc32Bitwise(0xFFFFFFFF, text, 9) == 0xCBF43926);
+
+    for (const auto& impl : implementations)
+    {
+        INFO(impl.name);
+
+        // check value of the standard test string
+        REQUIRE(impl.crc32(0xFFFFFFFF, text, 9) == 0xCBF43926);
+
+        // empty buffer
+        unsigned char dummy = 0;
+        REQUIRE(impl.crc32(0xFFFFFFFF, &dummy, 0) == 0);
+
+        // the table implementations match the bitwise one
+        static unsigned char data[1024 + 8];
+        srand(4711);
+        for (unsigned int i = 0; i < sizeof(data); ++i)
+            data[i] = rand();
+
+        // all alignments and lengths around the word size
+        for (int offset = 0; offset < 4; ++offset)
+        {
+            for (unsigned int count = 0; count < 24; ++count)
+            {
+                INFO("offset " << offset << " count " << count);
+                REQUIRE(impl.crc32(0xFFFFFFFF, data + offset, count) == crc32Bitwise(0xFFFFFFFF, data + offset, count));
+            }
+            REQUIRE(impl.crc32(0xFFFFFFFF, data + offset, 1024) == crc32Bitwise(0xFFFFFFFF, data + offset, 1024));
+            REQUIRE(impl.crc32(0x12345678, data + offset, 1023) == crc32Bitwise(0x12345678, data + offset, 1023));
+        }
+    }
+}
+
+TEST_CASE("Benchmark bootloader crc32 of an application image","[.][benchmark][BOOTLOADER][CRC]")
+{
+    const unsigned int imageSize = 0xD000; // application area behind the release bootloader
+    const int rounds = 200;
+    static unsigned char image[imageSize];
+    for (unsigned int i = 0; i < imageSize; ++i)
+        image[i] = i * 13 + (i >> 8);
+
+    volatile unsigned int sink = 0;
+
+    auto startTime = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+        sink = sink + crc32Bitwise(0xFFFFFFFF, image, imageSize);
+    auto bitwiseTime = std::chrono::steady_clock::now() - startTime;
+
+    using std::chrono::microseconds;
+    using std::chrono::duration_cast;
+    printf("crc32 of %u bytes (%d rounds):\n", imageSize, rounds);
+    printf("  %-22s %lld us\n", "bitwise", (long long) duration_cast<microseconds>(bitwiseTime).count());
+
+    for (const auto& impl : implementations)
+    {
+        startTime = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r)
+            sink = sink + impl.crc32(0xFFFFFFFF, image, imageSize);
+        auto tableTime = std::chrono::steady_clock::now() - startTime;
+
+        REQUIRE(impl.crc32(0xFFFFFFFF, image, imageSize) == crc32Bitwise(0xFFFFFFFF, image, imageSize));
+        printf("  %-22s %lld us\n", impl.name, (long long) duration_cast<microseconds>(tableTime).count());
+    }
+}
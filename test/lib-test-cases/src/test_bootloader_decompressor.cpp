@@ -0,0 +1,232 @@
+/*
+ *  test_bootloader_decompressor.cpp - Round trip tests for the differential decompressor of the bootloader
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "catch.hpp"
+#include "iap_emu.h"
+#include <sblib/internal/iap.h>
+#include "boot_descriptor_block.h"
+#include "decompressor.h"
+#include "crc.h"
+#include "diff_encoder.h"
+#include <string.h>
+
+static const unsigned int flashAreaSize = 0x2000; // modeled part of the application area
+
+static void flashImage(const Bytes& image)
+{
+    static byte page[FLASH_PAGE_SIZE] __attribute__ ((aligned (FLASH_RAM_BUFFER_ALIGNMENT)));
+    byte* start = applicationFirstAddress();
+    for (unsigned int offset = 0; offset < image.size(); offset += FLASH_PAGE_SIZE)
+    {
+        memset(page, 0xff, sizeof(page));
+        memcpy(page, &image[offset], std::min<unsigned int>(FLASH_PAGE_SIZE, image.size() - offset));
+        REQUIRE(iapProgram(start + offset, page, FLASH_PAGE_SIZE) == IAP_SUCCESS);
+    }
+}
+
+/*
+ * Statistics of one round trip.
+ */
+struct RoundTripResult
+{
+    unsigned int streamSize;
+    unsigned int iapCalls;
+    unsigned int iapCallsSaved;
+};
+
+/*
+ * Flash oldImage, then transfer newImage page by page through the decompressor
+ * like @ref UPD_SEND_DATA_TO_DECOMPRESS and @ref UPD_PROGRAM_DECOMPRESSED_DATA do.
+ */
+static RoundTripResult roundTrip(const Bytes& oldImage, const Bytes& newImage, DiffEncoder& encoder)
+{
+    RoundTripResult result;
+    IAP_Init_Flash(0xFF);
+    flashImage(oldImage);
+    byte* start = applicationFirstAddress();
+    encoder.rom.assign(start, start + flashAreaSize);
+    unsigned int busySpansBefore = iap_stats.busySpanCount;
+
+    Decompressor decompressor((AppDescriptionBlock*) bootDescriptorBlockAddress());
+    REQUIRE(decompressor.getStartAddrOfPageToBeFlashed() == start);
+
+    result.streamSize = 0;
+    for (unsigned int pageStart = 0; pageStart < newImage.size(); pageStart += FLASH_PAGE_SIZE)
+    {
+        Bytes stream = encoder.encodePage(newImage, pageStart, newImage.size());
+        result.streamSize += stream.size();
+        for (uint8_t b : stream)
+            REQUIRE(decompressor.putByte(b) == UDP_IAP_SUCCESS);
+
+        unsigned int count = std::min<unsigned int>(FLASH_PAGE_SIZE, newImage.size() - pageStart);
+        REQUIRE(decompressor.getBytesCountToBeFlashed() == count);
+        REQUIRE(decompressor.getCrc32() == crc32(0xFFFFFFFF, (uint8_t*) &newImage[pageStart], count));
+        REQUIRE(decompressor.pageCompletedDoFlash() == UDP_IAP_SUCCESS);
+    }
+    REQUIRE(decompressor.flush() == UDP_IAP_SUCCESS);
+    REQUIRE(memcmp(start, &newImage[0], newImage.size()) == 0);
+    result.iapCalls = iap_stats.busySpanCount - busySpansBefore;
+    result.iapCallsSaved = decompressor.getIapCallsSaved();
+    return result;
+}
+
+TEST_CASE("Differential decompressor round trip","[BOOTLOADER][DECOMPRESSOR]")
+{
+    Bytes oldImage = randomImage(0x1800, 4711);
+    DiffEncoder encoder;
+    RoundTripResult result;
+
+    SECTION("Unchanged image is not flashed")
+    {
+        result = roundTrip(oldImage, oldImage, encoder);
+        REQUIRE(encoder.ramCopies == 0);
+        REQUIRE(result.iapCalls == 0);
+        REQUIRE(result.streamSize < oldImage.size() / 32);
+    }
+
+    SECTION("Inserted bytes shift the image into already overwritten pages")
+    {
+        Bytes newImage(oldImage);
+        newImage.insert(newImage.begin() + 0x10, 40, 0x5a);
+
+        result = roundTrip(oldImage, newImage, encoder);
+        // the ring wrapped around several times
+        REQUIRE(encoder.ramCopies > 2 * REMEMBER_OLD_PAGES_COUNT);
+        REQUIRE(result.streamSize < newImage.size() / 8);
+    }
+
+    SECTION("Removed bytes reference pages not yet overwritten")
+    {
+        Bytes newImage(oldImage);
+        newImage.erase(newImage.begin() + 0x10, newImage.begin() + 0x30);
+
+        result = roundTrip(oldImage, newImage, encoder);
+        REQUIRE(encoder.romCopies > 0);
+        REQUIRE(result.streamSize < newImage.size() / 8);
+    }
+
+    SECTION("Old code behind the end of a smaller new image is referenced")
+    {
+        // the new image consists of the last part of the old one
+        Bytes newImage(oldImage.begin() + 0x1000, oldImage.end());
+        newImage[0x123] ^= 0xff;
+
+        result = roundTrip(oldImage, newImage, encoder);
+        REQUIRE(encoder.romCopiesBehindImage > 0);
+        REQUIRE(result.streamSize < newImage.size() / 8);
+    }
+
+    SECTION("Consecutive changed pages are flashed together")
+    {
+        // pages 1 to 6 change, the same new content is repeated in the pages 3 to 6
+        Bytes newImage(oldImage);
+        Bytes newPage = randomImage(FLASH_PAGE_SIZE, 42);
+        newImage[FLASH_PAGE_SIZE + 0x10] ^= 0xff;
+        newImage[2 * FLASH_PAGE_SIZE + 0x20] ^= 0xff;
+        for (unsigned int page = 3; page <= 6; ++page)
+            std::copy(newPage.begin(), newPage.end(), newImage.begin() + page * FLASH_PAGE_SIZE);
+
+        result = roundTrip(oldImage, newImage, encoder);
+        // the repeated pages are copied from pages not flashed yet
+        REQUIRE(encoder.romCopies > 0);
+        REQUIRE(result.streamSize < 4 * FLASH_PAGE_SIZE);
+
+        unsigned int firstPage = iapPageOfAddress(applicationFirstAddress());
+        for (unsigned int page = 0; page < 8; ++page)
+        {
+            INFO("page " << page);
+            REQUIRE(iap_stats.pageErases[firstPage + page] == ((page >= 1 && page <= 6) ? 1 : 0));
+        }
+        // 6 pages in batches of DECOMPRESSOR_BATCH_PAGES
+        unsigned int batches = (6 + DECOMPRESSOR_BATCH_PAGES - 1) / DECOMPRESSOR_BATCH_PAGES;
+        REQUIRE(result.iapCalls <= 3 * batches);
+        REQUIRE(result.iapCalls + result.iapCallsSaved == 2 * 6);
+    }
+
+    SECTION("Batches end at the sector boundary")
+    {
+        // change the last 2 pages of the first sector and the first 2 pages of the next one
+        Bytes newImage(oldImage);
+        unsigned int pagesPerSector = FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE;
+        for (unsigned int page = pagesPerSector - 2; page < pagesPerSector + 2; ++page)
+            newImage[page * FLASH_PAGE_SIZE + 7] ^= 0xff;
+
+        result = roundTrip(oldImage, newImage, encoder);
+        unsigned int firstPage = iapPageOfAddress(applicationFirstAddress());
+        for (unsigned int page = pagesPerSector - 3; page < pagesPerSector + 3; ++page)
+        {
+            INFO("page " << page);
+            REQUIRE(iap_stats.pageErases[firstPage + page] == ((page >= pagesPerSector - 2 && page < pagesPerSector + 2) ? 1 : 0));
+        }
+        // one erase and one program per sector
+        REQUIRE(result.iapCalls + result.iapCallsSaved == 2 * 4);
+        REQUIRE(result.iapCalls == (DECOMPRESSOR_BATCH_PAGES >= 2 ? 4 : 8));
+    }
+
+    SECTION("Partial last page")
+    {
+        Bytes newImage(oldImage.begin(), oldImage.end() - 0x23);
+        newImage[0x345] ^= 0x01;
+
+        result = roundTrip(oldImage, newImage, encoder);
+    }
+
+    IAP_Init_Flash(0xFF);
+}
+
+TEST_CASE("Differential decompressor rejects invalid commands","[BOOTLOADER][DECOMPRESSOR]")
+{
+    IAP_Init_Flash(0xFF);
+    Decompressor decompressor((AppDescriptionBlock*) bootDescriptorBlockAddress());
+
+    SECTION("Copy beyond the page")
+    {
+        // long copy of 0x101 bytes from the start of the flash
+        const uint8_t stream[] = { CMD_COPY | FLAG_LONG | 0x01, 0x01, 0x00, 0x00, 0x00 };
+        for (unsigned int i = 0; i < sizeof(stream) - 1; ++i)
+            REQUIRE(decompressor.putByte(stream[i]) == UDP_IAP_SUCCESS);
+        REQUIRE(decompressor.putByte(stream[sizeof(stream) - 1]) == UDP_RAM_BUFFER_OVERFLOW);
+        REQUIRE(decompressor.getBytesCountToBeFlashed() == 0);
+    }
+
+    SECTION("Raw data beyond the page")
+    {
+        REQUIRE(decompressor.putByte(CMD_RAW | FLAG_LONG | 0x01) == UDP_IAP_SUCCESS);
+        REQUIRE(decompressor.putByte(0x01) == UDP_IAP_SUCCESS);
+        for (unsigned int i = 0; i < FLASH_PAGE_SIZE; ++i)
+            REQUIRE(decompressor.putByte(i) == UDP_IAP_SUCCESS);
+        REQUIRE(decompressor.putByte(0) == UDP_RAM_BUFFER_OVERFLOW);
+        REQUIRE(decompressor.getBytesCountToBeFlashed() == FLASH_PAGE_SIZE);
+    }
+
+    SECTION("Copy from RAM behind the remembered pages")
+    {
+        unsigned int address = FLASH_PAGE_SIZE * REMEMBER_OLD_PAGES_COUNT - 4;
+        const uint8_t stream[] = { CMD_COPY | 8, ADDR_FROM_RAM, (uint8_t) (address >> 8), (uint8_t) address };
+        for (unsigned int i = 0; i < sizeof(stream) - 1; ++i)
+            REQUIRE(decompressor.putByte(stream[i]) == UDP_IAP_SUCCESS);
+        REQUIRE(decompressor.putByte(stream[sizeof(stream) - 1]) == UDP_INVALID_DATA);
+    }
+
+    SECTION("Copy from ROM behind the flash")
+    {
+        unsigned int address = flashLastAddress() - applicationFirstAddress() - 2;
+        const uint8_t stream[] = { CMD_COPY | 8, (uint8_t) (address >> 16), (uint8_t) (address >> 8), (uint8_t) address };
+        for (unsigned int i = 0; i < sizeof(stream) - 1; ++i)
+            REQUIRE(decompressor.putByte(stream[i]) == UDP_IAP_SUCCESS);
+        REQUIRE(decompressor.putByte(stream[sizeof(stream) - 1]) == UDP_INVALID_DATA);
+    }
+
+    SECTION("Stream continues after a rejected command")
+    {
+        const uint8_t stream[] = { CMD_COPY | 8, ADDR_FROM_RAM | 0x7f, 0xff, 0xff, CMD_RAW | 2, 0x12, 0x34 };
+        for (unsigned int i = 0; i < sizeof(stream); ++i)
+            decompressor.putByte(stream[i]);
+        REQUIRE(decompressor.getBytesCountToBeFlashed() == 2);
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ *  test_bootloader_flash.cpp - Tests for the flash programming of the bootloader
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "catch.hpp"
+#include "iap_emu.h"
+#include <sblib/internal/iap.h>
+#include "boot_descriptor_block.h"
+#include "flash.h"
+#include <string.h>
+
+extern unsigned char FLASH[];
+
+TEST_CASE("Program a flash range of several pages","[BOOTLOADER][FLASH]")
+{
+    static byte buffer[FLASH_SECTOR_SIZE] __attribute__ ((aligned (FLASH_RAM_BUFFER_ALIGNMENT)));
+    IAP_Init_Flash(0xFF);
+
+    // a sector in the application area
+    byte* sector = iapAddressOfSector(iapSectorOfAddress(applicationFirstAddress()) + 2);
+    unsigned int firstPage = iapPageOfAddress(sector);
+    REQUIRE(sector >= applicationFirstAddress());
+    for (unsigned int i = 0; i < sizeof(buffer); ++i)
+        buffer[i] = i * 7 + (i >> 8);
+
+    SECTION("A blank sector is programmed with a single IAP call")
+    {
+        REQUIRE(programFlashRange(sector, buffer, FLASH_SECTOR_SIZE) == UDP_IAP_SUCCESS);
+        REQUIRE(memcmp(sector, buffer, FLASH_SECTOR_SIZE) == 0);
+        REQUIRE(iap_stats.busySpanCount == 1);
+        REQUIRE(iap_stats.busySpans[0].function == I_RAM2FLASH);
+        REQUIRE(IAP_Max_Page_Erases() == 0);
+    }
+
+    SECTION("A used sector is erased with one sector erase")
+    {
+        REQUIRE(programFlashRange(sector, buffer, FLASH_SECTOR_SIZE) == UDP_IAP_SUCCESS);
+        buffer[0x123] ^= 0xff;
+        REQUIRE(programFlashRange(sector, buffer, FLASH_SECTOR_SIZE) == UDP_IAP_SUCCESS);
+        REQUIRE(memcmp(sector, buffer, FLASH_SECTOR_SIZE) == 0);
+
+        REQUIRE(iap_stats.busySpanCount == 3);
+        REQUIRE(iap_stats.busySpans[1].function == I_ERASE);
+        REQUIRE(iap_stats.busySpans[1].duration == IAP_ERASE_TIME_US);
+        for (unsigned int page = firstPage; page < firstPage + FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE; ++page)
+            REQUIRE(iap_stats.pageErases[page] == 1);
+    }
+
+    SECTION("Pages across a sector boundary are programmed per sector")
+    {
+        byte* start = sector + 13 * FLASH_PAGE_SIZE;
+        REQUIRE(programFlashRange(start, buffer, 5 * FLASH_PAGE_SIZE) == UDP_IAP_SUCCESS);
+        REQUIRE(memcmp(start, buffer, 5 * FLASH_PAGE_SIZE) == 0);
+
+        // 2 + 1 pages in the first sector, 2 pages in the next one
+        REQUIRE(iap_stats.busySpanCount == 3);
+        REQUIRE(iap_stats.busySpans[0].address == (unsigned int) (start - FLASH));
+        REQUIRE(iap_stats.busySpans[1].address == (unsigned int) (start - FLASH) + 2 * FLASH_PAGE_SIZE);
+        REQUIRE(iap_stats.busySpans[2].address == (unsigned int) (sector - FLASH) + FLASH_SECTOR_SIZE);
+        REQUIRE(iap_stats.bytesProgrammed == 5 * FLASH_PAGE_SIZE);
+    }
+
+    SECTION("Only whole pages of the application area are programmed")
+    {
+        REQUIRE(programFlashRange(sector + 4, buffer, FLASH_PAGE_SIZE) == UDP_ADDRESS_NOT_ALLOWED_TO_FLASH);
+        REQUIRE(programFlashRange(sector, buffer, FLASH_PAGE_SIZE + 4) == UDP_ADDRESS_NOT_ALLOWED_TO_FLASH);
+        REQUIRE(programFlashRange(bootDescriptorBlockAddress(), buffer, FLASH_PAGE_SIZE) == UDP_ADDRESS_NOT_ALLOWED_TO_FLASH);
+        REQUIRE(iap_stats.busySpanCount == 0);
+    }
+
+    IAP_Init_Flash(0xFF);
+}
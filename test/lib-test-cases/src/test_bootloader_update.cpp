@@ -0,0 +1,644 @@
+/*
+ *  test_bootloader_update.cpp - Recorded UPD sessions replayed against the update engine of the bootloader
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "catch.hpp"
+#include "iap_emu.h"
+#include <sblib/internal/iap.h>
+#include <sblib/eib/bus.h>
+#include "bcu_updater.h"
+#include "boot_descriptor_block.h"
+#include "crc.h"
+#include "diff_encoder.h"
+#include "flash.h"
+#include "upd_protocol.h"
+#include "update.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+BcuUpdate bcu; // the update engine sends its responses over the bus of the bootloader's bcu
+
+// TP1 bus model: 9600 bit/s, a character takes 13 bit times (11 bits and 2 bit times pause)
+#define BIT_TIME_US 104
+#define CHAR_BITS 13
+#define IDLE_BITS 50         // bus idle time in front of a frame
+#define ACK_BITS (15 + 13)   // data link layer acknowledge of a frame
+#define T_ACK_OCTETS 8       // transport layer acknowledge in connection oriented mode
+#define UPD_PAYLOAD 12       // Mcu.MAX_PAYLOAD of the PC updater tool
+
+/*
+ * A recorded update session, the UPD requests as sent by the PC updater tool.
+ * Every request starts with the @ref UPD_Code followed by its data.
+ */
+typedef std::vector<Bytes> UpdSession;
+
+/*
+ * Device side statistics of a replayed session.
+ */
+struct UpdSessionResult
+{
+    UDP_State error = UDP_IAP_SUCCESS; // error of the first failed request
+    unsigned int failedRequest = 0;
+    unsigned int telegrams = 0;        // requests sent to the device
+    unsigned int bytesTransferred = 0; // UPD bytes sent to the device, command codes included
+    unsigned int iapCalls = 0;         // erase and program calls
+    unsigned int iapBusyTime = 0;      // us
+    unsigned int busTime = 0;          // us, frames and acknowledges on the bus
+    unsigned int timeToFlash = 0;      // us, bus time and IAP time not overlapped by bus traffic
+    unsigned int iapCallsSaved = 0;    // as reported by UPD_RESPONSE_STATISTIC
+};
+
+// all values are streamed little endian, addresses relative to the flash base address.
+// The base is taken from the update engine, it is the emulated flash only if built with IAP_EMULATION.
+static void putUInt16(Bytes& request, unsigned int value)
+{
+    request.push_back(value);
+    request.push_back(value >> 8);
+}
+
+static void putUInt32(Bytes& request, uint32_t value)
+{
+    putUInt16(request, value);
+    putUInt16(request, value >> 16);
+}
+
+static void putAddress(Bytes& request, uint8_t* address)
+{
+    putUInt32(request, address - flashFirstAddress());
+}
+
+static unsigned int frameBusTime(unsigned int octets)
+{
+    return ((IDLE_BITS + octets * CHAR_BITS + ACK_BITS) * BIT_TIME_US);
+}
+
+/*
+ * Bus time of a request and its response, both confirmed by a T_ACK.
+ * A frame has 8 octets plus the UPD command and data, the response length is taken from sendBuffer[5].
+ */
+static unsigned int exchangeBusTime(unsigned int requestSize, uint8_t* sendBuffer)
+{
+    return (frameBusTime(8 + requestSize) + frameBusTime(T_ACK_OCTETS) +
+            frameBusTime(8 + (sendBuffer[5] & 0x0f)) + frameBusTime(T_ACK_OCTETS));
+}
+
+/*
+ * Replay the session like @ref BcuUpdate does for every received @ref APCI_USERMSG_MANUFACTURER_0.
+ * IAP calls of a request delay its response.
+ * Stops at the first request which is not answered with the expected response.
+ */
+static UpdSessionResult replaySession(const UpdSession& session)
+{
+    UpdSessionResult result;
+    unsigned int busySpansBefore = iap_stats.busySpanCount;
+    unsigned int busyTimeBefore = iap_stats.busyTime;
+
+    for (const Bytes& recorded : session)
+    {
+        uint8_t sendBuffer[32] = {0};
+        Bytes request(recorded); // the device may modify the received data
+        UPD_Code command = (UPD_Code) request[0];
+
+        unsigned int busyTime = iap_stats.busyTime;
+        REQUIRE(handleApciUsermsgManufacturer(sendBuffer, &request[0], request.size()));
+        unsigned int requestTime = iap_stats.busyTime - busyTime;
+
+        unsigned int busTime = exchangeBusTime(request.size(), sendBuffer);
+        ++result.telegrams;
+        result.bytesTransferred += request.size();
+        result.busTime += busTime;
+        result.timeToFlash += busTime + requestTime;
+
+        UPD_Code expected = UPD_SEND_LAST_ERROR;
+        if (command == UPD_REQUEST_BL_IDENTITY)
+            expected = UPD_RESPONSE_BL_IDENTITY;
+        else if (command == UPD_REQUEST_STATISTIC)
+            expected = UPD_RESPONSE_STATISTIC;
+        else if (command == UPD_REQUEST_PAGE_CRC)
+            expected = UPD_RESPONSE_PAGE_CRC;
+
+        UDP_State error = UDP_IAP_SUCCESS;
+        if (sendBuffer[8] == UPD_SEND_LAST_ERROR)
+            error = (UDP_State) sendBuffer[9];
+        else if (sendBuffer[8] != expected)
+            error = UDP_INVALID;
+        if (error != UDP_IAP_SUCCESS)
+        {
+            result.error = error;
+            result.failedRequest = result.telegrams - 1;
+            break;
+        }
+
+        if (command == UPD_REQUEST_STATISTIC)
+            result.iapCallsSaved = sendBuffer[9 + 4] | (sendBuffer[9 + 5] << 8);
+
+        // the bcu has processed the request, the bus is idle until the next one
+        bcu.bus->discardReceivedTelegram();
+    }
+    result.iapCalls = iap_stats.busySpanCount - busySpansBefore;
+    result.iapBusyTime = iap_stats.busyTime - busyTimeBefore;
+    return (result);
+}
+
+/*
+ * Recorder of the requests the PC updater tool sends for an update.
+ */
+struct UpdRecorder
+{
+    UpdSession session;
+    uint8_t* start = applicationFirstAddress();
+
+    void request(UPD_Code command, const Bytes& data = Bytes())
+    {
+        Bytes telegram(1, command);
+        telegram.insert(telegram.end(), data.begin(), data.end());
+        session.push_back(telegram);
+    }
+
+    // unlock the device with its UID and request the bootloader identity
+    void begin()
+    {
+        byte uid[IAP_UID_LENGTH];
+        REQUIRE(iapReadUID(uid) == IAP_SUCCESS);
+        request(UPD_UNLOCK_DEVICE, Bytes(uid, uid + UID_LENGTH_USED));
+        request(UPD_REQUEST_BL_IDENTITY, Bytes { 0xff, 0xff });
+    }
+
+    // send a block of the ram buffer with UPD_SEND_DATA and UPD_SEND_DATA_LONG_OFFSET
+    void sendData(const uint8_t* data, unsigned int length)
+    {
+        unsigned int index = 0;
+        while (index < length)
+        {
+            Bytes chunk;
+            UPD_Code command = UPD_SEND_DATA;
+            if (index > 0xff)
+            {
+                command = UPD_SEND_DATA_LONG_OFFSET;
+                putUInt16(chunk, index);
+            }
+            else
+                chunk.push_back(index);
+            unsigned int count = std::min<unsigned int>(UPD_PAYLOAD + 1 - chunk.size(), length - index);
+            chunk.insert(chunk.end(), data + index, data + index + count);
+            request(command, chunk);
+            index += count;
+        }
+    }
+
+    // full update, the image is sent in ram buffer sized blocks
+    void full(const Bytes& image)
+    {
+        Bytes range;
+        putAddress(range, start);
+        putAddress(range, start + image.size() - 1);
+        request(UPD_ERASE_ADDRESSRANGE, range);
+
+        for (unsigned int offset = 0; offset < image.size(); offset += RAM_BUFFER_SIZE)
+            program(image, offset, std::min<unsigned int>(RAM_BUFFER_SIZE, image.size() - offset));
+    }
+
+    // full update which skips the pages already on the device, found by UPD_REQUEST_PAGE_CRC.
+    // Every run of changed pages is erased with one UPD_ERASE_ADDRESSRANGE.
+    void fullSkipUnchanged(const Bytes& image, const Bytes& deviceImage)
+    {
+        unsigned int pageCount = (image.size() + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+        for (unsigned int page = 0; page < pageCount; page += UPD_PAGE_CRC_MAX_COUNT)
+        {
+            Bytes data;
+            putAddress(data, start + page * FLASH_PAGE_SIZE);
+            data.push_back(std::min<unsigned int>(UPD_PAGE_CRC_MAX_COUNT, pageCount - page));
+            data.push_back(1);
+            request(UPD_REQUEST_PAGE_CRC, data);
+        }
+
+        unsigned int page = 0;
+        while (page < pageCount)
+        {
+            if (pageUnchanged(image, deviceImage, page * FLASH_PAGE_SIZE, image.size()))
+            {
+                ++page;
+                continue;
+            }
+            unsigned int runStart = page;
+            while ((page < pageCount) && !pageUnchanged(image, deviceImage, page * FLASH_PAGE_SIZE, image.size()))
+                ++page;
+            Bytes range;
+            putAddress(range, start + runStart * FLASH_PAGE_SIZE);
+            putAddress(range, start + page * FLASH_PAGE_SIZE - 1);
+            request(UPD_ERASE_ADDRESSRANGE, range);
+        }
+
+        for (unsigned int offset = 0; offset < image.size(); offset += RAM_BUFFER_SIZE)
+        {
+            unsigned int first = offset;
+            unsigned int last = std::min<unsigned int>(offset + RAM_BUFFER_SIZE, image.size());
+            while ((first < last) && pageUnchanged(image, deviceImage, first, last))
+                first = std::min<unsigned int>(first + FLASH_PAGE_SIZE, last);
+            while (last > first)
+            {
+                unsigned int lastPageStart = offset + ((last - offset - 1) / FLASH_PAGE_SIZE) * FLASH_PAGE_SIZE;
+                if (!pageUnchanged(image, deviceImage, lastPageStart, last))
+                    break;
+                last = lastPageStart;
+            }
+            if (first < last)
+                program(image, first, last - first);
+        }
+    }
+
+    static bool pageUnchanged(const Bytes& image, const Bytes& deviceImage, unsigned int pageStart, unsigned int end)
+    {
+        unsigned int count = std::min<unsigned int>(FLASH_PAGE_SIZE, end - pageStart);
+        // the device programs whole pages, the rest of the last page stays erased
+        Bytes page(FLASH_PAGE_SIZE, 0xff);
+        std::copy(image.begin() + pageStart, image.begin() + pageStart + count, page.begin());
+        return ((pageStart + FLASH_PAGE_SIZE <= deviceImage.size()) &&
+                std::equal(page.begin(), page.end(), deviceImage.begin() + pageStart));
+    }
+
+    void program(const Bytes& image, unsigned int offset, unsigned int count)
+    {
+        sendData(&image[offset], count);
+        Bytes data;
+        putUInt16(data, count);
+        putAddress(data, start + offset);
+        putUInt32(data, crc32(0xFFFFFFFF, (uint8_t*) &image[offset], count));
+        request(UPD_PROGRAM, data);
+    }
+
+    // differential or compressed update, every page is sent as stream and then programmed
+    void decompress(const Bytes& image, DiffEncoder& encoder)
+    {
+        for (unsigned int pageStart = 0; pageStart < image.size(); pageStart += FLASH_PAGE_SIZE)
+        {
+            Bytes stream = encoder.encodePage(image, pageStart, image.size());
+            for (unsigned int i = 0; i < stream.size(); i += UPD_PAYLOAD + 1)
+                request(UPD_SEND_DATA_TO_DECOMPRESS,
+                        Bytes(stream.begin() + i, stream.begin() + std::min<unsigned int>(i + UPD_PAYLOAD + 1, stream.size())));
+
+            unsigned int count = std::min<unsigned int>(FLASH_PAGE_SIZE, image.size() - pageStart);
+            Bytes data;
+            putUInt32(data, crc32(0xFFFFFFFF, (uint8_t*) &image[pageStart], count));
+            request(UPD_PROGRAM_DECOMPRESSED_DATA, data);
+        }
+    }
+
+    // send the boot descriptor of the image and request the statistic
+    void end(const Bytes& image)
+    {
+        // the descriptor is streamed in the memory layout of the device, on a 64bit host with 8 byte pointers
+        AppDescriptionBlock descriptor;
+        memset(&descriptor, 0xff, sizeof(descriptor));
+        descriptor.startAddress = start;
+        descriptor.endAddress = start + image.size() - 1;
+        descriptor.crc = crc32(0xFFFFFFFF, (uint8_t*) &image[0], image.size());
+        descriptor.appVersionAddress = (char*) start + 0x40;
+        unsigned int size = offsetof(AppDescriptionBlock, appVersionAddress) + sizeof(descriptor.appVersionAddress);
+
+        sendData((uint8_t*) &descriptor, size);
+        Bytes data;
+        putUInt32(data, size);
+        putUInt32(data, crc32(0xFFFFFFFF, (uint8_t*) &descriptor, size));
+        request(UPD_UPDATE_BOOT_DESC, data);
+        request(UPD_REQUEST_STATISTIC);
+    }
+};
+
+/*
+ * Flash the application image with a full update session.
+ */
+static void installImage(const Bytes& image)
+{
+    UpdRecorder recorder;
+    recorder.begin();
+    recorder.full(image);
+    recorder.end(image);
+    REQUIRE(replaySession(recorder.session).error == UDP_IAP_SUCCESS);
+}
+
+static void requireInstalled(const Bytes& image)
+{
+    AppDescriptionBlock* block = (AppDescriptionBlock*) bootDescriptorBlockAddress();
+    REQUIRE(memcmp(applicationFirstAddress(), &image[0], image.size()) == 0);
+    REQUIRE(block->startAddress == applicationFirstAddress());
+    REQUIRE(block->endAddress == applicationFirstAddress() + image.size() - 1);
+    REQUIRE(checkApplication(block));
+}
+
+/*
+ * A model of the flash content relative to the application start, for the encoder
+ * and the page crc of the updater tool.
+ */
+static Bytes deviceImage(unsigned int size)
+{
+    size = (size + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1);
+    return (Bytes(applicationFirstAddress(), applicationFirstAddress() + size));
+}
+
+/*
+ * A new version of the image: some bytes inserted and a few scattered changes.
+ */
+static Bytes newVersion(const Bytes& image, unsigned int seed)
+{
+    Bytes result(image);
+    Bytes inserted = randomImage(48, seed);
+    result.insert(result.begin() + image.size() / 3, inserted.begin(), inserted.end());
+    srand(seed);
+    for (int i = 0; i < 16; ++i)
+        result[rand() % result.size()] ^= 0x10;
+    return (result);
+}
+
+/*
+ * An image with the repetitions of compiled code: random pieces of a small dictionary
+ * of instruction sequences mixed with random constants.
+ */
+static Bytes firmwareImage(unsigned int size, unsigned int seed)
+{
+    Bytes dictionary = randomImage(1024, seed);
+    Bytes image;
+    while (image.size() < size)
+    {
+        unsigned int length = 8 + rand() % 40;
+        unsigned int pos = rand() % (dictionary.size() - length);
+        image.insert(image.end(), dictionary.begin() + pos, dictionary.begin() + pos + length);
+        for (int i = rand() % 4; i > 0; --i)
+            image.push_back(rand());
+    }
+    image.resize(size);
+    return (image);
+}
+
+TEST_CASE("Update sessions replayed against the update engine","[BOOTLOADER][UPDATE]")
+{
+    IAP_Init_Flash(0xFF);
+    Bytes oldImage = randomImage(0x1480, 4711);
+    installImage(oldImage);
+    requireInstalled(oldImage);
+
+    Bytes newImage = newVersion(oldImage, 42);
+    UpdRecorder recorder;
+    recorder.begin();
+    UpdSessionResult result;
+
+    SECTION("Full update")
+    {
+        recorder.full(newImage);
+        recorder.end(newImage);
+        result = replaySession(recorder.session);
+        REQUIRE(result.error == UDP_IAP_SUCCESS);
+        requireInstalled(newImage);
+    }
+
+    SECTION("Full update skips the unchanged pages")
+    {
+        Bytes changed(oldImage);
+        changed[3 * FLASH_PAGE_SIZE + 5] ^= 0xff;
+        recorder.fullSkipUnchanged(changed, deviceImage(changed.size()));
+        recorder.end(changed);
+        result = replaySession(recorder.session);
+        REQUIRE(result.error == UDP_IAP_SUCCESS);
+        requireInstalled(changed);
+
+        // only the changed page is sent and erased
+        unsigned int firstPage = iapPageOfAddress(applicationFirstAddress());
+        REQUIRE(result.bytesTransferred < 2 * FLASH_PAGE_SIZE);
+        REQUIRE(iap_stats.pageErases[firstPage + 3] == iap_stats.pageErases[firstPage + 4] + 1);
+    }
+
+    SECTION("Full update erases a run of changed pages at once")
+    {
+        Bytes changed(oldImage);
+        for (unsigned int i = FLASH_PAGE_SIZE; i < changed.size(); ++i)
+            changed[i] ^= 0xff;
+        unsigned int firstPage = iapPageOfAddress(applicationFirstAddress());
+        unsigned int pageCount = (changed.size() + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+        std::vector<unsigned int> erasesBefore(iap_stats.pageErases + firstPage, iap_stats.pageErases + firstPage + pageCount);
+        int eraseCalls = iap_calls[I_ERASE];
+
+        recorder.fullSkipUnchanged(changed, deviceImage(changed.size()));
+        recorder.end(changed);
+        result = replaySession(recorder.session);
+        REQUIRE(result.error == UDP_IAP_SUCCESS);
+        requireInstalled(changed);
+
+        // every changed page is erased once, with the leading pages, the whole sectors
+        // and the trailing pages of the run, and one erase of the boot descriptor
+        REQUIRE(iap_stats.pageErases[firstPage] == erasesBefore[0]);
+        for (unsigned int page = 1; page < pageCount; ++page)
+            REQUIRE(iap_stats.pageErases[firstPage + page] == erasesBefore[page] + 1);
+        REQUIRE(iap_calls[I_ERASE] - eraseCalls <= 3 + 1);
+    }
+
+    SECTION("Differential update")
+    {
+        DiffEncoder encoder;
+        encoder.rom = deviceImage(newImage.size());
+        recorder.decompress(newImage, encoder);
+        recorder.end(newImage);
+        result = replaySession(recorder.session);
+        REQUIRE(result.error == UDP_IAP_SUCCESS);
+        requireInstalled(newImage);
+        REQUIRE(result.bytesTransferred < newImage.size() / 4);
+        REQUIRE((result.iapCallsSaved > 0) == (DECOMPRESSOR_BATCH_PAGES > 1));
+    }
+
+    SECTION("Compressed update without the old image")
+    {
+        DiffEncoder encoder;
+        encoder.oldImageKnown = false;
+        encoder.rom = deviceImage(newImage.size());
+        Bytes image(newImage);
+        std::copy(image.begin(), image.begin() + 0x400, image.begin() + 0x800); // something to compress
+        recorder.decompress(image, encoder);
+        recorder.end(image);
+        result = replaySession(recorder.session);
+        REQUIRE(result.error == UDP_IAP_SUCCESS);
+        requireInstalled(image);
+        REQUIRE(encoder.ramCopies == 0);
+        REQUIRE(encoder.romCopies > 0);
+    }
+
+    SECTION("Differential update with a wrong crc stops at the page")
+    {
+        DiffEncoder encoder;
+        encoder.rom = deviceImage(newImage.size());
+        recorder.decompress(newImage, encoder);
+        recorder.end(newImage);
+        unsigned int corrupted = 0;
+        while (recorder.session[corrupted][0] != UPD_PROGRAM_DECOMPRESSED_DATA)
+            ++corrupted;
+        recorder.session[corrupted][1] ^= 0xff;
+
+        result = replaySession(recorder.session);
+        REQUIRE(result.error == UDP_CRC_ERROR);
+        REQUIRE(result.failedRequest == corrupted);
+        // the application is not replaced
+        REQUIRE(checkApplication((AppDescriptionBlock*) bootDescriptorBlockAddress()));
+    }
+
+    IAP_Init_Flash(0xFF);
+}
+
+/*
+ * Send a UPD_REQUEST_PAGE_CRC for the pages from address on, the response is in sendBuffer.
+ */
+static void requestPageCrc(uint8_t* address, unsigned int crcCount, unsigned int pagesPerCrc, uint8_t* sendBuffer)
+{
+    Bytes request(1, UPD_REQUEST_PAGE_CRC);
+    putAddress(request, address);
+    request.push_back(crcCount);
+    request.push_back(pagesPerCrc);
+    memset(sendBuffer, 0, 32);
+    REQUIRE(handleApciUsermsgManufacturer(sendBuffer, &request[0], request.size()));
+    bcu.bus->discardReceivedTelegram();
+}
+
+static uint32_t responseCrc(const uint8_t* sendBuffer, unsigned int index)
+{
+    const uint8_t* crc = sendBuffer + 10 + index * sizeof(uint32_t);
+    return (crc[0] | (crc[1] << 8) | (crc[2] << 16) | ((uint32_t) crc[3] << 24));
+}
+
+TEST_CASE("Page crc32 request","[BOOTLOADER][UPDATE]")
+{
+    IAP_Init_Flash(0xFF);
+    Bytes image = randomImage(4 * FLASH_PAGE_SIZE, 1234);
+    installImage(image);
+    uint8_t* start = applicationFirstAddress();
+    uint8_t* lastPage = flashLastAddress() + 1 - FLASH_PAGE_SIZE;
+    uint8_t sendBuffer[32];
+
+    UpdRecorder recorder;
+    recorder.begin();
+    REQUIRE(replaySession(recorder.session).error == UDP_IAP_SUCCESS);
+
+    SECTION("Crc32 of single pages")
+    {
+        requestPageCrc(start, UPD_PAGE_CRC_MAX_COUNT, 1, sendBuffer);
+        REQUIRE(sendBuffer[8] == UPD_RESPONSE_PAGE_CRC);
+        REQUIRE(sendBuffer[9] == UPD_PAGE_CRC_MAX_COUNT);
+        for (unsigned int i = 0; i < UPD_PAGE_CRC_MAX_COUNT; i++)
+            REQUIRE(responseCrc(sendBuffer, i) == crc32(0xFFFFFFFF, &image[i * FLASH_PAGE_SIZE], FLASH_PAGE_SIZE));
+    }
+
+    SECTION("Crc32 of page groups")
+    {
+        requestPageCrc(start, 2, 2, sendBuffer);
+        REQUIRE(sendBuffer[8] == UPD_RESPONSE_PAGE_CRC);
+        REQUIRE(sendBuffer[9] == 2);
+        REQUIRE(responseCrc(sendBuffer, 0) == crc32(0xFFFFFFFF, &image[0], 2 * FLASH_PAGE_SIZE));
+        REQUIRE(responseCrc(sendBuffer, 1) == crc32(0xFFFFFFFF, &image[2 * FLASH_PAGE_SIZE], 2 * FLASH_PAGE_SIZE));
+    }
+
+    SECTION("Last page of the flash")
+    {
+        requestPageCrc(lastPage, 1, 1, sendBuffer);
+        REQUIRE(sendBuffer[8] == UPD_RESPONSE_PAGE_CRC);
+        REQUIRE(responseCrc(sendBuffer, 0) == crc32(0xFFFFFFFF, lastPage, FLASH_PAGE_SIZE));
+    }
+
+    SECTION("Pages behind the end of the flash")
+    {
+        requestPageCrc(lastPage, 2, 1, sendBuffer);
+        REQUIRE(sendBuffer[8] == UPD_SEND_LAST_ERROR);
+        REQUIRE(sendBuffer[9] == UDP_ADDRESS_NOT_ALLOWED_TO_FLASH);
+
+        requestPageCrc(lastPage, 1, 2, sendBuffer);
+        REQUIRE(sendBuffer[8] == UPD_SEND_LAST_ERROR);
+        REQUIRE(sendBuffer[9] == UDP_ADDRESS_NOT_ALLOWED_TO_FLASH);
+
+        requestPageCrc(flashLastAddress() + 1, 1, 1, sendBuffer);
+        REQUIRE(sendBuffer[8] == UPD_SEND_LAST_ERROR);
+        REQUIRE(sendBuffer[9] == UDP_ADDRESS_NOT_ALLOWED_TO_FLASH);
+    }
+
+    SECTION("Address not aligned to a page")
+    {
+        requestPageCrc(start + 4, 1, 1, sendBuffer);
+        REQUIRE(sendBuffer[8] == UPD_SEND_LAST_ERROR);
+        REQUIRE(sendBuffer[9] == UDP_ADDRESS_NOT_ALLOWED_TO_FLASH);
+    }
+
+    SECTION("Invalid number of crc32 or pages")
+    {
+        requestPageCrc(start, 0, 1, sendBuffer);
+        REQUIRE(sendBuffer[8] == UPD_SEND_LAST_ERROR);
+        REQUIRE(sendBuffer[9] == UDP_INVALID_DATA);
+
+        requestPageCrc(start, UPD_PAGE_CRC_MAX_COUNT + 1, 1, sendBuffer);
+        REQUIRE(sendBuffer[8] == UPD_SEND_LAST_ERROR);
+        REQUIRE(sendBuffer[9] == UDP_INVALID_DATA);
+
+        requestPageCrc(start, 1, 0, sendBuffer);
+        REQUIRE(sendBuffer[8] == UPD_SEND_LAST_ERROR);
+        REQUIRE(sendBuffer[9] == UDP_INVALID_DATA);
+    }
+
+    IAP_Init_Flash(0xFF);
+}
+
+static void printSessionResult(const char* name, const UpdSessionResult& result)
+{
+    printf("  %-28s %5u telegrams %6u bytes  IAP %3u calls %6u ms  bus %6.1f s  time to flash %6.1f s\n",
+           name, result.telegrams, result.bytesTransferred, result.iapCalls, result.iapBusyTime / 1000,
+           result.busTime / 1e6, result.timeToFlash / 1e6);
+}
+
+TEST_CASE("Benchmark update sessions","[.][benchmark][BOOTLOADER][UPDATE]")
+{
+    const unsigned int imageSize = 0x4000;
+    Bytes oldImage = firmwareImage(imageSize, 4711);
+    Bytes newImage = newVersion(oldImage, 42);
+
+    printf("Update of a %u byte application, %u byte ram buffer, TP1 frames and acknowledges only:\n",
+           (unsigned int) newImage.size(), RAM_BUFFER_SIZE);
+
+    struct Mode
+    {
+        const char* name;
+        int type;
+    } modes[] =
+    {
+        { "full, UPD_PROGRAM", 0 },
+        { "full, unchanged pages kept", 1 },
+        { "compressed", 2 },
+        { "differential", 3 },
+    };
+
+    for (const Mode& mode : modes)
+    {
+        IAP_Init_Flash(0xFF);
+        installImage(oldImage);
+        UpdRecorder recorder;
+        recorder.begin();
+        DiffEncoder encoder;
+        encoder.rom = deviceImage(newImage.size());
+        encoder.oldImageKnown = (mode.type == 3);
+        switch (mode.type)
+        {
+            case 0:
+                recorder.full(newImage);
+                break;
+            case 1:
+                recorder.fullSkipUnchanged(newImage, deviceImage(newImage.size()));
+                break;
+            default:
+                recorder.decompress(newImage, encoder);
+                break;
+        }
+        recorder.end(newImage);
+        UpdSessionResult result = replaySession(recorder.session);
+        REQUIRE(result.error == UDP_IAP_SUCCESS);
+        requireInstalled(newImage);
+        printSessionResult(mode.name, result);
+    }
+
+    IAP_Init_Flash(0xFF);
+}
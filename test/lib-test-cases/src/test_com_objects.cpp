@@ -0,0 +1,153 @@
+/*
+ *  test_com_objects.cpp - Tests for the group read requests of the communication objects
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "protocol.h"
+
+#define OBJ_FLAGS_RAM 0x58 // RAM flags of the com-objects, the values are at 0x50..0x52
+
+static void tc_eepromSetup(void)
+{
+    // group addresses 1/0/1 and 1/0/2
+    bcuUnderTest->userEeprom->addrTabSize() = 3;
+    bcuUnderTest->userEeprom->userEepromData[0x119 - EEPROM_START] = 0x08;
+    bcuUnderTest->userEeprom->userEepromData[0x11A - EEPROM_START] = 0x01;
+    bcuUnderTest->userEeprom->userEepromData[0x11B - EEPROM_START] = 0x08;
+    bcuUnderTest->userEeprom->userEepromData[0x11C - EEPROM_START] = 0x02;
+
+    // objects 0 and 1 are associated with 1/0/1, object 2 with 1/0/2 (index 0 is the own address)
+    bcuUnderTest->userEeprom->assocTabPtr() = 0x20;
+    bcuUnderTest->userEeprom->userEepromData[0x120 - EEPROM_START] = 3;
+    bcuUnderTest->userEeprom->userEepromData[0x121 - EEPROM_START] = 1;
+    bcuUnderTest->userEeprom->userEepromData[0x122 - EEPROM_START] = 0;
+    bcuUnderTest->userEeprom->userEepromData[0x123 - EEPROM_START] = 1;
+    bcuUnderTest->userEeprom->userEepromData[0x124 - EEPROM_START] = 1;
+    bcuUnderTest->userEeprom->userEepromData[0x125 - EEPROM_START] = 2;
+    bcuUnderTest->userEeprom->userEepromData[0x126 - EEPROM_START] = 2;
+
+    // three 1 bit objects, transmit + write + read + communication enabled, priority low
+    bcuUnderTest->userEeprom->commsTabPtr() = 0x30;
+    bcuUnderTest->userEeprom->userEepromData[0x130 - EEPROM_START] = 3;
+    bcuUnderTest->userEeprom->userEepromData[0x131 - EEPROM_START] = OBJ_FLAGS_RAM;
+    for (int objno = 0; objno < 3; ++objno)
+    {
+        bcuUnderTest->userEeprom->userEepromData[0x132 + objno * 3 - EEPROM_START] = 0x50 + objno;
+        bcuUnderTest->userEeprom->userEepromData[0x133 + objno * 3 - EEPROM_START] = 0x5F;
+        bcuUnderTest->userEeprom->userEepromData[0x134 + objno * 3 - EEPROM_START] = BIT_1;
+    }
+}
+
+static void tc_setup(Telegram* tel, uint16_t telCount)
+{
+    bcuUnderTest->setOwnAddress(0x1112); // set own address to 1.1.18
+    telegramPreparation(bcuUnderTest, tel, telCount);
+}
+
+static int objectFlags(int objno)
+{
+    byte flags = bcuUnderTest->comObjects->objectFlagsTable()[objno >> 1];
+    return (objno & 1) ? flags >> 4 : flags & 0x0f;
+}
+
+static void requestReads(void * state, unsigned int var)
+{
+    bcuUnderTest->comObjects->requestObjectRead(0);
+    bcuUnderTest->comObjects->requestObjectRead(1);
+}
+
+static void checkSecondReadWaits(void * state, unsigned int var)
+{
+    REQUIRE((objectFlags(0) & (COMFLAG_TRANS_MASK | COMFLAG_DATAREQ)) == COMFLAG_ERROR); // transmitted
+    REQUIRE((objectFlags(1) & (COMFLAG_TRANS_MASK | COMFLAG_DATAREQ)) == (COMFLAG_TRANSREQ | COMFLAG_DATAREQ));
+    REQUIRE(bcuUnderTest->comObjects->isGroupReadPending(0x0801));
+}
+
+static void checkReadsCompleted(void * state, unsigned int var)
+{
+    REQUIRE((objectFlags(1) & (COMFLAG_TRANS_MASK | COMFLAG_DATAREQ)) == COMFLAG_OK);
+    REQUIRE((objectFlags(0) & COMFLAG_UPDATE) == COMFLAG_UPDATE);
+    REQUIRE((objectFlags(1) & COMFLAG_UPDATE) == COMFLAG_UPDATE);
+    REQUIRE(bcuUnderTest->comObjects->objectRead(0) == 1);
+    REQUIRE(bcuUnderTest->comObjects->objectRead(1) == 1);
+    REQUIRE(!bcuUnderTest->comObjects->isGroupReadPending(0x0801));
+}
+
+static void requestOtherRead(void * state, unsigned int var)
+{
+    bcuUnderTest->comObjects->requestObjectRead(2);
+}
+
+static Telegram testCaseTelegrams_Coalesced[] =
+{
+    {TIMER_TICK, 100, 4, 0, requestReads},
+    // 1. only one GroupValueRead 1/0/1 for the objects 0 and 1
+    {TEL_TX,       8, 0, 0, NULL, {0xBC, 0x11, 0x12, 0x08, 0x01, 0xE1, 0x00, 0x00}},
+    {TIMER_TICK, 100, 4, 0, checkSecondReadWaits},
+    {CHECK_TX_BUFFER, 0, 0, 0},
+    // 2. a read of another group address is not held back
+    {TIMER_TICK, 100, 4, 0, requestOtherRead},
+    {TEL_TX,       8, 0, 0, NULL, {0xBC, 0x11, 0x12, 0x08, 0x02, 0xE1, 0x00, 0x00}},
+    // 3. GroupValueResponse 1/0/1 from 1.0.1 updates both objects and completes the waiting request
+    {TEL_RX,       8, 0, 0, checkReadsCompleted, {0xBC, 0x10, 0x01, 0x08, 0x01, 0xE1, 0x00, 0x41}},
+    {TIMER_TICK, 100, 4, 0, NULL},
+    {CHECK_TX_BUFFER, 0, 0, 0},
+    {END}
+};
+
+static Telegram testCaseTelegrams_Timeout[] =
+{
+    {TIMER_TICK, 100, 4, 0, requestReads},
+    {TEL_TX,       8, 0, 0, NULL, {0xBC, 0x11, 0x12, 0x08, 0x01, 0xE1, 0x00, 0x00}},
+    // 1. no response, the waiting request is held back until the timeout
+    {TIMER_TICK, PENDING_GROUP_READ_TIMEOUT_MS - 200, 4, 0, checkSecondReadWaits},
+    {CHECK_TX_BUFFER, 0, 0, 0},
+    // 2. after the timeout the read is sent again for object 1
+    {TIMER_TICK, 300, 4, 0, NULL},
+    {TEL_TX,       8, 0, 0, NULL, {0xBC, 0x11, 0x12, 0x08, 0x01, 0xE1, 0x00, 0x00}},
+    {TIMER_TICK, 100, 4, 0, NULL},
+    {CHECK_TX_BUFFER, 0, 0, 0},
+    {END}
+};
+
+static Test_Case testCaseCoalesced =
+{
+  "Group read requests coalesced",
+  0x0004, 0x2060, 0x01,
+  0,    //powerOnDelay
+  tc_eepromSetup,
+  tc_setup,
+  NULL,
+  NULL,
+  NULL,
+  testCaseTelegrams_Coalesced
+};
+
+static Test_Case testCaseTimeout =
+{
+  "Group read request timeout",
+  0x0004, 0x2060, 0x01,
+  0,    //powerOnDelay
+  tc_eepromSetup,
+  tc_setup,
+  NULL,
+  NULL,
+  NULL,
+  testCaseTelegrams_Timeout
+};
+
+TEST_CASE("Group read requests of com-objects","[SBLIB][COM_OBJECTS]")
+{
+    SECTION("Objects of one group address send one read request")
+    {
+        executeTest(BCU_1, &testCaseCoalesced);
+    }
+
+    SECTION("Waiting read request is sent after the timeout")
+    {
+        executeTest(BCU_1, &testCaseTimeout);
+    }
+}
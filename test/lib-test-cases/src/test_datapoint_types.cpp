@@ -10,6 +10,7 @@
 
 #include "catch.hpp"
 #include <sblib/eib/datapoint_types.h>
+#include <sblib/eib/dpt_codecs.h>
 
 #include <limits.h>
 
@@ -59,3 +60,97 @@ TEST_CASE("Datapoint type conversion: dpt9ToFloat","[SBLIB]")
     REQUIRE(-4096 == dpt9ToFloat(0x8800));
     REQUIRE(-67108864 == dpt9ToFloat(0xf800));
 }
+
+// Reference implementation of the DPT9 encoding with a shift loop
+static unsigned short refFloatToDpt9(int value)
+{
+    int exp = 0;
+
+    if (value < -67108864 || value > 67076096)
+        return 0x7fff;
+
+    while (value < -2048 || value > 2047)
+    {
+        value >>= 1;
+        ++exp;
+    }
+    return (value < 0 ? 0x8000 : 0) | (((unsigned int) value) & 2047) | (exp << 11);
+}
+
+// Reference implementation of the DPT9 decoding with a shift loop
+static int refDpt9ToFloat(unsigned short dptValue)
+{
+    int exp = (dptValue >> 11) & 15;
+    int value;
+
+    if (dptValue == 0x7fff)
+        return INVALID_DPT_FLOAT;
+
+    if (dptValue >= 0x8000)
+        value = dptValue | (-1L & ~2047);
+    else value = dptValue & 2047;
+
+    for (; exp; --exp)
+        value <<= 1;
+
+    return value;
+}
+
+TEST_CASE("Datapoint type codec: Dpt9","[SBLIB]")
+{
+    for (int value = -67108865; value <= 67076097; value += 997)
+    {
+        REQUIRE(Dpt9::encode(value) == refFloatToDpt9(value));
+    }
+    for (int value = -5000; value <= 5000; ++value)
+    {
+        REQUIRE(Dpt9::encode(value) == refFloatToDpt9(value));
+    }
+    for (unsigned int raw = 0; raw <= 0xffff; ++raw)
+    {
+        REQUIRE(Dpt9::decode(raw) == refDpt9ToFloat(raw));
+        if (raw != Dpt9::invalid)
+        {
+            REQUIRE(Dpt9::encode(Dpt9::decode(raw)) == refFloatToDpt9(Dpt9::decode(raw)));
+        }
+    }
+}
+
+TEST_CASE("Datapoint type codec: integer types","[SBLIB]")
+{
+    REQUIRE(Dpt1::encode(true) == 1);
+    REQUIRE(Dpt1::decode(0) == false);
+
+    REQUIRE(Dpt3::encode(3) == 0x0b);
+    REQUIRE(Dpt3::encode(-3) == 0x03);
+    REQUIRE(Dpt3::encode(0) == 0x08);
+    for (int step = -7; step <= 7; ++step)
+    {
+        REQUIRE(Dpt3::decode(Dpt3::encode(step)) == step);
+    }
+
+    REQUIRE(Dpt5_001::encode(0) == 0);
+    REQUIRE(Dpt5_001::encode(50) == 128);
+    REQUIRE(Dpt5_001::encode(100) == 255);
+    REQUIRE(Dpt5_001::encode(200) == 255);
+    for (int percent = 0; percent <= 100; ++percent)
+    {
+        REQUIRE(Dpt5_001::decode(Dpt5_001::encode(percent)) == percent);
+    }
+
+    REQUIRE(Dpt6::encode(-1) == 0xff);
+    REQUIRE(Dpt6::decode(0x80) == -128);
+    REQUIRE(Dpt7::decode(Dpt7::encode(0xbeef)) == 0xbeef);
+    REQUIRE(Dpt8::encode(-2) == 0xfffe);
+    REQUIRE(Dpt8::decode(0x8000) == -32768);
+    REQUIRE(Dpt12::decode(Dpt12::encode(0xdeadbeef)) == 0xdeadbeef);
+    REQUIRE(Dpt13::decode(Dpt13::encode(-123456789)) == -123456789);
+    REQUIRE(Dpt232::encode(0x12345678) == 0x345678);
+}
+
+TEST_CASE("Datapoint type codec: Dpt14","[SBLIB]")
+{
+    REQUIRE(Dpt14::encode(1.0f) == 0x3f800000);
+    REQUIRE(Dpt14::encode(-2.5f) == 0xc0200000);
+    REQUIRE(Dpt14::decode(0x42f6e979) == 123.456f);
+}
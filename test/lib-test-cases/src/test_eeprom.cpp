@@ -193,3 +193,482 @@ TEST_CASE("Enhanced EEPROM tests","[EEPROM][SBLIB][ERASE]")
 }
 
 #endif
+
+static void fillPattern(UserEeprom& eeprom, byte seed)
+{
+    for (unsigned int i = 0; i < eeprom.size(); ++i)
+        eeprom[eeprom.startAddr() + i] = seed + i * 7;
+}
+
+TEST_CASE("Log-structured user EEPROM","[EEPROM][SBLIB]")
+{
+    IAP_Init_Flash(0xFF);
+    int iap_save[6];
+
+    UserEepromMASK0701 eeprom;
+    eeprom.setLogStructured(true);
+    REQUIRE(eeprom.isLogStructured());
+
+    // The first flush writes the base image
+    fillPattern(eeprom, 0x10);
+    memcpy(iap_save, iap_calls, sizeof(iap_calls));
+    eeprom.modified(true);
+    eeprom.writeUserEeprom();
+    REQUIRE(iap_calls[I_ERASE] == iap_save[I_ERASE] + 1);
+    REQUIRE_FALSE(eeprom.isModified());
+
+    SECTION("Small changes are appended without erasing")
+    {
+        memcpy(iap_save, iap_calls, sizeof(iap_calls));
+        eeprom[eeprom.startAddr() + 5] = 0xaa;
+        eeprom[eeprom.startAddr() + 1000] = 0x55;
+        eeprom.modified(true);
+        eeprom.writeUserEeprom();
+        REQUIRE(iap_calls[I_ERASE] == iap_save[I_ERASE]);
+        REQUIRE(iap_calls[I_RAM2FLASH] == iap_save[I_RAM2FLASH] + 1); // the records of both pages are programmed together
+
+        UserEepromMASK0701 replayed;
+        REQUIRE(memcmp(replayed.userEepromData, eeprom.userEepromData, eeprom.size()) == 0);
+    }
+
+    SECTION("Only the modified pages are written")
+    {
+        byte unmarked = eeprom[eeprom.startAddr() + 1000];
+        memcpy(iap_save, iap_calls, sizeof(iap_calls));
+        eeprom[eeprom.startAddr() + 5] = 0xaa;
+        eeprom[eeprom.startAddr() + 1000] = unmarked + 1;
+        eeprom.modified(eeprom.startAddr() + 5, 1);
+        REQUIRE(eeprom.isModified());
+        REQUIRE(eeprom.isPageModified(0));
+        REQUIRE_FALSE(eeprom.isPageModified(1000 / FLASH_PAGE_SIZE));
+        eeprom.writeUserEeprom();
+        REQUIRE(iap_calls[I_RAM2FLASH] == iap_save[I_RAM2FLASH] + 1);
+        REQUIRE_FALSE(eeprom.isPageModified(0));
+
+        UserEepromMASK0701 replayed;
+        REQUIRE(replayed[replayed.startAddr() + 5] == 0xaa);
+        REQUIRE(replayed[replayed.startAddr() + 1000] == unmarked);
+    }
+
+    SECTION("Unchanged content is not written")
+    {
+        unsigned int avoided = eeprom.avoidedWriteCount();
+        memcpy(iap_save, iap_calls, sizeof(iap_calls));
+        eeprom.modified(true);
+        eeprom.writeUserEeprom();
+        REQUIRE(iap_calls[I_ERASE] == iap_save[I_ERASE]);
+        REQUIRE(iap_calls[I_RAM2FLASH] == iap_save[I_RAM2FLASH]);
+        REQUIRE(eeprom.avoidedWriteCount() == avoided + 1);
+    }
+
+    SECTION("A full log is compacted")
+    {
+        int erases = iap_calls[I_ERASE];
+        int flushes = 0;
+        while (iap_calls[I_ERASE] == erases)
+        {
+            eeprom[eeprom.startAddr() + (flushes * 13) % eeprom.size()] ^= 0xff;
+            eeprom.modified(true);
+            eeprom.writeUserEeprom();
+            ++flushes;
+            REQUIRE(flushes < 1000);
+        }
+        REQUIRE(flushes > 50); // 3 log pages with 7 byte records
+
+        UserEepromMASK0701 replayed;
+        REQUIRE(memcmp(replayed.userEepromData, eeprom.userEepromData, eeprom.size()) == 0);
+    }
+
+    SECTION("An invalid record is ignored")
+    {
+        byte before = eeprom[eeprom.startAddr() + 20];
+        eeprom[eeprom.startAddr() + 20] = before + 1;
+        eeprom.modified(true);
+        eeprom.writeUserEeprom();
+
+        // corrupt the data byte of the record, the first record behind the base image
+        FLASH[FLASH_SIZE - SECTOR_SIZE + 3328 + USER_EEPROM_LOG_RECORD_HEADER_SIZE] ^= 0xff;
+
+        UserEepromMASK0701 replayed;
+        REQUIRE(replayed[replayed.startAddr() + 20] == before);
+
+        // the next flush starts a new base image
+        memcpy(iap_save, iap_calls, sizeof(iap_calls));
+        replayed.setLogStructured(true);
+        replayed[replayed.startAddr() + 21] = 0;
+        replayed.modified(true);
+        replayed.writeUserEeprom();
+        REQUIRE(iap_calls[I_ERASE] == iap_save[I_ERASE] + 1);
+    }
+
+    SECTION("Switching back to the default layout")
+    {
+        eeprom.setLogStructured(false);
+        eeprom.modified(true);
+        eeprom.writeUserEeprom();
+
+        UserEepromMASK0701 reread;
+        REQUIRE(memcmp(reread.userEepromData, eeprom.userEepromData, eeprom.size()) == 0);
+    }
+
+    IAP_Init_Flash(0xFF);
+}
+
+static int flushIncremental(UserEeprom& eeprom)
+{
+    int steps = 0;
+    bool done;
+
+    eeprom.startFlush();
+    REQUIRE(eeprom.isFlushing());
+    do
+    {
+        int erases = iap_calls[I_ERASE];
+        int programs = iap_calls[I_RAM2FLASH];
+        done = eeprom.flushStep();
+        REQUIRE((iap_calls[I_ERASE] - erases) + (iap_calls[I_RAM2FLASH] - programs) <= 1); // at most one flash operation per step
+        ++steps;
+        REQUIRE(steps < 100);
+    } while (!done);
+
+    REQUIRE_FALSE(eeprom.isFlushing());
+    return steps;
+}
+
+TEST_CASE("Incremental user EEPROM flush","[EEPROM][SBLIB]")
+{
+    IAP_Init_Flash(0xFF);
+
+    SECTION("Default layout")
+    {
+        UserEepromBCU2 eeprom;
+        fillPattern(eeprom, 0x20);
+        eeprom.modified(true);
+        REQUIRE(flushIncremental(eeprom) == 1 + 4 + 1); // erase, 4 slots and the page table
+
+        UserEepromBCU2 reread;
+        REQUIRE(memcmp(reread.userEepromData, eeprom.userEepromData, eeprom.size()) == 0);
+
+        // the changed page needs no erase
+        eeprom[eeprom.startAddr()] ^= 0xff;
+        eeprom.modified(true);
+        REQUIRE(flushIncremental(eeprom) == 1 + 1);
+    }
+
+    SECTION("Log-structured layout")
+    {
+        UserEepromMASK0701 eeprom;
+        eeprom.setLogStructured(true);
+        fillPattern(eeprom, 0x30);
+        eeprom.modified(true);
+        REQUIRE(flushIncremental(eeprom) == 1 + 3328 / FLASH_PAGE_SIZE); // erase and 13 pages of the base image
+
+        eeprom[eeprom.startAddr() + 3] ^= 0xff;
+        eeprom[eeprom.startAddr() + 2000] ^= 0xff;
+        eeprom.modified(true);
+        int programCalls = iap_calls[I_RAM2FLASH];
+        REQUIRE(flushIncremental(eeprom) == 1); // two records in one log page
+        REQUIRE(iap_calls[I_RAM2FLASH] == programCalls + 1);
+
+        // a changed range longer than a record is split into records in the following log pages
+        for (unsigned int i = 500; i < 900; ++i)
+            eeprom[eeprom.startAddr() + i] ^= 0x0f;
+        eeprom.modified(true);
+        REQUIRE(flushIncremental(eeprom) == 2 + 1);
+
+        UserEepromMASK0701 replayed;
+        REQUIRE(memcmp(replayed.userEepromData, eeprom.userEepromData, eeprom.size()) == 0);
+    }
+
+    SECTION("Modification during a flush")
+    {
+        UserEepromBCU2 eeprom;
+        fillPattern(eeprom, 0x40);
+        eeprom.modified(true);
+        eeprom.startFlush();
+        REQUIRE_FALSE(eeprom.isModified());
+        eeprom.flushStep(); // erase
+        eeprom.flushStep(); // first slot
+        eeprom[eeprom.startAddr() + 2 * FLASH_PAGE_SIZE + 10] ^= 0xff;
+        eeprom.modified(eeprom.startAddr() + 2 * FLASH_PAGE_SIZE + 10, 1);
+
+        // the flush restarts behind the programmed slot, without another erase
+        unsigned int sectorPage = iapPageOfAddress(eeprom.flashSectorAddress());
+        REQUIRE(flushIncremental(eeprom) == 1 + 4 + 1);
+        REQUIRE_FALSE(eeprom.isModified());
+        REQUIRE(iap_stats.pageErases[sectorPage] == 1);
+
+        UserEepromBCU2 reread;
+        REQUIRE(memcmp(reread.userEepromData, eeprom.userEepromData, eeprom.size()) == 0);
+
+        // the flash has the content of the end of the flush
+        eeprom.modified(true);
+        eeprom.writeUserEeprom();
+        REQUIRE(eeprom.avoidedWriteCount() == 1);
+    }
+
+    SECTION("Modification during a flush of log records")
+    {
+        UserEepromMASK0701 eeprom;
+        eeprom.setLogStructured(true);
+        fillPattern(eeprom, 0x48);
+        eeprom.modified(true);
+        eeprom.writeUserEeprom();
+
+        eeprom[eeprom.startAddr() + 3] ^= 0xff;
+        eeprom[eeprom.startAddr() + 2000] ^= 0xff;
+        eeprom.modified(true);
+        eeprom.startFlush();
+        eeprom.flushStep(); // first record
+        eeprom[eeprom.startAddr() + 1000] ^= 0xff;
+        eeprom.modified(eeprom.startAddr() + 1000, 1);
+        eeprom.writeUserEeprom();
+        REQUIRE_FALSE(eeprom.isModified());
+
+        UserEepromMASK0701 replayed;
+        REQUIRE(memcmp(replayed.userEepromData, eeprom.userEepromData, eeprom.size()) == 0);
+
+        eeprom.modified(true);
+        eeprom.writeUserEeprom();
+        REQUIRE(eeprom.avoidedWriteCount() == 1);
+    }
+
+    IAP_Init_Flash(0xFF);
+}
+
+TEST_CASE("Skip flush of unchanged user EEPROM","[EEPROM][SBLIB]")
+{
+    IAP_Init_Flash(0xFF);
+    int iap_save[6];
+
+    UserEepromBCU2 eeprom;
+    fillPattern(eeprom, 0x50);
+    eeprom.modified(true);
+    eeprom.writeUserEeprom();
+    REQUIRE(eeprom.avoidedWriteCount() == 0);
+
+    // Rewrite with the same values
+    memcpy(iap_save, iap_calls, sizeof(iap_calls));
+    eeprom[eeprom.startAddr() + 100] = eeprom[eeprom.startAddr() + 100];
+    eeprom.modified(true);
+    eeprom.writeUserEeprom();
+    REQUIRE_FALSE(eeprom.isModified());
+    REQUIRE(iap_calls[I_RAM2FLASH] == iap_save[I_RAM2FLASH]);
+    REQUIRE(eeprom.avoidedWriteCount() == 1);
+
+    // Unchanged after reading from flash
+    UserEepromBCU2 reread;
+    reread.modified(true);
+    reread.writeUserEeprom();
+    REQUIRE(iap_calls[I_RAM2FLASH] == iap_save[I_RAM2FLASH]);
+    REQUIRE(reread.avoidedWriteCount() == 1);
+
+    // A real change is written
+    eeprom[eeprom.startAddr() + 100] ^= 0xff;
+    eeprom.modified(true);
+    eeprom.writeUserEeprom();
+    REQUIRE(iap_calls[I_RAM2FLASH] > iap_save[I_RAM2FLASH]);
+    REQUIRE(eeprom.avoidedWriteCount() == 1);
+
+    // The flash content is compared, not only the CRC
+    memcpy(iap_save, iap_calls, sizeof(iap_calls));
+    FLASH[FLASH_SIZE - SECTOR_SIZE + 5 * FLASH_PAGE_SIZE + 200] ^= 0xff; // page 0 is in slot 5
+    eeprom.modified(true);
+    eeprom.writeUserEeprom();
+    REQUIRE(iap_calls[I_RAM2FLASH] > iap_save[I_RAM2FLASH]);
+
+    IAP_Init_Flash(0xFF);
+}
+
+TEST_CASE("User EEPROM page table","[EEPROM][SBLIB]")
+{
+    IAP_Init_Flash(0xFF);
+    const int numSlots = SECTOR_SIZE / FLASH_PAGE_SIZE - 1; // the first page holds the table
+    byte* sector = FLASH + FLASH_SIZE - SECTOR_SIZE;
+    byte* entries = sector + USER_EEPROM_TABLE_HEADER_SIZE;
+
+    UserEepromBCU1 eeprom;
+    byte expected[256];
+
+    // fill some slots, every flush appends an entry to the table
+    for (int i = 0; i < 5; ++i)
+    {
+        memcpy(expected, eeprom.userEepromData, sizeof(expected));
+        fillPattern(eeprom, i);
+        eeprom.modified(true);
+        eeprom.writeUserEeprom();
+        const byte* entry = entries + i * USER_EEPROM_TABLE_ENTRY_SIZE;
+        REQUIRE(entry[0] == i + 1); // slot
+        REQUIRE(entry[1] == 0);     // page of the user EEPROM
+        REQUIRE(entry[2] == 0);     // no more entries of this flush
+    }
+
+    SECTION("Newest slot is used")
+    {
+        UserEepromBCU1 reread;
+        REQUIRE(memcmp(reread.userEepromData, eeprom.userEepromData, 256) == 0);
+    }
+
+    SECTION("Fall back to the previous slot on a CRC error")
+    {
+        sector[5 * FLASH_PAGE_SIZE + 17] ^= 0x01;
+        UserEepromBCU1 reread;
+        REQUIRE(memcmp(reread.userEepromData, expected, 256) == 0);
+
+        // the table has an invalid entry, so the next flush erases the sector
+        int erases = iap_calls[I_ERASE];
+        reread[reread.startAddr()] ^= 0xff;
+        reread.modified(true);
+        reread.writeUserEeprom();
+        REQUIRE(iap_calls[I_ERASE] == erases + 1);
+        REQUIRE(entries[0] == 1);
+    }
+
+    SECTION("Superseded slots are not checked")
+    {
+        sector[1 * FLASH_PAGE_SIZE + 17] ^= 0x01; // slot of the first flush, replaced by the later ones
+        UserEepromBCU1 reread;
+        REQUIRE(memcmp(reread.userEepromData, eeprom.userEepromData, 256) == 0);
+
+        // the table is still valid, so the next flush appends its entry
+        int erases = iap_calls[I_ERASE];
+        reread[reread.startAddr()] ^= 0xff;
+        reread.modified(true);
+        reread.writeUserEeprom();
+        REQUIRE(iap_calls[I_ERASE] == erases);
+        REQUIRE(entries[5 * USER_EEPROM_TABLE_ENTRY_SIZE] == 6);
+    }
+
+    SECTION("Slots of an interrupted flush are not programmed again")
+    {
+        memset(sector + 6 * FLASH_PAGE_SIZE, 0x00, 100); // interrupted flush into slot 6, without table entry
+        UserEepromBCU1 reread;
+        REQUIRE(memcmp(reread.userEepromData, eeprom.userEepromData, 256) == 0);
+
+        reread[reread.startAddr()] ^= 0xff;
+        reread.modified(true);
+        reread.writeUserEeprom();
+        REQUIRE(entries[5 * USER_EEPROM_TABLE_ENTRY_SIZE] == 7);
+        REQUIRE(iap_stats.bitViolations == 0);
+    }
+
+    SECTION("Sector is erased when all slots are used")
+    {
+        int erases = iap_calls[I_ERASE];
+        for (int i = 5; i < numSlots; ++i)
+        {
+            eeprom[eeprom.startAddr() + 1] = i;
+            eeprom.modified(true);
+            eeprom.writeUserEeprom();
+        }
+        REQUIRE(iap_calls[I_ERASE] == erases);
+
+        eeprom[eeprom.startAddr() + 1] = 0x99;
+        eeprom.modified(true);
+        eeprom.writeUserEeprom();
+        REQUIRE(iap_calls[I_ERASE] == erases + 1);
+        REQUIRE(entries[0] == 1);
+
+        UserEepromBCU1 reread;
+        REQUIRE(reread[reread.startAddr() + 1] == 0x99);
+    }
+
+    SECTION("The pages of a flush are valid together")
+    {
+        IAP_Init_Flash(0xFF);
+        UserEepromBCU2 bcu2;
+        fillPattern(bcu2, 0x60);
+        bcu2.modified(true);
+        bcu2.writeUserEeprom();
+        byte first[1024];
+        memcpy(first, bcu2.userEepromData, sizeof(first));
+
+        for (unsigned int i = 0; i < sizeof(first); i += 100)
+            bcu2[bcu2.startAddr() + i] ^= 0xff;
+        bcu2.modified(true);
+        bcu2.writeUserEeprom();
+        for (int i = 0; i < 8; ++i)
+        {
+            INFO("entry " << i);
+            REQUIRE(entries[i * USER_EEPROM_TABLE_ENTRY_SIZE] == i + 1);
+            REQUIRE(entries[i * USER_EEPROM_TABLE_ENTRY_SIZE + 1] == i % 4);
+            REQUIRE(entries[i * USER_EEPROM_TABLE_ENTRY_SIZE + 2] == 3 - i % 4);
+        }
+
+        // a broken slot of the second flush invalidates all its pages
+        sector[7 * FLASH_PAGE_SIZE + 3] ^= 0x01;
+        UserEepromBCU2 reread;
+        REQUIRE(memcmp(reread.userEepromData, first, sizeof(first)) == 0);
+    }
+
+    SECTION("Only the changed pages are written")
+    {
+        IAP_Init_Flash(0xFF);
+        UserEepromBCU2 bcu2;
+        fillPattern(bcu2, 0x70);
+        bcu2.modified(true);
+        bcu2.writeUserEeprom();
+
+        int programs = iap_calls[I_RAM2FLASH];
+        bcu2[bcu2.startAddr() + 2 * FLASH_PAGE_SIZE + 5] ^= 0xff;
+        bcu2[bcu2.startAddr() + 3 * FLASH_PAGE_SIZE + 5] ^= 0xff;
+        bcu2.modified(bcu2.startAddr(), bcu2.size() - FLASH_PAGE_SIZE); // page 3 is not marked
+        bcu2.writeUserEeprom();
+        REQUIRE(iap_calls[I_RAM2FLASH] == programs + 2); // slot of page 2 and the table
+        const byte* entry = entries + 4 * USER_EEPROM_TABLE_ENTRY_SIZE;
+        REQUIRE(entry[0] == 5);
+        REQUIRE(entry[1] == 2);
+        REQUIRE(entry[2] == 0);
+
+        UserEepromBCU2 reread;
+        REQUIRE(memcmp(reread.userEepromData, bcu2.userEepromData, 3 * FLASH_PAGE_SIZE) == 0);
+        REQUIRE(reread[reread.startAddr() + 3 * FLASH_PAGE_SIZE + 5] != bcu2[bcu2.startAddr() + 3 * FLASH_PAGE_SIZE + 5]);
+
+        // all pages marked, only page 3 changed
+        bcu2.modified(true);
+        bcu2.writeUserEeprom();
+        REQUIRE(iap_calls[I_RAM2FLASH] == programs + 4);
+        REQUIRE(entry[USER_EEPROM_TABLE_ENTRY_SIZE + 1] == 3);
+    }
+
+    SECTION("Layout of older versions is read")
+    {
+        IAP_Init_Flash(0xFF);
+        memset(sector, 0x11, 256);
+        memset(sector + 256, 0x22, 256); // last byte != 0xff marks a used slot
+        UserEepromBCU1 reread;
+        REQUIRE(reread[reread.startAddr()] == 0x22);
+    }
+
+    SECTION("Slots of an interrupted first flush are not read as the older layout")
+    {
+        IAP_Init_Flash(0xFF);
+        UserEepromBCU2 bcu2;
+        fillPattern(bcu2, 0x40);
+        bcu2.modified(true);
+        bcu2.startFlush();
+        REQUIRE_FALSE(bcu2.flushStep()); // erase
+        for (int i = 0; i < 4; ++i)
+            REQUIRE_FALSE(bcu2.flushStep()); // slots of the pages, the table is not programmed
+        REQUIRE(entries[0] == 0xff);
+
+        UserEepromBCU2 reread;
+        for (unsigned int i = 0; i < reread.size(); ++i)
+        {
+            INFO("byte " << i);
+            REQUIRE(reread.userEepromData[i] == 0);
+        }
+
+        // the flash content is unknown, so the next flush is not skipped
+        int erases = iap_calls[I_ERASE];
+        reread.modified(true);
+        reread.writeUserEeprom();
+        REQUIRE(iap_calls[I_ERASE] == erases + 1);
+        REQUIRE(entries[0] == 1);
+
+        UserEepromBCU2 afterFlush;
+        REQUIRE(memcmp(afterFlush.userEepromData, reread.userEepromData, reread.size()) == 0);
+    }
+
+    IAP_Init_Flash(0xFF);
+}
@@ -0,0 +1,368 @@
+/*
+ *  test_flash_model.cpp - Tests for the flash model of the IAP emulation
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "catch.hpp"
+#include "iap_emu.h"
+#include <sblib/internal/iap.h>
+#include <sblib/interrupt.h>
+#include <sblib/timer.h>
+#include <sblib/mem_mapper.h>
+#include <sblib/eibBCU1.h>
+#include <sblib/eibBCU2.h>
+#include <sblib/eibMASK0701.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern unsigned char FLASH[];
+extern volatile unsigned int systemTime;
+extern "C" void IAP_Call(uintptr_t * cmd, uintptr_t * stat);
+
+TEST_CASE("Flash model of the IAP emulation","[SBLIB][IAP]")
+{
+    IAP_Init_Flash(0xFF);
+    static byte page[FLASH_PAGE_SIZE] __attribute__ ((aligned (FLASH_RAM_BUFFER_ALIGNMENT)));
+    byte* rom = FLASH + 0x8000;
+    unsigned int pageNumber = iapPageOfAddress(rom);
+
+    memset(page, 0x0f, sizeof(page));
+
+    SECTION("Erase and program are charged to the system time")
+    {
+        unsigned int startTime = systemTime;
+        REQUIRE(iapErasePage(pageNumber) == IAP_SUCCESS);
+        REQUIRE(systemTime - startTime == IAP_ERASE_TIME_US / 1000);
+        REQUIRE(iapProgram(rom, page, sizeof(page)) == IAP_SUCCESS);
+        REQUIRE(systemTime - startTime == (IAP_ERASE_TIME_US + IAP_PROGRAM_TIME_US) / 1000);
+
+        REQUIRE(iap_stats.busySpanCount == 2);
+        REQUIRE(iap_stats.busySpans[0].function == I_ERASE);
+        REQUIRE(iap_stats.busySpans[1].function == I_RAM2FLASH);
+        REQUIRE(iap_stats.busySpans[1].start == IAP_ERASE_TIME_US);
+        REQUIRE(iap_stats.busySpans[1].address == 0x8000);
+        REQUIRE(iap_stats.maxBusySpan == IAP_ERASE_TIME_US);
+        REQUIRE(iap_stats.busyTime == IAP_ERASE_TIME_US + IAP_PROGRAM_TIME_US);
+    }
+
+    SECTION("Erase counters per page")
+    {
+        REQUIRE(iapErasePage(pageNumber) == IAP_SUCCESS);
+        REQUIRE(iapErasePage(pageNumber) == IAP_SUCCESS);
+        REQUIRE(iapEraseSector(iapSectorOfAddress(rom)) == IAP_SUCCESS);
+        REQUIRE(iap_stats.pageErases[pageNumber] == 3);
+        REQUIRE(iap_stats.pageErases[pageNumber + 1] == 1);
+        REQUIRE(iap_stats.pageErases[pageNumber - 1] == 0);
+        REQUIRE(IAP_Max_Page_Erases() == 3);
+    }
+
+    SECTION("Programming cannot set bits")
+    {
+        REQUIRE(iapProgram(rom, page, sizeof(page)) == IAP_SUCCESS);
+        REQUIRE(iap_stats.bitViolations == 0);
+
+        // clearing more bits is possible without an erase
+        memset(page, 0x05, sizeof(page));
+        REQUIRE(iapProgram(rom, page, sizeof(page)) == IAP_SUCCESS);
+        REQUIRE(rom[0] == 0x05);
+
+        memset(page, 0xf0, sizeof(page));
+        REQUIRE(iapProgram(rom, page, sizeof(page)) == IAP_COMPARE_ERROR);
+        REQUIRE(rom[0] == 0x00);
+        REQUIRE(iap_stats.bitViolations == sizeof(page));
+    }
+
+    SECTION("Erase and program need a prepare")
+    {
+        uintptr_t cmd[5] = { 59, pageNumber, pageNumber, SystemCoreClock / 1000, 0 };
+        uintptr_t stat;
+        IAP_Call(cmd, &stat);
+        REQUIRE(stat == IAP_SECTOR_NOT_PREPARED_FOR_WRITE_OPERATION);
+        REQUIRE(iap_stats.pageErases[pageNumber] == 0);
+    }
+
+    SECTION("Program checks address and size")
+    {
+        REQUIRE(iapProgram(rom + 4, page, sizeof(page)) == IAP_DST_ADDR_ERROR);
+        REQUIRE(iapProgram(rom, page, 128) == IAP_COUNT_ERROR);
+        REQUIRE(iap_stats.bytesProgrammed == 0);
+    }
+
+    IAP_Init_Flash(0xFF);
+}
+
+TEST_CASE("Interrupt-off spans of the emulation","[SBLIB][IAP]")
+{
+    IAP_Init_Flash(0xFF);
+    unsigned int pageNumber = iapPageOfAddress(FLASH + 0x8000);
+
+    SECTION("Span from noInterrupts() to interrupts()")
+    {
+        noInterrupts();
+        systemTime += 5;
+        interrupts();
+        REQUIRE(irq_stats.offSpanCount == 1);
+        REQUIRE(irq_stats.offSpans[0].duration == 5000);
+        REQUIRE(irq_stats.maxOffSpan == 5000);
+        REQUIRE(irq_stats.offTime == 5000);
+        REQUIRE(iap_stats.busySpanCount == 0);
+    }
+
+    SECTION("Disabling again does not start a new span")
+    {
+        noInterrupts();
+        systemTime += 2;
+        noInterrupts();
+        systemTime += 3;
+        interrupts();
+        interrupts();
+        REQUIRE(irq_stats.offSpanCount == 1);
+        REQUIRE(irq_stats.offSpans[0].duration == 5000);
+    }
+
+    SECTION("Interrupts are disabled during a blocking IAP call")
+    {
+#ifdef IAP_KEEP_BUS_INTERRUPTS
+        REQUIRE(iapKeepInterrupts(0));
+#endif
+        REQUIRE(iapErasePage(pageNumber) == IAP_SUCCESS);
+        REQUIRE(iap_stats.maxBusySpan == IAP_ERASE_TIME_US);
+        REQUIRE(irq_stats.maxOffSpan >= IAP_ERASE_TIME_US);
+    }
+
+#ifdef IAP_KEEP_BUS_INTERRUPTS
+    SECTION("Interrupts in RAM stay enabled while the flash is busy")
+    {
+        REQUIRE(iapKeepInterrupts(1 << TIMER_16_1_IRQn));
+        REQUIRE(iapErasePage(pageNumber) == IAP_SUCCESS);
+        REQUIRE(iap_stats.maxBusySpan == IAP_ERASE_TIME_US);
+        REQUIRE(irq_stats.offSpanCount > 0);
+        REQUIRE(irq_stats.maxOffSpan < IAP_PROGRAM_TIME_US);
+        iapKeepInterrupts(0);
+        NVIC->ISER[0] = 0;
+        NVIC->ICER[0] = 0;
+    }
+#endif
+
+    IAP_Init_Flash(0xFF);
+}
+
+#ifdef IAP_KEEP_BUS_INTERRUPTS
+static bool busyDuringCall;
+static unsigned int disabledDuringCall;
+
+static void interruptDuringCall()
+{
+    busyDuringCall = iapBusy();
+    disabledDuringCall = NVIC->ICER[0];
+}
+
+TEST_CASE("Interrupts which stay enabled during IAP calls","[SBLIB][IAP]")
+{
+    IAP_Init_Flash(0xFF);
+    const unsigned int busInterrupt = 1 << TIMER_16_1_IRQn;
+    const unsigned int enabledInterrupts = busInterrupt | (1 << UART_IRQn);
+    unsigned int pageNumber = iapPageOfAddress(FLASH + 0x8000);
+
+    NVIC->ISER[0] = enabledInterrupts;
+    NVIC->ICER[0] = 0;
+    busyDuringCall = false;
+    disabledDuringCall = 0;
+    iap_busy_handler = interruptDuringCall;
+
+    SECTION("Only the registered interrupts stay enabled")
+    {
+        REQUIRE(iapKeepInterrupts(busInterrupt));
+        REQUIRE(iapErasePage(pageNumber) == IAP_SUCCESS);
+        REQUIRE(busyDuringCall);
+        REQUIRE(disabledDuringCall == ~busInterrupt);
+        REQUIRE(NVIC->ISER[0] == enabledInterrupts);
+        REQUIRE_FALSE(iapBusy());
+    }
+
+    SECTION("Without registered interrupts the NVIC is not touched")
+    {
+        REQUIRE(iapKeepInterrupts(0));
+        REQUIRE(iapErasePage(pageNumber) == IAP_SUCCESS);
+        REQUIRE(busyDuringCall);
+        REQUIRE(disabledDuringCall == 0);
+        REQUIRE_FALSE(iapBusy());
+    }
+
+    iap_busy_handler = nullptr;
+    iapKeepInterrupts(0);
+    NVIC->ISER[0] = 0;
+    NVIC->ICER[0] = 0;
+}
+
+static BCU1* lookupBcu;
+static int indexDuringCall;
+
+static void lookupDuringCall()
+{
+    busyDuringCall = iapBusy();
+    indexDuringCall = lookupBcu->addrTables->cachedIndexOfAddr(0x0A10);
+}
+
+TEST_CASE("Group address lookup during IAP calls","[SBLIB][IAP]")
+{
+    IAP_Init_Flash(0xFF);
+    const unsigned int busInterrupt = 1 << TIMER_16_1_IRQn;
+    unsigned int pageNumber = iapPageOfAddress(FLASH + 0x8000);
+
+    BCU1 bcu;
+    lookupBcu = &bcu;
+    byte* tab = &bcu.userEeprom->addrTabSize();
+    const byte sorted[] = { 4, 0x11, 0x01, 0x08, 0x01, 0x08, 0x05, 0x0A, 0x10 };
+    const byte unsorted[] = { 4, 0x11, 0x01, 0x0A, 0x10, 0x08, 0x05, 0x08, 0x01 };
+
+    SECTION("Sorted address table")
+    {
+        memcpy(tab, sorted, sizeof(sorted));
+        bcu.addrTables->rebuild();
+    }
+
+    SECTION("Unsorted address table")
+    {
+        memcpy(tab, unsorted, sizeof(unsorted));
+        bcu.addrTables->rebuild();
+    }
+
+    NVIC->ISER[0] = busInterrupt;
+    busyDuringCall = false;
+    indexDuringCall = 0;
+    iap_busy_handler = lookupDuringCall;
+
+    REQUIRE(iapKeepInterrupts(busInterrupt));
+    REQUIRE(iapErasePage(pageNumber) == IAP_SUCCESS);
+    REQUIRE(busyDuringCall);
+    REQUIRE(indexDuringCall == bcu.addrTables->indexOfAddr(0x0A10));
+    REQUIRE(indexDuringCall > 0);
+
+    iap_busy_handler = nullptr;
+    iapKeepInterrupts(0);
+    NVIC->ISER[0] = 0;
+    NVIC->ICER[0] = 0;
+}
+#endif
+
+/*
+ * Statistics of one benchmark run.
+ */
+struct WearResult
+{
+    unsigned int bytesChanged;
+    unsigned int bytesProgrammed;
+    unsigned int maxPageErases;
+    unsigned int busyTime;
+    unsigned int maxBusySpan;
+    unsigned int maxIrqOffSpan;
+};
+
+static void printWearResult(const char* name, const WearResult& result)
+{
+    printf("  %-26s amplification %6.1f, max page erases %4u, busy %7u ms, longest span %4u ms, interrupts off %6u us\n",
+           name, (double) result.bytesProgrammed / result.bytesChanged, result.maxPageErases,
+           result.busyTime / 1000, result.maxBusySpan / 1000, result.maxIrqOffSpan);
+}
+
+static WearResult collectWearResult(unsigned int bytesChanged)
+{
+    WearResult result;
+    result.bytesChanged = bytesChanged;
+    result.bytesProgrammed = iap_stats.bytesProgrammed;
+    result.maxPageErases = IAP_Max_Page_Erases();
+    result.busyTime = iap_stats.busyTime;
+    result.maxBusySpan = iap_stats.maxBusySpan;
+    result.maxIrqOffSpan = irq_stats.maxOffSpan;
+    return result;
+}
+
+/*
+ * Write a few random bytes into the user EEPROM and flush it, like a
+ * parameter change by ETS or the application.
+ */
+static WearResult userEepromWear(UserEeprom& eeprom, int rounds, int bytesPerRound)
+{
+    unsigned int changed = 0;
+
+    srand(42);
+    for (int r = 0; r < rounds; ++r)
+    {
+        for (int b = 0; b < bytesPerRound; ++b)
+        {
+            int address = eeprom.startAddr() + rand() % eeprom.size();
+            eeprom[address] = eeprom[address] + 1;
+            eeprom.modified(address, 1);
+            ++changed;
+        }
+        eeprom.writeUserEeprom();
+    }
+    return collectWearResult(changed);
+}
+
+TEST_CASE("Benchmark flash wear and bus blindness","[.][benchmark][IAP]")
+{
+    const int rounds = 500;
+    const int bytesPerRound = 4;
+
+#ifdef IAP_KEEP_BUS_INTERRUPTS
+    // keep the bus interrupt enabled during the IAP calls, like Bus::begin() does
+    const unsigned int busInterrupt = 1 << TIMER_16_1_IRQn;
+    REQUIRE(iapKeepInterrupts(busInterrupt));
+    NVIC->ISER[0] = busInterrupt;
+    printf("Flash wear for %d flushes of %d changed bytes, bus interrupt kept enabled:\n", rounds, bytesPerRound);
+#else
+    printf("Flash wear for %d flushes of %d changed bytes:\n", rounds, bytesPerRound);
+#endif
+
+    IAP_Init_Flash(0xFF);
+    {
+        UserEepromBCU1 eeprom;
+        printWearResult("UserEeprom BCU1 slots", userEepromWear(eeprom, rounds, bytesPerRound));
+    }
+
+    IAP_Init_Flash(0xFF);
+    {
+        UserEepromBCU2 eeprom;
+        printWearResult("UserEeprom BCU2 slots", userEepromWear(eeprom, rounds, bytesPerRound));
+    }
+
+    IAP_Init_Flash(0xFF);
+    {
+        UserEepromMASK0701 eeprom;
+        printWearResult("UserEeprom MASK0701 slots", userEepromWear(eeprom, rounds, bytesPerRound));
+    }
+
+    IAP_Init_Flash(0xFF);
+    {
+        UserEepromMASK0701 eeprom;
+        eeprom.setLogStructured(true);
+        printWearResult("UserEeprom MASK0701 log", userEepromWear(eeprom, rounds, bytesPerRound));
+    }
+
+    IAP_Init_Flash(0xFF);
+    {
+        MemMapper mapper(0xf000, 0x1000, true);
+        unsigned int changed = 0;
+        srand(42);
+        for (int r = 0; r < rounds; ++r)
+        {
+            for (int b = 0; b < bytesPerRound; ++b, ++changed)
+                REQUIRE(mapper.writeMem(0x1000 + rand() % 0x800, r) == MEM_MAPPER_SUCCESS);
+            mapper.doFlash();
+        }
+        printWearResult("MemMapper", collectWearResult(changed));
+    }
+
+#ifdef IAP_KEEP_BUS_INTERRUPTS
+    iapKeepInterrupts(0);
+    NVIC->ISER[0] = 0;
+    NVIC->ICER[0] = 0;
+#endif
+    IAP_Init_Flash(0xFF);
+}
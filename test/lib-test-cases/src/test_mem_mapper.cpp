@@ -0,0 +1,116 @@
+/*
+ *  test_mem_mapper.cpp - Tests for the flash memory mapper
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "catch.hpp"
+#include "iap_emu.h"
+#include <sblib/mem_mapper.h>
+#include <string.h>
+
+TEST_CASE("Memory mapper access across virtual pages","[SBLIB][MEM_MAPPER]")
+{
+    IAP_Init_Flash(0xFF);
+    MemMapper mapper(0xf000, 0x1000, true);
+
+    byte data[600];
+    for (unsigned int i = 0; i < sizeof(data); ++i)
+        data[i] = i * 7 + 1;
+
+    SECTION("Array write is read back from write buffer and flash")
+    {
+        REQUIRE(mapper.writeMemPtr(0x1080, data, sizeof(data)) == MEM_MAPPER_SUCCESS);
+        REQUIRE(mapper.isMappedRange(0x1080, 0x1080 + sizeof(data) - 1));
+
+        byte readBack[sizeof(data)];
+        REQUIRE(mapper.readMemPtr(0x1080, readBack, sizeof(readBack)) == MEM_MAPPER_SUCCESS);
+        REQUIRE(memcmp(readBack, data, sizeof(data)) == 0);
+
+        memset(readBack, 0, sizeof(readBack));
+        REQUIRE(mapper.readMemPtr(0x1080, readBack, sizeof(readBack), true) == MEM_MAPPER_SUCCESS);
+        REQUIRE(memcmp(readBack, data, sizeof(data)) == 0);
+
+        for (unsigned int i = 0; i < sizeof(data); i += 37)
+        {
+            byte value;
+            REQUIRE(mapper.readMem(0x1080 + i, value) == MEM_MAPPER_SUCCESS);
+            REQUIRE(value == data[i]);
+        }
+    }
+
+    SECTION("Array read stops at the first unmapped page")
+    {
+        REQUIRE(mapper.writeMemPtr(0x2000, data, 256) == MEM_MAPPER_SUCCESS);
+
+        byte readBack[300];
+        memset(readBack, 0xaa, sizeof(readBack));
+        REQUIRE(mapper.readMemPtr(0x2000, readBack, sizeof(readBack)) == MEM_MAPPER_NOT_MAPPED);
+        REQUIRE(memcmp(readBack, data, 256) == 0);
+        REQUIRE(readBack[256] == 0x00);
+        REQUIRE(readBack[257] == 0xaa);
+    }
+
+    SECTION("Array access beyond the address space fails")
+    {
+        REQUIRE(mapper.writeMemPtr(0xff80, data, 0x100) == MEM_MAPPER_INVALID_ADDRESS);
+        byte value;
+        REQUIRE(mapper.readMem(0xff90, value) == MEM_MAPPER_SUCCESS);
+        REQUIRE(value == data[0x10]);
+    }
+
+    IAP_Init_Flash(0xFF);
+}
+
+TEST_CASE("Memory mapper page cache","[SBLIB][MEM_MAPPER]")
+{
+    IAP_Init_Flash(0xFF);
+    MemMapper mapper(0xf000, 0x1000, true);
+    REQUIRE(mapper.addRange(0x1000, 0x200) == MEM_MAPPER_SUCCESS);
+
+    SECTION("Interleaved writes to two pages do not erase flash")
+    {
+        int erases = iap_calls[I_ERASE];
+        for (int i = 0; i < 64; ++i)
+        {
+            REQUIRE(mapper.writeMem(0x1000 + (i & 1) * 0x100 + i, i) == MEM_MAPPER_SUCCESS);
+        }
+        REQUIRE(iap_calls[I_ERASE] == erases);
+
+        REQUIRE(mapper.doFlash() == 2);
+        REQUIRE(iap_calls[I_ERASE] == erases + 2);
+        REQUIRE(mapper.doFlash() == 0);
+        REQUIRE(iap_calls[I_ERASE] == erases + 2);
+
+        byte value;
+        REQUIRE(mapper.readMem(0x1000 + 0x100 + 63, value, true) == MEM_MAPPER_SUCCESS);
+        REQUIRE(value == 63);
+    }
+
+    SECTION("Evicted pages are written back")
+    {
+        const int pages = MEM_MAPPER_CACHE_PAGES + 2;
+        int erases = iap_calls[I_ERASE];
+        for (int page = 0; page < pages; ++page)
+        {
+            REQUIRE(mapper.writeMem(0x2000 + page * 0x100, page + 1) == MEM_MAPPER_SUCCESS);
+        }
+        // only the evicted pages are flashed, the allocation table follows with doFlash()
+        REQUIRE(iap_calls[I_ERASE] == erases + pages - MEM_MAPPER_CACHE_PAGES);
+        REQUIRE(mapper.doFlash() == 3);
+        REQUIRE(iap_calls[I_ERASE] == erases + pages + 1);
+
+        MemMapper reloaded(0xf000, 0x1000, false);
+        for (int page = 0; page < pages; ++page)
+        {
+            byte value;
+            REQUIRE(reloaded.readMem(0x2000 + page * 0x100, value) == MEM_MAPPER_SUCCESS);
+            REQUIRE(value == page + 1);
+        }
+        REQUIRE(reloaded.isMappedRange(0x1000, 0x11ff));
+    }
+
+    IAP_Init_Flash(0xFF);
+}
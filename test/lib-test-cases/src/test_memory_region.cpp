@@ -0,0 +1,93 @@
+/*
+ *  test_memory_region.cpp - Tests for the memory regions of memory read and write telegrams
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "protocol.h"
+#include <sblib/eib/memory_region.h>
+
+/*
+ * A memory region backed by an array, e.g. an external EEPROM.
+ */
+class ArrayRegion : public MemoryRegion
+{
+public:
+    ArrayRegion(uint32_t start = 0x9000) : start(start), accesses(0) { memset(data, 0, sizeof(data)); }
+
+    uint32_t startAddr() const override { return start; }
+    uint32_t endAddr() const override { return start + sizeof(data) - 1; }
+
+    bool read(uint32_t address, byte* buffer, uint32_t length) override
+    {
+        accesses++;
+        memcpy(buffer, &data[address - start], length);
+        return true;
+    }
+
+    bool write(uint32_t address, byte* buffer, uint32_t length) override
+    {
+        accesses++;
+        memcpy(&data[address - start], buffer, length);
+        return true;
+    }
+
+    uint32_t start;
+    int accesses;
+    byte data[0x80];
+};
+
+TEST_CASE("Memory regions of memory read and write telegrams","[SBLIB][MEMORY_REGION]")
+{
+    BCU2 bcu;
+    ArrayRegion upper(0x8080);
+    ArrayRegion lower(0x8000);
+    REQUIRE(bcu.registerMemoryRegion(&upper));
+    REQUIRE(bcu.registerMemoryRegion(&lower));
+
+    byte payLoad[0x20];
+    for (unsigned int i = 0; i < sizeof(payLoad); ++i)
+        payLoad[i] = i + 1;
+
+    SECTION("Request spanning two regions is split at the boundary")
+    {
+        REQUIRE(bcu.processApciMemoryOperation(0x8070, payLoad, sizeof(payLoad), false));
+        REQUIRE(lower.accesses == 1);
+        REQUIRE(upper.accesses == 1);
+        REQUIRE(memcmp(&lower.data[0x70], payLoad, 0x10) == 0);
+        REQUIRE(memcmp(&upper.data[0x00], payLoad + 0x10, 0x10) == 0);
+
+        byte readBack[sizeof(payLoad)] = { 0 };
+        REQUIRE(bcu.processApciMemoryOperation(0x8070, readBack, sizeof(readBack), true));
+        REQUIRE(memcmp(readBack, payLoad, sizeof(payLoad)) == 0);
+    }
+
+    SECTION("Request beyond the last region fails")
+    {
+        REQUIRE_FALSE(bcu.processApciMemoryOperation(0x80f0, payLoad, sizeof(payLoad), true));
+        REQUIRE_FALSE(bcu.processApciMemoryOperation(0x7ff0, payLoad, sizeof(payLoad), true));
+    }
+
+    SECTION("User EEPROM takes precedence over the end of the user RAM")
+    {
+        const unsigned int address = bcu.userEeprom->startAddr() - 2;
+        REQUIRE(bcu.processApciMemoryOperation(address, payLoad, 4, false));
+        REQUIRE(bcu.userEeprom->getUInt8(bcu.userEeprom->startAddr()) == payLoad[2]);
+        REQUIRE(bcu.userEeprom->getUInt8(bcu.userEeprom->startAddr() + 1) == payLoad[3]);
+        REQUIRE(bcu.userEeprom->isModified());
+    }
+
+    SECTION("Registration is limited")
+    {
+        ArrayRegion regions[MAX_MEMORY_REGIONS];
+        int registered = 0;
+        for (ArrayRegion& region : regions)
+        {
+            if (bcu.registerMemoryRegion(&region))
+                registered++;
+        }
+        REQUIRE(registered == MAX_MEMORY_REGIONS - 5);
+    }
+}
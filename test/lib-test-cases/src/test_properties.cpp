@@ -0,0 +1,248 @@
+/*
+ *  test_properties.cpp - Tests for the property value access
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "protocol.h"
+#include <sblib/utils.h>
+#include <sblib/eib/mask0701.h>
+
+#include <chrono>
+#include <vector>
+
+TEST_CASE("Copy of array elements with reversed byte order","[SBLIB][PROPERTIES]")
+{
+    const byte src[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+    byte dest[6];
+
+    reverseCopyElements(dest, src, 3, 2);
+    const byte expected16[] = { 0x02, 0x01, 0x04, 0x03, 0x06, 0x05 };
+    REQUIRE(memcmp(dest, expected16, sizeof(dest)) == 0);
+
+    reverseCopyElements(dest, src, 2, 3);
+    const byte expected24[] = { 0x03, 0x02, 0x01, 0x06, 0x05, 0x04 };
+    REQUIRE(memcmp(dest, expected24, sizeof(dest)) == 0);
+
+    reverseCopyElements(dest, src, 6, 1);
+    REQUIRE(memcmp(dest, src, sizeof(dest)) == 0);
+}
+
+TEST_CASE("Property value read and write of multiple elements","[SBLIB][PROPERTIES]")
+{
+    BCU2 bcu;
+    const PropertyDef* def = bcu.properties->propertyDef(OT_ADDR_TABLE, PID_TABLE_REFERENCE);
+    REQUIRE(def != nullptr);
+
+    byte* valuePtr = def->valuePointer(&bcu);
+    const byte value[] = { 0x34, 0x12, 0x78, 0x56 };
+    memcpy(valuePtr, value, sizeof(value));
+
+    byte sendBuffer[32] = { 0 };
+    sendBuffer[5] = 0x60 + 5;
+
+    SECTION("Read keeps the element order")
+    {
+        REQUIRE(bcu.properties->propertyValueReadTelegram(OT_ADDR_TABLE, PID_TABLE_REFERENCE, 2, 1, sendBuffer));
+        REQUIRE(sendBuffer[5] == 0x60 + 5 + 4);
+        REQUIRE(sendBuffer[12] == 0x12);
+        REQUIRE(sendBuffer[13] == 0x34);
+        REQUIRE(sendBuffer[14] == 0x56);
+        REQUIRE(sendBuffer[15] == 0x78);
+    }
+
+    SECTION("Read of the second element")
+    {
+        REQUIRE(bcu.properties->propertyValueReadTelegram(OT_ADDR_TABLE, PID_TABLE_REFERENCE, 1, 2, sendBuffer));
+        REQUIRE(sendBuffer[5] == 0x60 + 5 + 2);
+        REQUIRE(sendBuffer[12] == 0x56);
+        REQUIRE(sendBuffer[13] == 0x78);
+    }
+
+    SECTION("Read exceeding the telegram size fails")
+    {
+        int maxElements = bcu.properties->maxPropertyValueLength() / def->size();
+        REQUIRE(bcu.properties->propertyValueReadTelegram(OT_ADDR_TABLE, PID_TABLE_REFERENCE, maxElements, 1, sendBuffer));
+        REQUIRE_FALSE(bcu.properties->propertyValueReadTelegram(OT_ADDR_TABLE, PID_TABLE_REFERENCE, maxElements + 1, 1, sendBuffer));
+    }
+}
+
+/*
+ * Read the property IDs of an interface object by index, like PropertyDescriptionRead does.
+ */
+static std::vector<int> propertyIdsByIndex(BCU2& bcu, int objectIdx)
+{
+    std::vector<int> ids;
+    byte sendBuffer[32];
+    for (int index = 0; bcu.properties->propertyDescReadTelegram(objectIdx, (PropertyID) 0, index, sendBuffer); ++index)
+        ids.push_back(sendBuffer[9]);
+    return ids;
+}
+
+static void requirePropertyOrder(BCU2& bcu)
+{
+    const std::vector<int> device = { PID_OBJECT_TYPE, PID_DEVICE_CONTROL, PID_LOAD_STATE_CONTROL, PID_SERVICE_CONTROL,
+                                      PID_FIRMWARE_REVISION, PID_SERIAL_NUMBER, PID_MANUFACTURER_ID, PID_ORDER_INFO,
+                                      PID_PEI_TYPE, PID_PORT_CONFIGURATION, PID_HARDWARE_TYPE };
+    const std::vector<int> app = { PID_OBJECT_TYPE, PID_LOAD_STATE_CONTROL, PID_RUN_STATE_CONTROL, PID_PROGRAM_VERSION,
+                                   PID_TABLE_REFERENCE, PID_MCB_TABLE, PID_ABB_CUSTOM };
+    REQUIRE(propertyIdsByIndex(bcu, OT_DEVICE) == device);
+    REQUIRE(propertyIdsByIndex(bcu, OT_APPLICATION) == app);
+
+    // the lookup by ID finds every property of every interface object
+    for (int objectIdx = OT_DEVICE; objectIdx <= OT_KNX_OBJECT_ASSOCIATATION_TABLE; ++objectIdx)
+    {
+        for (int id : propertyIdsByIndex(bcu, objectIdx))
+        {
+            INFO("object " << objectIdx << " property " << id);
+            const PropertyDef* def = bcu.properties->propertyDef(objectIdx, (PropertyID) id);
+            REQUIRE(def != nullptr);
+            REQUIRE(def->id == id);
+        }
+        REQUIRE(bcu.properties->propertyDef(objectIdx, PID_OBJECT_NAME) == nullptr);
+    }
+}
+
+TEST_CASE("Property description read by index keeps the table order","[SBLIB][PROPERTIES]")
+{
+    SECTION("BCU2")
+    {
+        BCU2 bcu;
+        requirePropertyOrder(bcu);
+    }
+
+    SECTION("MASK0701")
+    {
+        MASK0701 bcu;
+        requirePropertyOrder(bcu);
+    }
+}
+
+/*
+ * Write the group addresses to an address table of the MASK 0x0701 at 0x4000,
+ * behind the length and the own physical address.
+ */
+static void setGroupAddresses(MASK0701& bcu, const uint16_t* addresses, int count)
+{
+    bcu.userEeprom->addrTabAddr() = 0x4000;
+    byte* tab = bcu.userMemoryPtr(0x4000);
+    tab[0] = count + 1;
+    tab[1] = 0x11;
+    tab[2] = 0x01;
+    for (int i = 0; i < count; ++i)
+    {
+        tab[3 + i * 2] = addresses[i] >> 8;
+        tab[4 + i * 2] = addresses[i] & 0xff;
+    }
+    bcu.addrTables->rebuild();
+}
+
+TEST_CASE("Group address table as array property","[SBLIB][PROPERTIES]")
+{
+    MASK0701 bcu;
+    const uint16_t addresses[] = { 0x0801, 0x0805, 0x0A10, 0x1234, 0x2345, 0x7FFF };
+    const int count = 6;
+    setGroupAddresses(bcu, addresses, count);
+
+    byte sendBuffer[32] = { 0 };
+    sendBuffer[5] = 0x60 + 5;
+
+    SECTION("Description reports the number of group addresses")
+    {
+        REQUIRE(bcu.properties->propertyDescReadTelegram(OT_ADDR_TABLE, PID_TABLE, 0, sendBuffer));
+        REQUIRE(sendBuffer[9] == PID_TABLE);
+        REQUIRE(sendBuffer[11] == PDT_GENERIC_02);
+        REQUIRE(sendBuffer[12] == 0);
+        REQUIRE(sendBuffer[13] == count);
+    }
+
+    SECTION("Read of a run of group addresses")
+    {
+        REQUIRE(bcu.properties->propertyValueReadTelegram(OT_ADDR_TABLE, PID_TABLE, 5, 2, sendBuffer));
+        REQUIRE(sendBuffer[5] == 0x60 + 5 + 10);
+        for (int i = 0; i < 5; ++i)
+        {
+            REQUIRE(sendBuffer[12 + i * 2] == addresses[1 + i] >> 8);
+            REQUIRE(sendBuffer[13 + i * 2] == (addresses[1 + i] & 0xff));
+        }
+    }
+
+    SECTION("Read beyond the last group address fails")
+    {
+        REQUIRE(bcu.properties->propertyValueReadTelegram(OT_ADDR_TABLE, PID_TABLE, 1, count, sendBuffer));
+        REQUIRE_FALSE(bcu.properties->propertyValueReadTelegram(OT_ADDR_TABLE, PID_TABLE, 2, count, sendBuffer));
+        REQUIRE_FALSE(bcu.properties->propertyValueReadTelegram(OT_ADDR_TABLE, PID_TABLE, 1, count + 1, sendBuffer));
+        REQUIRE_FALSE(bcu.properties->propertyValueReadTelegram(OT_ADDR_TABLE, PID_TABLE, 1, 0, sendBuffer));
+    }
+
+    SECTION("Empty address table")
+    {
+        setGroupAddresses(bcu, addresses, 0);
+        REQUIRE_FALSE(bcu.properties->propertyValueReadTelegram(OT_ADDR_TABLE, PID_TABLE, 1, 1, sendBuffer));
+    }
+}
+
+/*
+ * Read all group addresses of the address table through the PID_TABLE property,
+ * with the given number of elements per telegram.
+ */
+static bool readGroupAddresses(MASK0701& bcu, int count, int elemsPerTelegram, byte* dest)
+{
+    byte sendBuffer[32] = { 0 };
+    bool ok = true;
+
+    for (int start = 0; start < count; start += elemsPerTelegram)
+    {
+        int elems = (count - start < elemsPerTelegram) ? count - start : elemsPerTelegram;
+        sendBuffer[5] = 0x60 + 5;
+        ok &= bcu.properties->propertyValueReadTelegram(OT_ADDR_TABLE, PID_TABLE, elems, start + 1, sendBuffer);
+        memcpy(dest + start * 2, sendBuffer + 12, elems * 2);
+    }
+    return ok;
+}
+
+TEST_CASE("Benchmark reading the group address table as array property","[.][benchmark][PROPERTIES]")
+{
+    const int addrCount = 254; // the length byte also counts the own physical address
+    const int rounds = 20000;
+
+    MASK0701 bcu;
+    uint16_t addresses[addrCount];
+    for (int i = 0; i < addrCount; ++i)
+        addresses[i] = 0x0800 + i * 3;
+    setGroupAddresses(bcu, addresses, addrCount);
+
+    const PropertyDef* def = bcu.properties->propertyDef(OT_ADDR_TABLE, PID_TABLE);
+    REQUIRE(def != nullptr);
+    const int chunk = bcu.properties->maxPropertyValueLength() / def->size();
+    byte apdu[addrCount * 2];
+    bool ok = true;
+
+    auto startTime = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+        ok &= readGroupAddresses(bcu, addrCount, 1, apdu);
+    auto singleTime = std::chrono::steady_clock::now() - startTime;
+
+    startTime = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+        ok &= readGroupAddresses(bcu, addrCount, chunk, apdu);
+    auto runTime = std::chrono::steady_clock::now() - startTime;
+    REQUIRE(ok);
+
+    // the group addresses are read in network byte order
+    for (int i = 0; i < addrCount; ++i)
+    {
+        REQUIRE(apdu[i * 2] == addresses[i] >> 8);
+        REQUIRE(apdu[i * 2 + 1] == (addresses[i] & 0xff));
+    }
+
+    using std::chrono::microseconds;
+    using std::chrono::duration_cast;
+    printf("PID_TABLE of the address table read (%d group addresses, %d rounds):\n", addrCount, rounds);
+    printf("  1 element per telegram:  %3d telegrams, %lld us\n", addrCount,
+           (long long) duration_cast<microseconds>(singleTime).count());
+    printf("  %d elements per telegram: %3d telegrams, %lld us\n", chunk, (addrCount + chunk - 1) / chunk,
+           (long long) duration_cast<microseconds>(runTime).count());
+}
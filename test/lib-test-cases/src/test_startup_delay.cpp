@@ -0,0 +1,194 @@
+/*
+ *  test_startup_delay.cpp - Tests for the staggered group telegrams after startup
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "protocol.h"
+
+#define STARTUP_WINDOW 2000 // ms
+#define STARTUP_OFFSET 300  // ms, device specific offset within the first half of the window
+
+static void tc_eepromSetup(void)
+{
+    // object n is associated with the group address 1/0/(n+1)
+    bcuUnderTest->userEeprom->addrTabSize() = 5;
+    bcuUnderTest->userEeprom->assocTabPtr() = 0x20;
+    bcuUnderTest->userEeprom->userEepromData[0x120 - EEPROM_START] = 4;
+    for (int objno = 0; objno < 4; ++objno)
+    {
+        bcuUnderTest->userEeprom->userEepromData[0x119 + objno * 2 - EEPROM_START] = 0x08;
+        bcuUnderTest->userEeprom->userEepromData[0x11A + objno * 2 - EEPROM_START] = objno + 1;
+        bcuUnderTest->userEeprom->userEepromData[0x121 + objno * 2 - EEPROM_START] = objno + 1;
+        bcuUnderTest->userEeprom->userEepromData[0x122 + objno * 2 - EEPROM_START] = objno;
+    }
+
+    // 1 bit objects with priority alarm, high, low and low
+    const byte config[4] = { 0x5D, 0x5E, 0x5F, 0x5F };
+    bcuUnderTest->userEeprom->commsTabPtr() = 0x30;
+    bcuUnderTest->userEeprom->userEepromData[0x130 - EEPROM_START] = 4;
+    bcuUnderTest->userEeprom->userEepromData[0x131 - EEPROM_START] = 0x58; // RAM flags
+    for (int objno = 0; objno < 4; ++objno)
+    {
+        bcuUnderTest->userEeprom->userEepromData[0x132 + objno * 3 - EEPROM_START] = 0x50 + objno;
+        bcuUnderTest->userEeprom->userEepromData[0x133 + objno * 3 - EEPROM_START] = config[objno];
+        bcuUnderTest->userEeprom->userEepromData[0x134 + objno * 3 - EEPROM_START] = BIT_1;
+    }
+}
+
+static void startWindow()
+{
+    bcuUnderTest->startupSeed = STARTUP_OFFSET;
+    bcuUnderTest->setStartupDelay(STARTUP_WINDOW);
+}
+
+static void tc_setup(Telegram* tel, uint16_t telCount)
+{
+    bcuUnderTest->setOwnAddress(0x1112); // set own address to 1.1.18
+    telegramPreparation(bcuUnderTest, tel, telCount);
+
+    // initial values of the application
+    bcuUnderTest->comObjects->objectWritten(0);
+    bcuUnderTest->comObjects->objectWritten(1);
+    bcuUnderTest->comObjects->objectWritten(2);
+    startWindow();
+}
+
+static void tc_setupBusNotReady(Telegram* tel, uint16_t telCount)
+{
+    bcuUnderTest->setOwnAddress(0x1112); // set own address to 1.1.18
+    telegramPreparation(bcuUnderTest, tel, telCount);
+
+    bcuUnderTest->bus->state = Bus::INIT; // e.g. the bus voltage just returned
+    bcuUnderTest->comObjects->objectWritten(1);
+    bcuUnderTest->comObjects->objectWritten(2);
+    startWindow();
+}
+
+static void busReady(void * state, unsigned int var)
+{
+    bcuUnderTest->bus->state = Bus::IDLE;
+}
+
+static void writeObject(void * state, unsigned int objno)
+{
+    bcuUnderTest->comObjects->objectWritten(objno);
+}
+
+static void restartWindow(void * state, unsigned int var)
+{
+    startWindow();
+}
+
+static Telegram testCaseTelegrams_Priorities[] =
+{
+    // 1. priority alarm is sent immediately
+    {TIMER_TICK, 100, 4, 0, NULL},
+    {TEL_TX,       8, 0, 0, NULL, {0xBC, 0x11, 0x12, 0x08, 0x01, 0xE1, 0x00, 0x80}},
+    // 2. a write of the application after the startup is not held back
+    {TIMER_TICK, 100, 4, 3, writeObject},
+    {TEL_TX,       8, 0, 0, NULL, {0xBC, 0x11, 0x12, 0x08, 0x04, 0xE1, 0x00, 0x80}},
+    {TIMER_TICK,  50, 4, 0, NULL},
+    {CHECK_TX_BUFFER, 0, 0, 0},
+    // 3. priority high after the offset
+    {TIMER_TICK, STARTUP_OFFSET - 200, 4, 0, NULL},
+    {TEL_TX,       8, 0, 0, NULL, {0xBC, 0x11, 0x12, 0x08, 0x02, 0xE1, 0x00, 0x80}},
+    {TIMER_TICK, STARTUP_WINDOW / 2 - 100, 4, 0, NULL},
+    {CHECK_TX_BUFFER, 0, 0, 0},
+    // 4. priority low half a window later
+    {TIMER_TICK, 100, 4, 0, NULL},
+    {TEL_TX,       8, 0, 0, NULL, {0xBC, 0x11, 0x12, 0x08, 0x03, 0xE1, 0x00, 0x80}},
+    {TIMER_TICK, 100, 4, 0, NULL},
+    {CHECK_TX_BUFFER, 0, 0, 0},
+    {END}
+};
+
+static Telegram testCaseTelegrams_BusReady[] =
+{
+    // 1. the window does not run while the bus is not ready
+    {TIMER_TICK, STARTUP_WINDOW, 4, 0, NULL},
+    {CHECK_TX_BUFFER, 0, 0, 0},
+    // 2. the window starts when the bus is ready
+    {TIMER_TICK, 10, 4, 0, busReady},
+    {TIMER_TICK, STARTUP_OFFSET - 10, 4, 0, NULL},
+    {CHECK_TX_BUFFER, 0, 0, 0},
+    {TIMER_TICK, 50, 4, 0, NULL},
+    {TEL_TX,       8, 0, 0, NULL, {0xBC, 0x11, 0x12, 0x08, 0x02, 0xE1, 0x00, 0x80}},
+    {TIMER_TICK, STARTUP_WINDOW / 2 - 100, 4, 0, NULL},
+    {CHECK_TX_BUFFER, 0, 0, 0},
+    {TIMER_TICK, 100, 4, 0, NULL},
+    {TEL_TX,       8, 0, 0, NULL, {0xBC, 0x11, 0x12, 0x08, 0x03, 0xE1, 0x00, 0x80}},
+    {END}
+};
+
+static Telegram testCaseTelegrams_Restart[] =
+{
+    {TIMER_TICK, 100, 4, 0, NULL},
+    {TEL_TX,       8, 0, 0, NULL, {0xBC, 0x11, 0x12, 0x08, 0x01, 0xE1, 0x00, 0x80}},
+    // 1. setting the delay again restarts the window from now
+    {TIMER_TICK, 100, 4, 0, restartWindow},
+    {TIMER_TICK, STARTUP_OFFSET - 150, 4, 0, NULL},
+    {CHECK_TX_BUFFER, 0, 0, 0},
+    {TIMER_TICK, 200, 4, 0, NULL},
+    {TEL_TX,       8, 0, 0, NULL, {0xBC, 0x11, 0x12, 0x08, 0x02, 0xE1, 0x00, 0x80}},
+    {END}
+};
+
+static Test_Case testCasePriorities =
+{
+  "Startup delay by priority",
+  0x0004, 0x2060, 0x01,
+  0,    //powerOnDelay
+  tc_eepromSetup,
+  tc_setup,
+  NULL,
+  NULL,
+  NULL,
+  testCaseTelegrams_Priorities
+};
+
+static Test_Case testCaseBusReady =
+{
+  "Startup delay starts with the bus ready",
+  0x0004, 0x2060, 0x01,
+  0,    //powerOnDelay
+  tc_eepromSetup,
+  tc_setupBusNotReady,
+  NULL,
+  NULL,
+  NULL,
+  testCaseTelegrams_BusReady
+};
+
+static Test_Case testCaseRestart =
+{
+  "Startup delay set again",
+  0x0004, 0x2060, 0x01,
+  0,    //powerOnDelay
+  tc_eepromSetup,
+  tc_setup,
+  NULL,
+  NULL,
+  NULL,
+  testCaseTelegrams_Restart
+};
+
+TEST_CASE("Startup delay of the initial group telegrams","[SBLIB][STARTUP_DELAY]")
+{
+    SECTION("Objects are sent by priority, later writes are not delayed")
+    {
+        executeTest(BCU_1, &testCasePriorities);
+    }
+
+    SECTION("Window starts when the bus is ready")
+    {
+        executeTest(BCU_1, &testCaseBusReady);
+    }
+
+    SECTION("Window restarts when the delay is set")
+    {
+        executeTest(BCU_1, &testCaseRestart);
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ *  test_table_cache.cpp - Tests for the tables changed event of memory write telegrams
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation.
+ */
+
+#include "protocol.h"
+#include <sblib/eib/table_cache.h>
+
+/*
+ * A table cache which counts its rebuilds.
+ */
+class CountingCache : public TableCache
+{
+public:
+    CountingCache() : rebuilds(0) {}
+
+    void rebuild() override
+    {
+        rebuilds++;
+    }
+
+    int rebuilds;
+};
+
+/*
+ * Write the bytes to the memory like a memory write telegram and
+ * return the number of rebuilds of the cache caused by the write.
+ */
+static int writeMemory(BcuDefault& bcu, CountingCache& cache, unsigned int address, byte* data, unsigned int length)
+{
+    int rebuildsBefore = cache.rebuilds;
+    REQUIRE(bcu.processApciMemoryOperation(address, data, length, false));
+    bcu.updateTableCaches();
+    return cache.rebuilds - rebuildsBefore;
+}
+
+TEST_CASE("Tables changed by memory write telegrams","[SBLIB][TABLE_CACHE]")
+{
+    BCU1 bcu;
+    CountingCache cache;
+    bcu.registerTableCache(&cache);
+    bcu.updateTableCaches();
+
+    // address table at 0x116: own address and one group address
+    bcu.userEeprom->addrTabSize() = 2;
+    // association table at 0x140 with one association
+    bcu.userEeprom->assocTabPtr() = 0x40;
+    bcu.userEeprom->userEepromData[0x40] = 1;
+    // com-object table at 0x150 with two objects of 3 bytes
+    bcu.userEeprom->commsTabPtr() = 0x50;
+    bcu.userEeprom->userEepromData[0x50] = 2;
+
+    byte data[8] = { 0 };
+
+    SECTION("Size of the tables")
+    {
+        REQUIRE(bcu.addrTables->addrTableSize() == 5);
+        REQUIRE(bcu.addrTables->assocTableSize() == 3);
+        REQUIRE(bcu.comObjects->objectConfigTableSize() == 8);
+
+        bcu.userEeprom->userEepromData[0x50] = 0;
+        REQUIRE(bcu.comObjects->objectConfigTableSize() == 2);
+
+        bcu.userEeprom->commsTabPtr() = 0;
+        REQUIRE(bcu.comObjects->objectConfigTableSize() == 0);
+    }
+
+    SECTION("Write into a table")
+    {
+        REQUIRE(writeMemory(bcu, cache, 0x11A, data, 1) == 1);
+        REQUIRE(writeMemory(bcu, cache, 0x142, data, 1) == 1);
+        REQUIRE(writeMemory(bcu, cache, 0x157, data, 1) == 1);
+    }
+
+    SECTION("Write of a table pointer")
+    {
+        data[0] = 0x40;
+        REQUIRE(writeMemory(bcu, cache, 0x111, data, 1) == 1);
+    }
+
+    SECTION("Write directly behind a table")
+    {
+        REQUIRE(writeMemory(bcu, cache, 0x11B, data, 2) == 0);
+        REQUIRE(writeMemory(bcu, cache, 0x143, data, 2) == 0);
+        REQUIRE(writeMemory(bcu, cache, 0x158, data, 4) == 0);
+        REQUIRE(writeMemory(bcu, cache, 0x14E, data, 2) == 0);
+    }
+
+    SECTION("Write of the last entries of a grown table")
+    {
+        // the object count grows to 4, the entries of the objects 2 and 3 follow
+        bcu.userEeprom->userEepromData[0x50] = 4;
+        REQUIRE(writeMemory(bcu, cache, 0x158, data, 6) == 1);
+    }
+
+    SECTION("Length and entries of a grown table in one write")
+    {
+        byte table[8] = { 3, 0x08, 0x01, 0x08, 0x02, 0, 0, 0 };
+        REQUIRE(writeMemory(bcu, cache, 0x116, table, 5) == 1);
+        REQUIRE(bcu.addrTables->addrTableSize() == 7);
+        REQUIRE(writeMemory(bcu, cache, 0x11D, data, 2) == 0);
+    }
+}
+
+TEST_CASE("Size of the com-object table","[SBLIB][TABLE_CACHE]")
+{
+    SECTION("BCU 2")
+    {
+        BCU2 bcu;
+        bcu.userEeprom->commsTabAddr() = 0x200;
+        bcu.userEeprom->userEepromData[0x100] = 3;
+        // number of objects, 2 bytes RAM flags table pointer, 4 bytes per object
+        REQUIRE(bcu.comObjects->objectConfigTableSize() == 15);
+    }
+
+    SECTION("MASK 0x0701")
+    {
+        MASK0701 bcu;
+        bcu.userEeprom->commsTabAddr() = bcu.userEeprom->startAddr() + 0x100;
+        bcu.userEeprom->userEepromData[0x100] = 5;
+        REQUIRE(bcu.comObjects->objectConfigTableSize() == 1 + 2 + 5 * 4);
+    }
+}
@@ -326,8 +326,11 @@ __STATIC_INLINE void __set_FPSCR(uint32_t fpscr)
   This function enables IRQ interrupts by clearing the I-bit in the CPSR.
   Can only be executed in Privileged modes.
  */
+extern void _test_enable_irq(void);
+
 __attribute__( ( always_inline ) ) __STATIC_INLINE void __enable_irq(void)
 {
+	_test_enable_irq();
 }
 
 
@@ -336,8 +339,11 @@ __attribute__( ( always_inline ) ) __STATIC_INLINE void __enable_irq(void)
   This function disables IRQ interrupts by setting the I-bit in the CPSR.
   Can only be executed in Privileged modes.
  */
+extern void _test_disable_irq(void);
+
 __attribute__( ( always_inline ) ) __STATIC_INLINE void __disable_irq(void)
 {
+	_test_disable_irq();
 }
 
 
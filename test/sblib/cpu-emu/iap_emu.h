@@ -39,6 +39,99 @@ void IAP_Init_Flash(unsigned char value);
 // Size for the simulated flash: 64k (16 * 4k), value for LPC1115
 #define FLASH_SIZE  0x10000
 
+// Size of a flash page: 256 bytes
+#define FLASH_PAGE_SIZE (0x100)
+
+// Duration of a sector or page erase in microseconds (LPC111x datasheet: 95..105ms)
+#define IAP_ERASE_TIME_US    100000
+
+// Duration for programming one page of 256 bytes in microseconds (LPC111x datasheet: 0.95..1.05ms)
+#define IAP_PROGRAM_TIME_US  1000
+
+// Number of busy spans that are kept for inspection
+#define IAP_MAX_BUSY_SPANS   64
+
+/**
+ * A time span in which the emulated flash was busy with an erase or program
+ * operation. The application cannot access the flash during this time, so
+ * all interrupts with handlers in flash are blocked for the whole span.
+ */
+typedef struct
+{
+    unsigned int start;    //!< Start of the span in microseconds since IAP_Init_Flash()
+    unsigned int duration; //!< Duration of the span in microseconds
+    int function;          //!< The IAP function, I_ERASE or I_RAM2FLASH
+    unsigned int address;  //!< Flash offset of the first erased or programmed byte
+} IAP_BusySpan;
+
+/**
+ * Statistics of the flash model. Reset by IAP_Init_Flash().
+ */
+typedef struct
+{
+    unsigned int pageErases[FLASH_SIZE / FLASH_PAGE_SIZE]; //!< Number of erase cycles of every page
+    unsigned int bytesProgrammed;  //!< Number of bytes programmed by IAP_COPY_RAM2FLASH
+    unsigned int bitViolations;    //!< Number of bytes where programming tried to set a bit from 0 to 1
+    unsigned int busyTime;         //!< Total time the flash was busy, in microseconds
+    unsigned int maxBusySpan;      //!< Longest busy span, in microseconds
+    unsigned int busySpanCount;    //!< Number of busy spans, the last IAP_MAX_BUSY_SPANS are in busySpans
+    IAP_BusySpan busySpans[IAP_MAX_BUSY_SPANS]; //!< Ring buffer of the recent busy spans
+} IAP_Statistics;
+
+/**
+ * The statistics of the flash model.
+ *
+ * Erasing sets all bytes of a page or sector to 0xFF and increments the erase
+ * counter of the pages. Programming can only clear bits, the flash content is
+ * the AND of the old content and the programmed data, as on the real chip.
+ * Erasing and programming is only possible for sectors that were prepared
+ * with IAP_PREPARE directly before.
+ *
+ * The duration of every erase and program operation is added to the
+ * emulated systemTime.
+ */
+extern IAP_Statistics iap_stats;
+
+/**
+ * A time span in which all interrupts were disabled with __disable_irq(),
+ * e.g. by noInterrupts().
+ */
+typedef struct
+{
+    unsigned int start;    //!< Start of the span in microseconds of the emulated systemTime
+    unsigned int duration; //!< Duration of the span in microseconds
+} IRQ_OffSpan;
+
+/**
+ * Statistics of the interrupt-off spans. Reset by IAP_Init_Flash().
+ *
+ * Unlike the busy spans of the flash, these are the spans in which no interrupt
+ * at all can be handled, independent of the location of the handlers.
+ */
+typedef struct
+{
+    unsigned int offTime;      //!< Total time the interrupts were disabled, in microseconds
+    unsigned int maxOffSpan;   //!< Longest interrupt-off span, in microseconds
+    unsigned int offSpanCount; //!< Number of interrupt-off spans, the last IAP_MAX_BUSY_SPANS are in offSpans
+    IRQ_OffSpan offSpans[IAP_MAX_BUSY_SPANS]; //!< Ring buffer of the recent interrupt-off spans
+} IRQ_Statistics;
+
+/**
+ * The statistics of the interrupt-off spans.
+ */
+extern IRQ_Statistics irq_stats;
+
+/**
+ * Called by the flash model during every erase and program operation, like an
+ * interrupt which arrives while the flash is busy. Not called if null (default).
+ */
+extern void (* iap_busy_handler)(void);
+
+/**
+ * Get the highest erase count of all flash pages.
+ */
+unsigned int IAP_Max_Page_Erases(void);
+
 
 #ifdef __cplusplus
 }
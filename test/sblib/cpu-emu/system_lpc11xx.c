@@ -26,9 +26,8 @@ LPC_GPIO_TypeDef   _LPC_GPIO1;
 LPC_GPIO_TypeDef   _LPC_GPIO2;
 LPC_GPIO_TypeDef   _LPC_GPIO3;
 
-
 // Flash emulation array
-unsigned char FLASH[FLASH_SIZE];
+unsigned char FLASH[FLASH_SIZE] __attribute__ ((aligned (SECTOR_SIZE)));
 
 // System core clock
 uint32_t SystemCoreClock = 48000000;
@@ -67,9 +66,137 @@ typedef enum
 
 int iap_calls [6] = {0, 0, 0, 0, 0, 0};
 
+IAP_Statistics iap_stats;
+
+void (* iap_busy_handler)(void) = 0;
+
+IRQ_Statistics irq_stats;
+
+extern unsigned int systemTime;
+
+// Emulated time of the flash model in microseconds
+static unsigned int iapTime;
+
+// Microseconds which are not yet added to systemTime
+static unsigned int iapTimeRemainder;
+
+// Start of the running interrupt-off span, valid if irqDisabled is set
+static unsigned int irqOffStart;
+static int irqDisabled;
+
+// Sectors prepared for the next erase or program operation
+static int preparedStart = -1;
+static int preparedEnd = -1;
+
 void IAP_Init_Flash(unsigned char value)
 {
     memset(FLASH, value, FLASH_SIZE);
+    memset(&iap_stats, 0, sizeof(iap_stats));
+    memset(&irq_stats, 0, sizeof(irq_stats));
+    irqDisabled = 0;
+    iapTime = 0;
+    iapTimeRemainder = 0;
+    preparedStart = preparedEnd = -1;
+}
+
+unsigned int IAP_Max_Page_Erases(void)
+{
+    unsigned int page, result = 0;
+
+    for (page = 0; page < FLASH_SIZE / FLASH_PAGE_SIZE; page++)
+    {
+        if (iap_stats.pageErases[page] > result)
+            result = iap_stats.pageErases[page];
+    }
+    return result;
+}
+
+/*
+ * Record a busy span of the flash and charge its duration to the emulated systemTime.
+ */
+static void flashBusy(int function, unsigned int address, unsigned int duration)
+{
+    IAP_BusySpan * span = &iap_stats.busySpans[iap_stats.busySpanCount % IAP_MAX_BUSY_SPANS];
+
+    span->start = iapTime;
+    span->duration = duration;
+    span->function = function;
+    span->address = address;
+    iap_stats.busySpanCount++;
+
+    iap_stats.busyTime += duration;
+    if (duration > iap_stats.maxBusySpan)
+        iap_stats.maxBusySpan = duration;
+
+    if (iap_busy_handler)
+        iap_busy_handler();
+
+    iapTime += duration;
+    iapTimeRemainder += duration;
+    systemTime += iapTimeRemainder / 1000;
+    iapTimeRemainder %= 1000;
+}
+
+/*
+ * Check that the sectors of an erase or program operation were prepared directly before.
+ * The prepare is consumed by the operation.
+ */
+static int checkPrepared(unsigned int startSector, unsigned int endSector)
+{
+    int prepared = preparedStart >= 0 && (int) startSector >= preparedStart && (int) endSector <= preparedEnd;
+
+    preparedStart = preparedEnd = -1;
+    return prepared;
+}
+
+/*
+ * Erase the pages startPage..endPage (inclusive).
+ */
+static int erasePages(unsigned int startPage, unsigned int endPage)
+{
+    unsigned int page;
+
+    if (startPage > endPage || endPage >= FLASH_SIZE / FLASH_PAGE_SIZE)
+        return INVALID_SECTOR;
+    if (!checkPrepared(startPage * FLASH_PAGE_SIZE / SECTOR_SIZE, endPage * FLASH_PAGE_SIZE / SECTOR_SIZE))
+        return SECTOR_NOT_PREPARED_FOR_WRITE_OPERATION;
+
+    memset(FLASH + startPage * FLASH_PAGE_SIZE, 0xFF, (endPage - startPage + 1) * FLASH_PAGE_SIZE);
+    for (page = startPage; page <= endPage; page++)
+        iap_stats.pageErases[page]++;
+
+    // The chip erases the whole range in one go
+    flashBusy(I_ERASE, startPage * FLASH_PAGE_SIZE, IAP_ERASE_TIME_US);
+    return CMD_SUCCESS;
+}
+
+/*
+ * Program count bytes from ram to the flash offset dest. Programming can only
+ * clear bits, setting a bit from 0 to 1 requires an erase.
+ */
+static int programFlash(unsigned int dest, const uint8_t * ram, unsigned int count)
+{
+    unsigned int i;
+
+    if (dest % FLASH_PAGE_SIZE || dest >= FLASH_SIZE)
+        return DST_ADDR_ERROR;
+    if ((uintptr_t) ram & 3)
+        return SRC_ADDR_ERROR;
+    if ((count != 256 && count != 512 && count != 1024 && count != 4096) || dest + count > FLASH_SIZE)
+        return COUNT_ERROR;
+    if (!checkPrepared(dest / SECTOR_SIZE, (dest + count - 1) / SECTOR_SIZE))
+        return SECTOR_NOT_PREPARED_FOR_WRITE_OPERATION;
+
+    for (i = 0; i < count; i++)
+    {
+        if (ram[i] & ~FLASH[dest + i])
+            iap_stats.bitViolations++;
+        FLASH[dest + i] &= ram[i];
+    }
+    iap_stats.bytesProgrammed += count;
+
+    flashBusy(I_RAM2FLASH, dest, IAP_PROGRAM_TIME_US * (count / FLASH_PAGE_SIZE));
+    return CMD_SUCCESS;
 }
 
 void IAP_Call (uintptr_t * cmd, uintptr_t * stat)
@@ -84,15 +211,22 @@ void IAP_Call (uintptr_t * cmd, uintptr_t * stat)
     {
     case IAP_PREPARE :
         iap_calls [I_PREPARE]++;
+        if (* (cmd + 1) > * (cmd + 2) || * (cmd + 2) >= FLASH_SIZE / SECTOR_SIZE)
+        {
+            * stat = INVALID_SECTOR;
+            break;
+        }
+        preparedStart = * (cmd + 1);
+        preparedEnd   = * (cmd + 2);
         break;
     case IAP_ERASE :
         iap_calls [I_ERASE]++;
-        i    =  * (cmd + 1)      * SECTOR_SIZE;
-        end  = (* (cmd + 2) + 1) * SECTOR_SIZE;
-        for (; i < end; i++)
-        {
-            FLASH [i] = 0xFF;
-        }
+        * stat = erasePages(* (cmd + 1) * (SECTOR_SIZE / FLASH_PAGE_SIZE),
+                            (* (cmd + 2) + 1) * (SECTOR_SIZE / FLASH_PAGE_SIZE) - 1);
+        break;
+    case IAP_ERASE_PAGE :
+        iap_calls [I_ERASE]++;
+        * stat = erasePages(* (cmd + 1), * (cmd + 2));
         break;
     case IAP_BLANK_CHECK :
         iap_calls [I_BLANK_CHECK]++;
@@ -122,7 +256,12 @@ void IAP_Call (uintptr_t * cmd, uintptr_t * stat)
         rom = (uint8_t *) (* (cmd + 1));
         ram = (uint8_t *) (* (cmd + 2));
         i   = * (cmd + 3);
-        memcpy (rom, ram, i);
+        if (rom < FLASH || rom >= FLASH + FLASH_SIZE)
+        {
+            * stat = DST_ADDR_NOT_MAPPED;
+            break;
+        }
+        * stat = programFlash(rom - FLASH, ram, i);
         break;
     case IAP_COMPARE :
         iap_calls [I_COMPARE]++;
@@ -147,9 +286,46 @@ void IAP_Call (uintptr_t * cmd, uintptr_t * stat)
     }
 }
 
-extern unsigned int systemTime;
 extern unsigned int wfiSystemTimeInc;
 void _test_wfi(void)
 {
 	systemTime +=  wfiSystemTimeInc;
 }
+
+/*
+ * Emulated time in microseconds: the systemTime plus the part of the flash
+ * durations which is not yet added to it.
+ */
+static unsigned int emulatedMicros(void)
+{
+    return systemTime * 1000 + iapTimeRemainder;
+}
+
+void _test_disable_irq(void)
+{
+    // like the PRIMASK, disabling again does not start a new span
+    if (irqDisabled)
+        return;
+    irqDisabled = 1;
+    irqOffStart = emulatedMicros();
+}
+
+void _test_enable_irq(void)
+{
+    IRQ_OffSpan * span;
+    unsigned int duration;
+
+    if (!irqDisabled)
+        return;
+    irqDisabled = 0;
+
+    duration = emulatedMicros() - irqOffStart;
+    span = &irq_stats.offSpans[irq_stats.offSpanCount % IAP_MAX_BUSY_SPANS];
+    span->start = irqOffStart;
+    span->duration = duration;
+    irq_stats.offSpanCount++;
+
+    irq_stats.offTime += duration;
+    if (duration > irq_stats.maxOffSpan)
+        irq_stats.maxOffSpan = duration;
+}